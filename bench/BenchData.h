@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QImage>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MessageTypes.hpp"
+#include "RawFrame.h"
+
+/**
+ * @brief Synthetic payloads for the benchmarks
+ *
+ * Shaped like the robot's traffic (see RobotSimulator for the live equivalent):
+ * 16-point lidar scans, camera-like JPEGs and a walled occupancy map.
+ */
+namespace BenchData {
+
+/// @brief A received frame owning a copy of @p message's wire bytes
+inline Spider2::RawFrame frameOf(Spider2::MessageType type, const google::protobuf::Message &message)
+{
+    auto bytes = std::make_shared<std::string>(message.SerializeAsString());
+    Spider2::RawFrame frame;
+    frame.type = static_cast<uint8_t>(type);
+    frame.data = bytes->data();
+    frame.size = bytes->size();
+    frame.owner = std::move(bytes);
+    return frame;
+}
+
+/// @brief Gradient, bar and noise: compresses about like a camera image
+inline QByteArray encodeJpeg(int width, int height, int quality = 80)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    uint32_t noise = 0x12345678u;
+    for (int y = 0; y < height; ++y) {
+        auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            noise = noise * 1664525u + 1013904223u;
+            const int n = static_cast<int>(noise >> 28);
+            line[x] = qRgb((x * 255 / width + n) & 0xFF, (y * 255 / height + n) & 0xFF,
+                           std::abs(x - width / 3) < width / 16 ? 255 : (((x ^ y) >> 3) & 1) * 64 + n);
+        }
+    }
+    QByteArray jpeg;
+    QBuffer buffer(&jpeg);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPG", quality);
+    return jpeg;
+}
+
+/// @brief size × size occupancy cells: free floor, walls and a few pillars
+inline QByteArray mapCells(int size)
+{
+    QByteArray cells(size * size, static_cast<char>(255));   // BreezySLAM: 255 = free
+    const int wall = std::max(1, size / 100);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const bool border = x < wall || y < wall || x >= size - wall || y >= size - wall;
+            const bool pillar = (x * 7 / size) % 2 == 1 && (y * 7 / size) % 2 == 1;
+            if (border || pillar)
+                cells[y * size + x] = 0;
+        }
+    }
+    return cells;
+}
+
+inline Command::LidarData lidarScan(int points)
+{
+    std::vector<float> angles;
+    std::vector<float> distances;
+    for (int i = 0; i < points; ++i) {
+        const float angle = static_cast<float>(std::remainder(6.283185307179586 * i / points, 6.283185307179586));
+        angles.push_back(angle);
+        distances.push_back(2.0f + std::sin(angle * 3.0f) * 0.8f);
+    }
+    return Spider2::MessageFactory::createLidarData(angles, distances);
+}
+
+} // namespace BenchData
@@ -0,0 +1,103 @@
+#include <QCoreApplication>
+#include <benchmark/benchmark.h>
+#include "BenchData.h"
+#include "FramePublisher.h"
+#include "RobotController.h"
+
+using Spider2::MessageType;
+
+// Friend of RobotController: the dispatch path is private
+struct RobotControllerBenchAccess {
+    static void startIngest(RobotController &controller) { controller.startIngest(); }
+    static void stopIngest(RobotController &controller) { controller.stopIngest(); }
+    static void dispatch(RobotController &controller, const Spider2::RawFrame &frame) { controller.dispatchMessage(frame); }
+
+    /// @brief Apply what dispatch queued for the GUI, so queues stay at their live size
+    static void drain(RobotController &controller)
+    {
+        controller.m_publisher->publishNow();
+        QCoreApplication::processEvents();
+    }
+};
+
+namespace {
+
+using Access = RobotControllerBenchAccess;
+
+Spider2::RawFrame sampleFrame(MessageType type)
+{
+    switch (type) {
+    case MessageType::TELEMETRY_UPDATE:
+        return BenchData::frameOf(type, Spider2::MessageFactory::createTelemetryUpdate("battery_voltage", 12.4f));
+    case MessageType::GYRO_DATA:
+        return BenchData::frameOf(type, Spider2::MessageFactory::createGyroData(0.12f, -0.03f));
+    case MessageType::LIDAR_DATA:
+        return BenchData::frameOf(type, BenchData::lidarScan(16));
+    case MessageType::VIDEO_FRAME: {
+        const QByteArray jpeg = BenchData::encodeJpeg(640, 480);
+        Command::VideoFrame video;
+        video.set_timestamp(1);
+        video.set_data(jpeg.constData(), static_cast<size_t>(jpeg.size()));
+        video.set_width(640);
+        video.set_height(480);
+        return BenchData::frameOf(type, video);
+    }
+    case MessageType::SLAM_POSE:
+        return BenchData::frameOf(type, Spider2::MessageFactory::createSlamPose(1200.0, -340.0, 87.5));
+    case MessageType::SLAM_MAP: {
+        const QByteArray cells = BenchData::mapCells(800);
+        return BenchData::frameOf(type, Spider2::MessageFactory::createSlamMap(
+                                            800, 20.0, std::vector<char>(cells.begin(), cells.end())));
+    }
+    case MessageType::OBJECT_TRACKING_DATA: {
+        Command::BlobTrackingData blob;
+        blob.set_timestamp(1);
+        blob.set_blob_x(0.2f);
+        blob.set_blob_y(-0.1f);
+        blob.set_blob_size(0.05f);
+        blob.set_frame_width(640);
+        blob.set_frame_height(480);
+        return BenchData::frameOf(type, blob);
+    }
+    case MessageType::HEARTBEAT:
+    default:
+        return BenchData::frameOf(MessageType::HEARTBEAT, Spider2::MessageFactory::createHeartbeat("bench"));
+    }
+}
+
+/**
+ * One received frame through RobotController::dispatchMessage(), as a pipeline
+ * worker runs it: parse in place, hand off to the GUI side. Publishing is
+ * excluded; for VIDEO_FRAME the decode runs on the decoder threads meanwhile.
+ */
+void BM_DispatchMessage(benchmark::State &state, MessageType type)
+{
+    const Spider2::RawFrame frame = sampleFrame(type);
+    RobotController controller;
+    Access::startIngest(controller);
+
+    uint64_t dispatched = 0;
+    for (auto _ : state) {
+        Access::dispatch(controller, frame);
+        if ((++dispatched & 255) == 0) {
+            state.PauseTiming();
+            Access::drain(controller);
+            state.ResumeTiming();
+        }
+    }
+
+    Access::drain(controller);
+    Access::stopIngest(controller);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * frame.size));
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_DispatchMessage, telemetry, MessageType::TELEMETRY_UPDATE);
+BENCHMARK_CAPTURE(BM_DispatchMessage, gyro, MessageType::GYRO_DATA);
+BENCHMARK_CAPTURE(BM_DispatchMessage, lidar, MessageType::LIDAR_DATA);
+BENCHMARK_CAPTURE(BM_DispatchMessage, video, MessageType::VIDEO_FRAME);
+BENCHMARK_CAPTURE(BM_DispatchMessage, slam_pose, MessageType::SLAM_POSE);
+BENCHMARK_CAPTURE(BM_DispatchMessage, slam_map, MessageType::SLAM_MAP);
+BENCHMARK_CAPTURE(BM_DispatchMessage, blob, MessageType::OBJECT_TRACKING_DATA);
+BENCHMARK_CAPTURE(BM_DispatchMessage, heartbeat, MessageType::HEARTBEAT);
@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+#include "BenchData.h"
+#include "GyroDataModel.h"
+#include "LidarController.h"
+#include "MapColorizer.h"
+
+namespace {
+
+// SLAM_MAP cells → pixels on one thread through the vector path (SSE2/AVX2/NEON)
+void BM_MapColorizeRow(benchmark::State &state)
+{
+    const int size = static_cast<int>(state.range(0));
+    const QByteArray cells = BenchData::mapCells(size);
+    const auto *data = reinterpret_cast<const uint8_t *>(cells.constData());
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+
+    for (auto _ : state) {
+        for (int y = 0; y < size; ++y)
+            MapColorizer::colorizeRow(data + static_cast<size_t>(y) * size,
+                                      reinterpret_cast<QRgb *>(image.scanLine(y)), size);
+        benchmark::DoNotOptimize(image.constBits());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_MapColorizeRow)->Arg(400)->Arg(800)->Arg(2048)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+// The same through the 256-entry table, one cell at a time: the scalar baseline
+void BM_MapColorizeTable(benchmark::State &state)
+{
+    const int size = static_cast<int>(state.range(0));
+    const QByteArray cells = BenchData::mapCells(size);
+    const auto *data = reinterpret_cast<const uint8_t *>(cells.constData());
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+
+    for (auto _ : state) {
+        for (int y = 0; y < size; ++y) {
+            const uint8_t *row = data + static_cast<size_t>(y) * size;
+            QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < size; ++x)
+                pixels[x] = MapColorizer::colorOf(row[x]);
+        }
+        benchmark::DoNotOptimize(image.constBits());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_MapColorizeTable)->Arg(400)->Arg(800)->Arg(2048)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+/**
+ * A new map as the colorizer thread handles it: diff against the stored chunks
+ * in tiles, rows of tiles shared with the helpers, then update the pyramid.
+ * Second argument: 0 = map unchanged, 1 = a small patch changed (the usual
+ * SLAM update), 2 = every tile changed.
+ */
+void BM_MapColorizeChanges(benchmark::State &state)
+{
+    const int size = static_cast<int>(state.range(0));
+    const int change = static_cast<int>(state.range(1));
+    QByteArray maps[2] = {BenchData::mapCells(size), BenchData::mapCells(size)};
+    if (change == 1) {
+        // A 16-pixel obstacle next to the robot
+        const int centre = size / 2;
+        for (int y = centre; y < centre + 16; ++y)
+            for (int x = centre; x < centre + 16; ++x)
+                maps[1][y * size + x] = 0;
+    } else if (change == 2) {
+        for (char &cell : maps[1])
+            cell = static_cast<char>(~static_cast<unsigned char>(cell));
+    }
+    MapColorizer colorizer([](Spider2::MapTileUpdate &&, qint64, qint64) {});
+    colorizer.start();
+    colorizer.diffMap(reinterpret_cast<const uint8_t *>(maps[0].constData()), size, 20.0);
+
+    uint64_t tiles = 0;
+    size_t next = 1;
+    for (auto _ : state) {
+        const Spider2::MapTileUpdate update =
+            colorizer.diffMap(reinterpret_cast<const uint8_t *>(maps[next].constData()), size, 20.0);
+        tiles += update.tiles.size();
+        next ^= 1;
+    }
+    colorizer.stop();
+    state.SetItemsProcessed(state.iterations() * size * size);
+    state.counters["threads"] = colorizer.threadCount();
+    state.counters["tiles"] = benchmark::Counter(static_cast<double>(tiles), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MapColorizeChanges)
+    ->ArgsProduct({{400, 800, 2048, 4096}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// One revolution in; the blended Cartesian list of the last `merge` revolutions rebuilt
+void BM_LidarUpdate(benchmark::State &state)
+{
+    const int merge = static_cast<int>(state.range(0));
+    const int points = static_cast<int>(state.range(1));
+    QVector<LidarPoint> revolution;
+    const Command::LidarData scan = BenchData::lidarScan(points);
+    for (int i = 0; i < points; ++i)
+        revolution.append(LidarPoint(scan.angles(i), scan.distances(i)));
+
+    LidarController controller;
+    controller.setMergeFrames(merge);
+    for (int i = 0; i < merge; ++i)
+        controller.updateLidarData(revolution);
+
+    for (auto _ : state) {
+        controller.updateLidarData(revolution);
+    }
+    state.SetItemsProcessed(state.iterations() * merge * points);
+}
+BENCHMARK(BM_LidarUpdate)
+    ->ArgNames({"merge", "points"})
+    ->ArgsProduct({{1, LidarController::MERGE_FRAMES, 10}, {16, 360, 2000}});
+
+void BM_GyroAddReading(benchmark::State &state)
+{
+    GyroDataModel model;
+    qint64 timestamp = 0;
+    for (auto _ : state) {
+        model.addReading(GyroReading(0.1f, -0.2f, 0.0f, ++timestamp));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GyroAddReading);
+
+// The batched form the publisher uses: one model update per rendered frame
+void BM_GyroAddReadings(benchmark::State &state)
+{
+    const int batch = static_cast<int>(state.range(0));
+    QVector<GyroReading> readings;
+    for (int i = 0; i < batch; ++i)
+        readings.append(GyroReading(0.1f, -0.2f, 0.0f, i));
+
+    GyroDataModel model;
+    for (auto _ : state) {
+        model.addReadings(readings);
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_GyroAddReadings)->Arg(10)->Arg(100)->Arg(1000);
+
+} // namespace
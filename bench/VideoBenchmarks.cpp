@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+#include "BenchData.h"
+#include "VideoDecoder.h"
+
+namespace {
+
+// One JPEG on one decoder thread; divisor > 1 decodes for a display that much smaller
+void BM_JpegDecode(benchmark::State &state)
+{
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    const int divisor = static_cast<int>(state.range(2));
+    const QByteArray jpeg = BenchData::encodeJpeg(width, height);
+    const QSize target = divisor > 1 ? QSize(width / divisor, height / divisor) : QSize();
+
+    for (auto _ : state) {
+        QImage image = VideoDecoder::decode(jpeg.constData(), static_cast<size_t>(jpeg.size()), target);
+        benchmark::DoNotOptimize(image.constBits());
+    }
+    state.SetBytesProcessed(state.iterations() * jpeg.size());
+    state.counters["jpeg_kb"] = jpeg.size() / 1024.0;
+}
+BENCHMARK(BM_JpegDecode)
+    ->ArgNames({"w", "h", "div"})
+    ->Args({640, 480, 1})
+    ->Args({1280, 720, 1})
+    ->Args({1280, 720, 2})
+    ->Args({1920, 1080, 1})
+    ->Args({1920, 1080, 2})
+    ->Args({3840, 2160, 1})
+    ->Args({3840, 2160, 4})
+    ->Unit(benchmark::kMillisecond);
+
+// Reference: the GUI-thread rescale that decoding at display size and the scene graph avoid
+void BM_VideoSmoothScale(benchmark::State &state)
+{
+    QImage frame(1280, 720, QImage::Format_RGB32);
+    frame.fill(Qt::darkGreen);
+    for (auto _ : state) {
+        QImage scaled = frame.scaled(640, 360, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        benchmark::DoNotOptimize(scaled.constBits());
+    }
+}
+BENCHMARK(BM_VideoSmoothScale)->Unit(benchmark::kMicrosecond);
+
+} // namespace
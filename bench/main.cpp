@@ -0,0 +1,19 @@
+#include <QGuiApplication>
+#include <benchmark/benchmark.h>
+
+// Google Benchmark's main, inside a QGuiApplication: QImage I/O plugins,
+// QPainter and the QObject machinery of the controllers all need one
+int main(int argc, char *argv[])
+{
+    // No display needed (or wanted) on a build server
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -30,8 +30,8 @@ print_error() {
 }
 
 # Check if we're in the right directory
-if [ ! -f "conanfile.txt" ]; then
-    print_error "conanfile.txt not found. Please run this script from the project root directory."
+if [ ! -f "conanfile.py" ]; then
+    print_error "conanfile.py not found. Please run this script from the project root directory."
     exit 1
 fi
 
@@ -0,0 +1,26 @@
+import os
+
+from conan import ConanFile
+from conan.tools.files import copy
+
+
+class Spider2GuiConan(ConanFile):
+    settings = "os", "compiler", "build_type", "arch"
+    generators = "CMakeToolchain", "CMakeDeps", "VirtualRunEnv"
+
+    # -o with_benchmarks=True for a build with -DSPIDER2_BUILD_BENCHMARKS=ON
+    options = {"with_benchmarks": [True, False]}
+    default_options = {"with_benchmarks": False}
+
+    def requirements(self):
+        self.requires("zeromq/4.3.5")
+        self.requires("cppzmq/4.11.0")
+        self.requires("protobuf/3.21.12")
+        if self.options.with_benchmarks:
+            self.requires("benchmark/1.8.3")
+
+    def generate(self):
+        # Copies all exe files from the packages' bin folders to our "bin" folder
+        for dependency in self.dependencies.values():
+            for bindir in dependency.cpp_info.bindirs:
+                copy(self, "*.exe", bindir, os.path.join(self.generators_folder, "bin"))
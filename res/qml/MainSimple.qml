@@ -35,13 +35,12 @@ Window {
         focus: true
         
         // ── Layer 1: Video background (hidden in nav mode) ──
-        Image {
+        // Frames go straight into the scene graph; the item also reports its
+        // size so the decoder produces frames at (about) the size shown
+        VideoItem {
             id: videoImage
             anchors.fill: parent
-            source: "image://video/frame?" + robotController.videoFrameIndex
-            fillMode: Image.PreserveAspectFit
-            smooth: true
-            cache: false
+            controller: robotController
             visible: !navMode
         }
         
@@ -88,7 +87,7 @@ Window {
             border.color: "black"
             border.width: 2
             radius: 10
-            visible: !robotController.connected
+            visible: !robotController.connected && !robotController.replaying
             clip: true
             
             property string robotIp: "spider.local"
@@ -219,6 +218,33 @@ Window {
                         }
                     }
                     
+                    // Armed before connecting, so the session starts with the first frame
+                    Rectangle {
+                        width: 80
+                        height: 30
+                        color: robotController.recording ? "#e74c3c" : "white"
+                        border.color: "black"
+                        border.width: 1
+                        radius: 5
+                        
+                        Text {
+                            anchors.centerIn: parent
+                            text: robotController.recording ? "\u25CF Rec" : "Record"
+                            color: robotController.recording ? "white" : "black"
+                            font.pixelSize: 12
+                        }
+                        
+                        MouseArea {
+                            anchors.fill: parent
+                            onClicked: {
+                                if (robotController.recording)
+                                    robotController.stopRecording()
+                                else
+                                    robotController.startRecording()
+                            }
+                        }
+                    }
+                    
                     Rectangle {
                         width: 80
                         height: 30
@@ -248,7 +274,7 @@ Window {
         // ── Overlay controls (hidden in nav mode) ──
         Item {
             anchors.fill: parent
-            visible: robotController.connected && !navMode
+            visible: (robotController.connected || robotController.replaying) && !navMode
 
             // Data stream health — top center
             Row {
@@ -335,6 +361,15 @@ Window {
                 }
             }
 
+            // Replay position and speed — below the stream health bar
+            ReplayScrubber {
+                anchors.top: streamHealthBar.bottom
+                anchors.horizontalCenter: parent.horizontalCenter
+                anchors.topMargin: 8
+                visible: robotController.replaying
+                controller: robotController
+            }
+
             // Left column: Servo + NAV + Walking style + Robot state
             Column {
                 anchors.left: parent.left
@@ -486,15 +521,35 @@ Window {
                 width: 150; height: 30
                 anchors.verticalCenter: parent.verticalCenter
                 anchors.right: parent.right; anchors.margins: 10
-                color: robotController.connected ? "green" : "red"
+                color: robotController.connected ? "green" : (robotController.replaying ? "#3498db" : "red")
                 opacity: 0.8; radius: 5
                 Text {
                     anchors.centerIn: parent
-                    text: robotController.connected ? "CONNECTED" : "DISCONNECTED"
+                    text: robotController.connected ? "CONNECTED" : (robotController.replaying ? "REPLAY" : "DISCONNECTED")
                     color: "white"; font.bold: true; font.pixelSize: 12
                 }
             }
 
+            // Recording toggle — below the connection status
+            Rectangle {
+                width: 150; height: 26
+                anchors.right: parent.right; anchors.rightMargin: 10
+                anchors.verticalCenter: parent.verticalCenter; anchors.verticalCenterOffset: 30
+                visible: robotController.connected
+                color: robotController.recording ? "#e74c3c" : "black"
+                opacity: 0.8; radius: 5
+                border.color: "white"; border.width: 1
+                Text {
+                    anchors.centerIn: parent
+                    text: robotController.recording ? "\u25CF REC  (stop)" : "RECORD"
+                    color: "white"; font.bold: true; font.pixelSize: 11
+                }
+                MouseArea {
+                    anchors.fill: parent
+                    onClicked: robotController.recording ? robotController.stopRecording() : robotController.startRecording()
+                }
+            }
+
             // Simple telemetry — top left
             Rectangle {
                 width: 220; height: 140
@@ -795,17 +850,12 @@ Window {
                     }
                 ]
 
-                // Inlined map image
-                Image {
+                // Inlined map (same tiles as MapDisplay's, uploaded per item)
+                MapItem {
                     id: navMapImage
                     anchors.fill: parent
-                    fillMode: Image.PreserveAspectFit
-                    cache: false
-                    source: robotController.slamController
-                        ? "image://map/frame?idx=" + robotController.slamController.mapFrameIndex
-                        : ""
-                    antialiasing: false
-                    smooth: false
+                    controller: robotController.slamController
+                    zoom: navZoom
                 }
 
                 // Fallback text when no SLAM data
@@ -930,15 +980,12 @@ Window {
                 onPressed: function(mouse) {
                     if (mouse.button === Qt.RightButton && robotController.slamController && robotController.slamController.hasData) {
                         var iw = navMapImage.width, ih = navMapImage.height
-                        var pw = navMapImage.paintedWidth, ph = navMapImage.paintedHeight
-                        var px = navMapImage.paintedX, py = navMapImage.paintedY
-                        if (pw <= 0 || ph <= 0) return
-                        var ms = robotController.slamController.mapSizeMeters
+                        if (navMapImage.paintedWidth <= 0 || navMapImage.paintedHeight <= 0) return
                         var lx = (mouse.x - navPanX - iw / 2) / navZoom + iw / 2
                         var ly = (mouse.y - navPanY - ih / 2) / navZoom + ih / 2
-                        var wx = (lx - px) * ms / pw * 1000.0
-                        var wy = (ly - py) * ms / ph * 1000.0
-                        robotController.sendMoveToPoint(wx, wy)
+                        var world = navMapImage.itemToWorld(lx, ly)
+                        if (robotController.slamController.mapCellAt(world.x, world.y) < 0) return
+                        robotController.sendMoveToPoint(world.x, world.y)
                         return
                     }
                     dragStartX = mouse.x; dragStartY = mouse.y
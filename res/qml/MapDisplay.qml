@@ -1,4 +1,5 @@
 import QtQuick
+import Spider2 1.0
 
 Rectangle {
     id: mapDisplay
@@ -35,10 +36,6 @@ Rectangle {
     property real zoomMin: 0.3
     property real zoomMax: 10.0
 
-    // Force image re-fetch when becoming visible (e.g. NAV mode toggle)
-    property int refreshToken: 0
-    onVisibleChanged: { if (visible) refreshToken++ }
-
     // Drag tracking
     property real dragStartX: 0
     property real dragStartY: 0
@@ -64,27 +61,24 @@ Rectangle {
         var lx = (mx - mapDisplay.panX - iw / 2) / mapDisplay.zoom + iw / 2
         var ly = (my - mapDisplay.panY - ih / 2) / mapDisplay.zoom + ih / 2
 
-        // Convert image-local to world mm (accounting for PreserveAspectFit painting)
-        var pw = mapImage.paintedWidth, ph = mapImage.paintedHeight
-        var px = mapImage.paintedX, py = mapImage.paintedY
-        if (pw <= 0 || ph <= 0) return null
-
-        var worldX_mm = (lx - px) * mapPhysicalSize / pw * 1000.0
-        var worldY_mm = (ly - py) * mapPhysicalSize / ph * 1000.0
-        return [worldX_mm, worldY_mm]
+        // Image-local to world mm; MapItem knows where the map is painted
+        if (mapImage.paintedWidth <= 0 || mapImage.paintedHeight <= 0) return null
+        var world = mapImage.itemToWorld(lx, ly)
+        // Off the map there is nothing to hit
+        if (controller.mapCellAt(world.x, world.y) < 0) return null
+        return [world.x, world.y]
     }
 
     // Convert world mm to screen pixel (for arrow positioning)
     function worldToScreen(worldX_mm, worldY_mm) {
         if (!controller || !controller.hasData) return null
         var iw = mapImage.width, ih = mapImage.height
-        var pw = mapImage.paintedWidth, ph = mapImage.paintedHeight
-        var px = mapImage.paintedX, py = mapImage.paintedY
-        if (pw <= 0 || ph <= 0) return null
+        if (mapImage.paintedWidth <= 0 || mapImage.paintedHeight <= 0) return null
 
         // World mm → image-local pixels (origin at top-left)
-        var lx = px + (worldX_mm / 1000.0) * pw / mapPhysicalSize
-        var ly = py + (worldY_mm / 1000.0) * ph / mapPhysicalSize
+        var local = mapImage.worldToItem(worldX_mm, worldY_mm)
+        var lx = local.x
+        var ly = local.y
 
         // Apply zoom/pan
         var sx = (lx - iw / 2) * mapDisplay.zoom + iw / 2 + mapDisplay.panX
@@ -107,14 +101,14 @@ Rectangle {
             }
         ]
 
-        Image {
+        // Map tiles in the scene graph: only changed tiles are re-uploaded,
+        // pan and zoom above only move the nodes; zoom picks the pyramid level
+        MapItem {
             id: mapImage
             anchors.fill: parent
-            fillMode: Image.PreserveAspectFit
-            cache: false
-            source: controller ? "image://map/frame?idx=" + controller.mapFrameIndex + "&t=" + mapDisplay.refreshToken : ""
-            antialiasing: false
-            smooth: false
+            controller: mapDisplay.controller
+            zoom: mapDisplay.zoom
+            trailColor: "#9900aaff"   // where the robot has been, under its marker
         }
 
         // Fallback text when no map data
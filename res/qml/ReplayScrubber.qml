@@ -0,0 +1,117 @@
+import QtQuick
+
+// Position, seek and speed of a session replay
+Rectangle {
+    id: root
+    width: 420
+    height: 34
+    radius: 5
+    color: "black"
+    opacity: 0.8
+    border.color: "white"
+    border.width: 1
+
+    property var controller: null
+
+    readonly property real durationMs: controller ? controller.replayDurationMs : 0
+    // Follows the drag until release, so the handle does not jump back mid-seek
+    readonly property real shownMs: trackMA.pressed ? dragMs : (controller ? controller.replayPositionMs : 0)
+    property real dragMs: 0
+
+    function formatTime(ms) {
+        var s = Math.max(0, Math.floor(ms / 1000))
+        var m = Math.floor(s / 60)
+        s = s % 60
+        return m + ":" + (s < 10 ? "0" : "") + s
+    }
+
+    Row {
+        id: buttons
+        anchors.left: parent.left
+        anchors.leftMargin: 6
+        anchors.verticalCenter: parent.verticalCenter
+        spacing: 4
+
+        Repeater {
+            model: [ { label: "1×", speed: 1 }, { label: "4×", speed: 4 }, { label: "MAX", speed: 0 } ]
+
+            Rectangle {
+                width: 34; height: 22; radius: 4
+                color: root.controller && root.controller.replaySpeed === modelData.speed ? "#3498db" : "#444444"
+                border.color: "white"; border.width: 1
+                Text {
+                    anchors.centerIn: parent
+                    text: modelData.label
+                    color: "white"; font.pixelSize: 10; font.bold: true
+                }
+                MouseArea {
+                    anchors.fill: parent
+                    onClicked: root.controller.replaySpeed = modelData.speed
+                }
+            }
+        }
+
+        Rectangle {
+            width: 22; height: 22; radius: 4
+            color: stopMA.pressed ? "#7a1a1a" : "#8b2222"
+            border.color: "#ff4444"; border.width: 1
+            Rectangle { anchors.centerIn: parent; width: 8; height: 8; color: "white" }
+            MouseArea {
+                id: stopMA
+                anchors.fill: parent
+                onClicked: root.controller.stopReplay()
+            }
+        }
+    }
+
+    Text {
+        id: timeText
+        anchors.right: parent.right
+        anchors.rightMargin: 8
+        anchors.verticalCenter: parent.verticalCenter
+        text: root.formatTime(root.shownMs) + " / " + root.formatTime(root.durationMs)
+        color: "white"
+        font.pixelSize: 11
+        font.family: "monospace"
+    }
+
+    Item {
+        id: track
+        anchors.left: buttons.right
+        anchors.right: timeText.left
+        anchors.margins: 10
+        anchors.verticalCenter: parent.verticalCenter
+        height: 22
+
+        Rectangle {
+            anchors.verticalCenter: parent.verticalCenter
+            width: parent.width; height: 4; radius: 2
+            color: "#444444"
+        }
+        Rectangle {
+            anchors.verticalCenter: parent.verticalCenter
+            width: handle.x + handle.width / 2; height: 4; radius: 2
+            color: "#3498db"
+        }
+        Rectangle {
+            id: handle
+            width: 12; height: 12; radius: 6
+            anchors.verticalCenter: parent.verticalCenter
+            x: (root.durationMs > 0 ? Math.min(1, root.shownMs / root.durationMs) : 0) * parent.width - width / 2
+            color: "white"
+        }
+
+        MouseArea {
+            id: trackMA
+            anchors.fill: parent
+
+            function msAt(mouseX) {
+                return Math.max(0, Math.min(1, mouseX / width)) * root.durationMs
+            }
+
+            onPressed: function(mouse) { root.dragMs = msAt(mouse.x) }
+            onPositionChanged: function(mouse) { root.dragMs = msAt(mouse.x) }
+            onReleased: function(mouse) { root.controller.seekReplay(msAt(mouse.x)) }
+        }
+    }
+}
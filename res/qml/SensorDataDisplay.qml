@@ -139,8 +139,8 @@ Rectangle {
                 Layout.preferredWidth: 28
             }
             Text {
-                readonly property var g: telemetryData["gyro"]
-                text: g ? g.x.toFixed(1) + "\u00B0" : "--\u00B0"
+                readonly property var g: telemetryData["gyro_x"]
+                text: g !== undefined ? g.toFixed(1) + "\u00B0" : "--\u00B0"
                 color: "#dddddd"
                 font.pixelSize: 12
                 font.bold: true
@@ -154,8 +154,8 @@ Rectangle {
                 Layout.preferredWidth: 32
             }
             Text {
-                readonly property var g: telemetryData["gyro"]
-                text: g ? g.y.toFixed(1) + "\u00B0" : "--\u00B0"
+                readonly property var g: telemetryData["gyro_y"]
+                text: g !== undefined ? g.toFixed(1) + "\u00B0" : "--\u00B0"
                 color: "#dddddd"
                 font.pixelSize: 12
                 font.bold: true
@@ -0,0 +1,118 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Spider2 {
+
+namespace {
+
+// Trivially initialised, so touching them from inside malloc() cannot allocate
+thread_local bool t_counting = false;
+thread_local uint64_t t_allocations = 0;
+
+// Per-thread counts are folded in when a scope ends, not on every allocation
+std::atomic<uint64_t> s_allocations{0};
+
+inline void countAllocation()
+{
+    if (t_counting)
+        ++t_allocations;
+}
+
+} // namespace
+
+AllocationCounter::Scope::Scope()
+    : m_outer(!t_counting)
+{
+    t_counting = true;
+}
+
+AllocationCounter::Scope::~Scope()
+{
+    if (!m_outer)
+        return;
+    t_counting = false;
+    if (t_allocations) {
+        s_allocations.fetch_add(t_allocations, std::memory_order_relaxed);
+        t_allocations = 0;
+    }
+}
+
+uint64_t AllocationCounter::take()
+{
+    return s_allocations.exchange(0, std::memory_order_relaxed);
+}
+
+} // namespace Spider2
+
+#if defined(__GLIBC__)
+
+// glibc's own entry points; the definitions below take precedence for the whole process
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size)
+{
+    Spider2::countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    Spider2::countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    Spider2::countAllocation();
+    return __libc_realloc(pointer, size);
+}
+}
+
+#else
+
+namespace {
+
+void *allocate(std::size_t size)
+{
+    Spider2::countAllocation();
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        if (void *pointer = std::malloc(size))
+            return pointer;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *allocateNoThrow(std::size_t size) noexcept
+{
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+// The aligned forms keep their default definitions; nothing on the ingest path uses them
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return allocateNoThrow(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return allocateNoThrow(size); }
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+
+#endif
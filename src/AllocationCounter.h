@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Spider2 {
+
+/**
+ * @brief Counts heap allocations made by threads inside a Scope
+ *
+ * With glibc, malloc, calloc and realloc are wrapped, which also covers
+ * operator new and Qt's containers (QString, QVector, QVariant's shared
+ * data). Elsewhere only the global operator new is replaced, so memory that
+ * Qt takes with malloc() directly does not show. Allocations outside a Scope
+ * cost one thread-local test.
+ */
+class AllocationCounter
+{
+public:
+    /// @brief Counts the calling thread's allocations until destroyed; may nest
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        bool m_outer;
+    };
+
+    /// @brief Allocations counted on all threads since the last call
+    static uint64_t take();
+};
+
+} // namespace Spider2
@@ -0,0 +1,208 @@
+#include "ClockSync.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+int64_t localNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Drift needs a baseline long enough for millisecond stamps to resolve it
+constexpr size_t MIN_DRIFT_POINTS = 4;
+constexpr int64_t MIN_DRIFT_SPAN_US = 30'000'000;
+
+} // namespace
+
+ClockSync::ClockSync(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ClockSync::requestSent(int64_t timestampMs, int64_t sentUs)
+{
+    // No second heartbeat arrived for the previous request: its reply was unique
+    acceptCandidate();
+
+    while (!m_requests.empty() && sentUs - m_requests.front().sentUs > REQUEST_TIMEOUT_US) {
+        m_requests.pop_front();
+    }
+    const bool ambiguous = !m_requests.empty() && m_requests.back().replies == 0;
+    m_requests.push_back(Request{timestampMs, sentUs, 0, ambiguous});
+}
+
+void ClockSync::replyReceived(int64_t timestampMs, int64_t receivedUs)
+{
+    QMetaObject::invokeMethod(this, [this, timestampMs, receivedUs]() {
+        handleReply(timestampMs, receivedUs);
+    }, Qt::QueuedConnection);
+}
+
+void ClockSync::handleReply(int64_t timestampMs, int64_t receivedUs)
+{
+    // An echo of one of our stamps identifies its request but says nothing about the robot clock
+    auto match = std::find_if(m_requests.begin(), m_requests.end(),
+                              [timestampMs](const Request &r) { return r.timestampMs == timestampMs; });
+    if (match != m_requests.end()) {
+        if (m_candidate && m_candidate->sentUs <= match->sentUs)
+            m_candidate.reset();    // taken for a reply, but the robot was answering with echoes
+        addRtt(receivedUs - match->sentUs);
+        m_requests.erase(m_requests.begin(), std::next(match));
+        emit updated();
+        return;
+    }
+
+    // Anything else can only answer the newest request, and only shortly after it left
+    if (m_requests.empty())
+        return;
+    Request &newest = m_requests.back();
+    const int64_t rttUs = receivedUs - newest.sentUs;
+    if (rttUs < 0 || rttUs > REPLY_WINDOW_US)
+        return;
+    if (++newest.replies > 1 || newest.ambiguous) {
+        m_candidate.reset();
+        return;
+    }
+    m_candidate = Reply{timestampMs, newest.sentUs, receivedUs};
+}
+
+void ClockSync::acceptCandidate()
+{
+    if (!m_candidate)
+        return;
+    const Reply reply = *m_candidate;
+    m_candidate.reset();
+
+    while (!m_requests.empty() && m_requests.front().sentUs <= reply.sentUs) {
+        m_requests.pop_front();
+    }
+    const int64_t rttUs = reply.receivedUs - reply.sentUs;
+    addRtt(rttUs);
+    const int64_t midpointUs = reply.sentUs + rttUs / 2;
+    addSample(Sample{midpointUs, reply.timestampMs * 1000 - midpointUs, rttUs});
+    emit updated();
+}
+
+void ClockSync::addRtt(int64_t rttUs)
+{
+    if (m_sampleCount > 0) {
+        const double d = std::abs(static_cast<double>(rttUs - m_rttUs));
+        m_jitterUs += (d - m_jitterUs) / 16.0;
+    }
+    m_rttUs = rttUs;
+    ++m_sampleCount;
+}
+
+void ClockSync::addSample(const Sample &sample)
+{
+    if (m_hasEstimate) {
+        const int64_t deviation = std::llabs(sample.offsetUs - offsetUsAt(sample.localUs));
+        if (deviation > STEP_THRESHOLD_US + sample.rttUs / 2) {
+            qInfo() << "[CLOCK] Robot clock stepped by" << deviation / 1000 << "ms, resynchronizing";
+            m_filterCount = 0;
+            m_filterNext = 0;
+            m_estimates.clear();
+            m_driftPpm = 0.0;
+            m_hasEstimate = false;
+        }
+    }
+
+    m_filter[m_filterNext] = sample;
+    m_filterNext = (m_filterNext + 1) % FILTER_SIZE;
+    m_filterCount = std::min(m_filterCount + 1, FILTER_SIZE);
+
+    // Least delay = least asymmetric queueing = most trustworthy offset
+    const Sample *best = &m_filter[0];
+    for (size_t i = 1; i < m_filterCount; ++i) {
+        if (m_filter[i].rttUs < best->rttUs)
+            best = &m_filter[i];
+    }
+
+    // Never step back to an older winner, it is already in the drift history
+    if (m_hasEstimate && best->localUs <= m_estimate.localUs)
+        return;
+
+    if (!m_hasEstimate) {
+        qInfo() << "[CLOCK] Synchronized: offset" << best->offsetUs / 1000.0
+                << "ms, rtt" << best->rttUs / 1000.0 << "ms";
+    }
+    m_estimate = *best;
+    m_hasEstimate = true;
+
+    m_estimates.push_back(m_estimate);
+    while (m_estimate.localUs - m_estimates.front().localUs > DRIFT_WINDOW_S * 1'000'000) {
+        m_estimates.pop_front();
+    }
+    updateDrift();
+}
+
+void ClockSync::updateDrift()
+{
+    const size_t n = m_estimates.size();
+    if (n < MIN_DRIFT_POINTS || m_estimates.back().localUs - m_estimates.front().localUs < MIN_DRIFT_SPAN_US)
+        return;
+
+    // Least-squares slope of offset over local time, relative to the first point for precision
+    const int64_t x0 = m_estimates.front().localUs;
+    const int64_t y0 = m_estimates.front().offsetUs;
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+    for (const Sample &s : m_estimates) {
+        const double x = static_cast<double>(s.localUs - x0);
+        const double y = static_cast<double>(s.offsetUs - y0);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+    const double denominator = n * sumXX - sumX * sumX;
+    if (denominator <= 0.0)
+        return;
+    const double slope = (n * sumXY - sumX * sumY) / denominator;
+    m_driftPpm = std::clamp(slope * 1e6, -MAX_DRIFT_PPM, MAX_DRIFT_PPM);
+}
+
+int64_t ClockSync::offsetUsAt(int64_t localUs) const
+{
+    if (!m_hasEstimate)
+        return 0;
+    const double elapsed = static_cast<double>(localUs - m_estimate.localUs);
+    return m_estimate.offsetUs + std::llround(elapsed * m_driftPpm * 1e-6);
+}
+
+double ClockSync::offsetMs() const
+{
+    return offsetUsAt(localNowUs()) / 1000.0;
+}
+
+QVariantMap ClockSync::statistics() const
+{
+    QVariantMap stats;
+    stats["synchronized"] = m_hasEstimate;
+    stats["rtt_ms"] = rttMs();
+    stats["jitter_ms"] = jitterMs();
+    stats["offset_ms"] = offsetMs();
+    stats["drift_ppm"] = m_driftPpm;
+    stats["samples"] = static_cast<qulonglong>(m_sampleCount);
+    return stats;
+}
+
+void ClockSync::reset()
+{
+    m_requests.clear();
+    m_candidate.reset();
+    m_filterCount = 0;
+    m_filterNext = 0;
+    m_estimates.clear();
+    m_hasEstimate = false;
+    m_estimate = Sample();
+    m_rttUs = 0;
+    m_jitterUs = 0.0;
+    m_driftPpm = 0.0;
+    m_sampleCount = 0;
+    emit updated();
+}
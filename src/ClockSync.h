@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+/**
+ * @brief Round-trip time and robot clock offset/drift from heartbeat exchanges
+ *
+ * Every heartbeat we send is remembered with its local send time t1. The
+ * robot also sends heartbeats of its own (every 5 s), which look exactly like
+ * replies, so a HEARTBEAT received at t4 is only used when it can be tied to
+ * a request:
+ *
+ *  - If it echoes one of our stamps it answers that request. The echo says
+ *    nothing about the robot clock, so it only yields an RTT sample.
+ *  - Otherwise it is a candidate reply to the newest request, provided it
+ *    arrived within REPLY_WINDOW_US of it. The candidate is kept until the
+ *    next request goes out and dropped if a second heartbeat arrives in the
+ *    meantime (one of the two was unsolicited and there is no telling which),
+ *    or if the request before was never answered (its late reply could be
+ *    this one). A surviving candidate's stamp T is the robot clock, read
+ *    somewhere in [t1, t4], and (as in NTP with a single server stamp)
+ *    offset = T − (t1 + t4) / 2 with an error bound of ±RTT / 2.
+ *
+ * Every other heartbeat is ignored.
+ *
+ * Offsets go through an NTP-style clock filter: of the last FILTER_SIZE
+ * samples the one with the smallest RTT (least queueing, tightest bound)
+ * wins. Winning estimates are kept for DRIFT_WINDOW_S seconds and a least-
+ * squares line through them gives the drift, so offsetUsAt() extrapolates
+ * between heartbeats instead of jumping.
+ *
+ * A jump larger than STEP_THRESHOLD_US (robot clock set by hand or by its own
+ * NTP) throws the history away and starts over from the new sample.
+ *
+ * All state lives on the object's thread: requestSent() must be called there,
+ * replyReceived() may be called from any thread and is posted.
+ */
+class ClockSync : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool synchronized READ synchronized NOTIFY updated)
+    Q_PROPERTY(double rttMs READ rttMs NOTIFY updated)
+    Q_PROPERTY(double jitterMs READ jitterMs NOTIFY updated)
+    Q_PROPERTY(double offsetMs READ offsetMs NOTIFY updated)
+    Q_PROPERTY(double driftPpm READ driftPpm NOTIFY updated)
+
+public:
+    explicit ClockSync(QObject *parent = nullptr);
+
+    /// @brief A heartbeat stamped @p timestampMs left at local time @p sentUs
+    void requestSent(int64_t timestampMs, int64_t sentUs);
+
+    /// @brief A robot HEARTBEAT stamped @p timestampMs arrived at local time @p receivedUs
+    void replyReceived(int64_t timestampMs, int64_t receivedUs);
+
+    /// @brief Forget all requests and estimates (new connection, possibly a different robot)
+    void reset();
+
+    /// @brief True once at least one offset sample was accepted
+    bool synchronized() const { return m_hasEstimate; }
+    /// @brief Last measured round-trip time
+    double rttMs() const { return m_rttUs / 1000.0; }
+    /// @brief Smoothed RTT variation (RFC 3550 interarrival jitter estimator)
+    double jitterMs() const { return m_jitterUs / 1000.0; }
+    /// @brief Robot clock − local clock, now
+    double offsetMs() const;
+    /// @brief Robot clock rate relative to ours, parts per million
+    double driftPpm() const { return m_driftPpm; }
+
+    /// @brief Robot clock − local clock at local time @p localUs, drift included
+    int64_t offsetUsAt(int64_t localUs) const;
+
+    /// @brief {synchronized, rtt_ms, jitter_ms, offset_ms, drift_ppm, samples}
+    QVariantMap statistics() const;
+
+    static constexpr size_t FILTER_SIZE = 8;
+    static constexpr int64_t DRIFT_WINDOW_S = 300;
+    static constexpr int64_t REQUEST_TIMEOUT_US = 10'000'000;
+    static constexpr int64_t REPLY_WINDOW_US = 500'000;     // half the heartbeat period
+    static constexpr int64_t STEP_THRESHOLD_US = 128'000;   // as NTP
+    static constexpr double MAX_DRIFT_PPM = 500.0;          // NTP frequency tolerance
+
+signals:
+    void updated();
+
+private:
+    struct Request {
+        int64_t timestampMs{0};
+        int64_t sentUs{0};
+        int replies{0};         // heartbeats received while this was the newest request
+        bool ambiguous{false};  // the request before was never answered
+    };
+    struct Reply {
+        int64_t timestampMs{0};
+        int64_t sentUs{0};
+        int64_t receivedUs{0};
+    };
+    struct Sample {
+        int64_t localUs{0};     // midpoint of the exchange
+        int64_t offsetUs{0};
+        int64_t rttUs{0};
+    };
+
+    void handleReply(int64_t timestampMs, int64_t receivedUs);
+    void acceptCandidate();
+    void addRtt(int64_t rttUs);
+    void addSample(const Sample &sample);
+    void updateDrift();
+
+    std::deque<Request> m_requests;                 // oldest first
+    std::optional<Reply> m_candidate;               // reply to the newest request, not yet known to be unique
+    std::array<Sample, FILTER_SIZE> m_filter{};
+    size_t m_filterCount{0};
+    size_t m_filterNext{0};
+    std::deque<Sample> m_estimates;                 // filter winners inside DRIFT_WINDOW_S
+
+    bool m_hasEstimate{false};
+    Sample m_estimate;
+    int64_t m_rttUs{0};
+    double m_jitterUs{0.0};
+    double m_driftPpm{0.0};
+    uint64_t m_sampleCount{0};
+};
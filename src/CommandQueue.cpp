@@ -0,0 +1,77 @@
+#include "CommandQueue.h"
+#include "MessageTypes.hpp"
+
+namespace Spider2 {
+
+CommandQueue::~CommandQueue()
+{
+    for (auto &slot : m_latest) {
+        delete slot.exchange(nullptr, std::memory_order_acquire);
+    }
+}
+
+int CommandQueue::slotFor(uint8_t type)
+{
+    switch (static_cast<MessageType>(type)) {
+    case MessageType::MOVE_COMMAND:   return 0;
+    case MessageType::PITCH_COMMAND:  return 1;
+    case MessageType::ROLL_COMMAND:   return 2;
+    case MessageType::HEIGHT_COMMAND: return 3;
+    default:                          return NO_SLOT;
+    }
+}
+
+bool CommandQueue::isLatestWins(uint8_t type)
+{
+    return slotFor(type) != NO_SLOT;
+}
+
+void CommandQueue::push(uint8_t type, std::string payload)
+{
+    const int slot = slotFor(type);
+    if (slot == NO_SLOT) {
+        Entry entry;
+        entry.command.type = type;
+        entry.command.payload = std::move(payload);
+        m_queue.push(std::move(entry));
+        return;
+    }
+
+    auto *command = new OutboundCommand{type, std::move(payload)};
+    OutboundCommand *previous = m_latest[slot].exchange(command, std::memory_order_acq_rel);
+    if (previous) {
+        // Still unsent: its marker is already queued and will pick up ours
+        delete previous;
+        m_collapsed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Entry marker;
+    marker.slot = slot;
+    m_queue.push(std::move(marker));
+}
+
+bool CommandQueue::tryPop(OutboundCommand &out)
+{
+    Entry entry;
+    while (m_queue.tryPop(entry)) {
+        if (entry.slot == NO_SLOT) {
+            out = std::move(entry.command);
+            return true;
+        }
+        OutboundCommand *command = m_latest[entry.slot].exchange(nullptr, std::memory_order_acq_rel);
+        if (command) {
+            out = std::move(*command);
+            delete command;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t CommandQueue::takeCollapsedCount()
+{
+    return m_collapsed.exchange(0, std::memory_order_relaxed);
+}
+
+} // namespace Spider2
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "MpscQueue.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Serialized client→robot message waiting to be sent
+ */
+struct OutboundCommand {
+    uint8_t type{0};
+    std::string payload;
+};
+
+/**
+ * @brief Outbound commands handed from any thread to the socket-owning thread
+ *
+ * Commands are serialized by the caller and sent in push order. Setpoint
+ * commands (MOVE, PITCH, ROLL, HEIGHT) are latest-wins: while one of them is
+ * still waiting, a newer one of the same type replaces its payload in place
+ * instead of queueing behind it, so a slider drag never builds a backlog.
+ */
+class CommandQueue
+{
+public:
+    CommandQueue() = default;
+    ~CommandQueue();
+
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    /// @brief Any thread
+    void push(uint8_t type, std::string payload);
+
+    /// @brief Consumer thread only. Returns false when nothing is waiting.
+    bool tryPop(OutboundCommand &out);
+
+    /// @brief Commands replaced by a newer one of the same type since the previous call
+    uint64_t takeCollapsedCount();
+
+    static bool isLatestWins(uint8_t type);
+
+private:
+    static constexpr int NO_SLOT = -1;
+    static constexpr size_t SLOT_COUNT = 4;
+
+    // Queue entry: either a command, or a marker saying "send whatever is in
+    // latest-wins slot N now". A marker is queued only when its slot goes from
+    // empty to full, so each pending slot has exactly one marker.
+    struct Entry {
+        int slot{NO_SLOT};
+        OutboundCommand command;
+    };
+
+    static int slotFor(uint8_t type);
+
+    MpscQueue<Entry> m_queue;
+    std::array<std::atomic<OutboundCommand*>, SLOT_COUNT> m_latest{};
+    std::atomic<uint64_t> m_collapsed{0};
+};
+
+} // namespace Spider2
@@ -0,0 +1,63 @@
+#include "FramePublisher.h"
+#include <QQuickWindow>
+
+FramePublisher::FramePublisher(Handler handler, QObject *parent)
+    : QObject(parent)
+    , m_handler(std::move(handler))
+{
+    m_fallbackTimer.setSingleShot(true);
+    m_fallbackTimer.setInterval(FALLBACK_INTERVAL_MS);
+    connect(&m_fallbackTimer, &QTimer::timeout, this, &FramePublisher::publishNow);
+}
+
+void FramePublisher::setWindow(QQuickWindow *window)
+{
+    if (m_window == window)
+        return;
+
+    if (m_frameConnection)
+        disconnect(m_frameConnection);
+
+    m_window = window;
+    if (m_window) {
+        // Emitted on the GUI thread before every scene-graph sync
+        m_frameConnection = connect(m_window, &QQuickWindow::afterAnimating,
+                                    this, &FramePublisher::publishNow);
+    }
+}
+
+void FramePublisher::markDirty(uint32_t channels)
+{
+    // Only the first change after a publish costs an event
+    if (m_dirty.fetch_or(channels, std::memory_order_acq_rel) == 0) {
+        QMetaObject::invokeMethod(this, &FramePublisher::schedule, Qt::QueuedConnection);
+    }
+}
+
+void FramePublisher::schedule()
+{
+    if (m_window && m_window->isExposed()) {
+        m_window->update();
+    }
+    // Covers no window, a hidden window and frames that never come
+    if (!m_fallbackTimer.isActive()) {
+        m_fallbackTimer.start();
+    }
+}
+
+void FramePublisher::publishNow()
+{
+    m_fallbackTimer.stop();
+    const uint32_t dirty = m_dirty.exchange(0, std::memory_order_acq_rel);
+    if (dirty == 0)
+        return;
+    ++m_publishCount;
+    m_handler(dirty);
+}
+
+uint64_t FramePublisher::takePublishCount()
+{
+    const uint64_t count = m_publishCount;
+    m_publishCount = 0;
+    return count;
+}
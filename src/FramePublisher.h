@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+class QQuickWindow;
+
+/**
+ * @brief Applies state produced on worker threads once per rendered frame
+ *
+ * Producers store their newest results in lock-free slots and call
+ * markDirty() with a channel bit. Only the clean→dirty transition posts an
+ * event to the GUI thread; it asks the window for a frame, and the publish
+ * handler runs on QQuickWindow::afterAnimating, right before the scene graph
+ * syncs. Everything that changed since the previous frame is therefore
+ * applied in one go, and each NOTIFY signal fires at most once per frame.
+ *
+ * Without a window (headless) or while it is not exposed, a short timer
+ * publishes instead, so state never piles up.
+ */
+class FramePublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @brief Runs on the GUI thread with the channels marked since the previous publish
+    using Handler = std::function<void(uint32_t dirty)>;
+
+    explicit FramePublisher(Handler handler, QObject *parent = nullptr);
+
+    /// @brief GUI thread. Publishing follows this window's frames; nullptr = timer only.
+    void setWindow(QQuickWindow *window);
+
+    /// @brief Any thread
+    void markDirty(uint32_t channels);
+
+    /// @brief GUI thread. Apply everything pending immediately.
+    void publishNow();
+
+    /// @brief Number of publishes since the previous call
+    uint64_t takePublishCount();
+
+    static constexpr int FALLBACK_INTERVAL_MS = 50;
+
+private slots:
+    void schedule();
+
+private:
+    Handler m_handler;
+    std::atomic<uint32_t> m_dirty{0};
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_frameConnection;
+    QTimer m_fallbackTimer;
+    uint64_t m_publishCount{0};
+};
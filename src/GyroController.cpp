@@ -32,6 +32,11 @@ void GyroController::updateGyroData(float x, float y, float z, qint64 timestamp)
     
 }
 
+void GyroController::addReadings(const QVector<GyroReading> &readings)
+{
+    m_model->addReadings(readings);
+}
+
 void GyroController::clearData()
 {
     m_model->clearData();
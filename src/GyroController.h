@@ -34,6 +34,8 @@ public:
 
 public slots:
     void updateGyroData(float x, float y, float z, qint64 timestamp = 0);
+    /// @brief Add every sample of one receive batch (oldest first) in one model update
+    void addReadings(const QVector<GyroReading> &readings);
     void clearData();
 
 signals:
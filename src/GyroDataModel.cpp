@@ -1,5 +1,6 @@
 #include "GyroDataModel.h"
 #include <QDebug>
+#include <algorithm>
 #include <cmath>
 
 GyroDataModel::GyroDataModel(QObject *parent)
@@ -68,6 +69,37 @@ void GyroDataModel::addReading(const GyroReading &reading)
     
 }
 
+void GyroDataModel::addReadings(const QVector<GyroReading> &readings)
+{
+    if (readings.isEmpty()) {
+        return;
+    }
+
+    // Rows are newest first; readings older than the buffer never become rows
+    const int count = std::min<int>(readings.size(), MAX_READINGS);
+    const int overflow = m_readings.size() + count - MAX_READINGS;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), m_readings.size() - overflow, m_readings.size() - 1);
+        m_readings.remove(m_readings.size() - overflow, overflow);
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), 0, count - 1);
+    QVector<GyroReading> rows;
+    rows.reserve(count + m_readings.size());
+    for (int i = readings.size() - 1; i >= readings.size() - count; --i) {
+        rows.append(readings[i]);
+    }
+    rows.append(m_readings);
+    m_readings = std::move(rows);
+    endInsertRows();
+
+    emit dataUpdated();
+    for (const GyroReading &reading : readings) {
+        emit newReading(reading);
+    }
+}
+
 void GyroDataModel::clearData()
 {
     beginResetModel();
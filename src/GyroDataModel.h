@@ -46,6 +46,8 @@ public:
 
     // Public interface
     void addReading(const GyroReading &reading);
+    /// @brief Append readings given oldest first, as one row insertion
+    void addReadings(const QVector<GyroReading> &readings);
     void clearData();
     int readingCount() const { return m_readings.size(); }
     
@@ -0,0 +1,38 @@
+#include "ImageTexture.h"
+#include <rhi/qrhi.h>
+
+ImageTexture::~ImageTexture()
+{
+    delete m_texture;
+}
+
+void ImageTexture::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates)
+{
+    if (m_pending.isNull())
+        return;
+
+    // RGB32 / ARGB32 are BGRA in memory: upload as-is when the backend can
+    // sample BGRA, otherwise swizzle once on the CPU
+    QImage image = m_pending;
+    QRhiTexture::Format format = QRhiTexture::RGBA8;
+    if (rhi->isTextureFormatSupported(QRhiTexture::BGRA8)
+        && (image.format() == QImage::Format_RGB32
+            || image.format() == QImage::Format_ARGB32_Premultiplied)) {
+        format = QRhiTexture::BGRA8;
+    } else if (image.format() != QImage::Format_RGBA8888_Premultiplied) {
+        image = image.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    }
+
+    if (!m_texture || m_texture->pixelSize() != image.size() || m_texture->format() != format) {
+        delete m_texture;
+        m_texture = rhi->newTexture(format, image.size());
+        if (!m_texture->create()) {
+            delete m_texture;
+            m_texture = nullptr;
+            return;
+        }
+    }
+
+    resourceUpdates->uploadTexture(m_texture, image);
+    m_pending = QImage();
+}
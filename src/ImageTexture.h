@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QImage>
+#include <QSGTexture>
+#include <QSize>
+
+class QRhiTexture;
+
+/**
+ * @brief Reusable RHI texture whose contents are replaced in place
+ *
+ * The scene graph calls commitTextureOperations() before it samples the
+ * texture, which is where the pending image is uploaded. The QRhiTexture is
+ * only recreated when the image size or pixel format changes. Opaque images
+ * only; needs the RHI backend (see QQuickWindow::rhi()).
+ */
+class ImageTexture : public QSGTexture
+{
+public:
+    ~ImageTexture() override;
+
+    qint64 comparisonKey() const override { return qint64(qintptr(this)); }
+    QRhiTexture *rhiTexture() const override { return m_texture; }
+    QSize textureSize() const override { return m_size; }
+    bool hasAlphaChannel() const override { return false; }
+    bool hasMipmaps() const override { return false; }
+
+    /// @brief Upload @p image on the next commit; replaces an image not uploaded yet
+    void setImage(const QImage &image)
+    {
+        m_pending = image;
+        m_size = image.size();
+    }
+
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override;
+
+private:
+    QRhiTexture *m_texture{nullptr};
+    QImage m_pending;
+    QSize m_size;
+};
@@ -0,0 +1,328 @@
+#include "IngestPipeline.h"
+#include <algorithm>
+#include <chrono>
+#include "MessageTypes.hpp"
+#include "ThreadName.h"
+
+namespace Spider2 {
+
+namespace {
+
+size_t queueCapacity(IngestStream stream)
+{
+    switch (stream) {
+        case IngestStream::CONTROL:
+        case IngestStream::TELEMETRY:
+        case IngestStream::GYRO:
+            return 256;   // small, bursty messages
+        default:
+            return 64;    // ~2 s of video at 30 fps
+    }
+}
+
+DropPolicy defaultPolicy(IngestStream stream)
+{
+    switch (stream) {
+        case IngestStream::CONTROL:
+        case IngestStream::GYRO:      // gait analysis needs the full sample history
+        case IngestStream::TELEMETRY: // one stream, many metrics: coalesced per name by the handler
+            return DropPolicy::KEEP_ALL;
+        default:
+            return DropPolicy::KEEP_LATEST;
+    }
+}
+
+} // namespace
+
+IngestPipeline::IngestPipeline(Handler handler, unsigned workerCount)
+    : m_handler(std::move(handler))
+{
+    for (size_t i = 0; i < m_queues.size(); ++i) {
+        const auto stream = static_cast<IngestStream>(i);
+        m_queues[i] = std::make_unique<Queue>(queueCapacity(stream));
+        m_queues[i]->policy.store(static_cast<uint8_t>(defaultPolicy(stream)), std::memory_order_relaxed);
+    }
+
+    if (workerCount == 0) {
+        // Leave one core for the receive thread
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        workerCount = cores > 1 ? cores - 1 : 1;
+    }
+    workerCount = std::min<unsigned>(workerCount, static_cast<unsigned>(IngestStream::COUNT));
+
+    for (unsigned i = 0; i < workerCount; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+
+    assignStreams();
+}
+
+IngestPipeline::~IngestPipeline()
+{
+    stop();
+}
+
+void IngestPipeline::assignStreams()
+{
+    // VIDEO (JPEG decode) and SLAM_MAP (large grids) are the expensive stages:
+    // give them their own workers when possible and spread the light streams
+    // over whatever is left.
+    const unsigned n = static_cast<unsigned>(m_workers.size());
+    const IngestStream light[] = {
+        IngestStream::GYRO, IngestStream::LIDAR, IngestStream::SLAM_POSE,
+        IngestStream::TELEMETRY, IngestStream::OBJECT_TRACKING, IngestStream::CONTROL
+    };
+
+    auto assign = [this](IngestStream stream, unsigned worker) {
+        queue(stream).worker = worker;
+        m_workers[worker]->streams.push_back(stream);
+    };
+
+    if (n == 1) {
+        assign(IngestStream::VIDEO, 0);
+        assign(IngestStream::SLAM_MAP, 0);
+        for (IngestStream s : light) assign(s, 0);
+    } else if (n == 2) {
+        assign(IngestStream::VIDEO, 0);
+        assign(IngestStream::SLAM_MAP, 1);
+        for (IngestStream s : light) assign(s, 1);
+    } else {
+        assign(IngestStream::VIDEO, 0);
+        assign(IngestStream::SLAM_MAP, 1);
+        unsigned next = 0;
+        for (IngestStream s : light) assign(s, 2 + (next++ % (n - 2)));
+    }
+}
+
+void IngestPipeline::start()
+{
+    if (m_running.exchange(true)) return;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        Worker *w = m_workers[i].get();
+        w->signalled = false;
+        w->thread = std::thread([this, w, i]() {
+            setCurrentThreadName("s2-ingest-" + std::to_string(i));
+            workerLoop(*w);
+        });
+    }
+}
+
+void IngestPipeline::stop()
+{
+    if (!m_running.exchange(false)) return;
+    for (auto &worker : m_workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->signalled = true;
+        }
+        worker->wake.notify_one();
+    }
+    for (auto &worker : m_workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+
+    // Both endpoints are quiet now: release any frames still queued
+    RawFrame discard;
+    for (auto &q : m_queues) {
+        while (q->frames.tryPop(discard)) {}
+        q->parked = RawFrame();
+        q->hasParked = false;
+    }
+}
+
+void IngestPipeline::push(RawFrame &&frame)
+{
+    Queue &q = queue(streamFor(frame.type));
+
+    // A parked frame is older than this one; for KEEP_LATEST it is now stale
+    if (q.hasParked) {
+        q.parked = RawFrame();
+        q.hasParked = false;
+        q.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!tryEnqueue(q, std::move(frame))) {
+        if (static_cast<DropPolicy>(q.policy.load(std::memory_order_relaxed)) == DropPolicy::KEEP_LATEST) {
+            q.parked = std::move(frame);
+            q.hasParked = true;
+        } else {
+            q.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void IngestPipeline::flush()
+{
+    for (auto &q : m_queues) {
+        if (q->hasParked && tryEnqueue(*q, std::move(q->parked))) {
+            q->parked = RawFrame();
+            q->hasParked = false;
+        }
+    }
+}
+
+bool IngestPipeline::canAccept(uint8_t messageType) const
+{
+    const Queue &q = queue(streamFor(messageType));
+    return !q.hasParked && q.frames.sizeApprox() < q.frames.capacity();
+}
+
+size_t IngestPipeline::pendingFrames() const
+{
+    size_t pending = 0;
+    for (const auto &q : m_queues)
+        pending += q->frames.sizeApprox() + (q->hasParked ? 1 : 0);
+    return pending;
+}
+
+bool IngestPipeline::tryEnqueue(Queue &q, RawFrame &&frame)
+{
+    if (!q.frames.tryPush(std::move(frame)))
+        return false;
+    notify(*m_workers[q.worker]);
+    return true;
+}
+
+void IngestPipeline::notify(Worker &worker)
+{
+    // Pairs with the fence in workerLoop: either the worker sees our frame
+    // when it re-checks its queues, or we see it is about to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.signalled = true;
+        }
+        worker.wake.notify_one();
+    }
+}
+
+void IngestPipeline::workerLoop(Worker &worker)
+{
+    while (m_running.load(std::memory_order_acquire)) {
+        bool worked = false;
+        for (IngestStream stream : worker.streams)
+            worked |= drain(worker, stream);
+        if (worked) continue;
+
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        worker.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const bool pending = std::any_of(worker.streams.begin(), worker.streams.end(),
+                                         [this](IngestStream s) { return !queue(s).frames.emptyApprox(); });
+        if (!pending && !worker.signalled) {
+            worker.wake.wait_for(lock, std::chrono::milliseconds(50), [&]() {
+                return worker.signalled || !m_running.load(std::memory_order_acquire);
+            });
+        }
+        worker.signalled = false;
+        worker.sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+bool IngestPipeline::drain(Worker &worker, IngestStream stream)
+{
+    Queue &q = queue(stream);
+    std::vector<RawFrame> &batch = worker.batch;
+
+    // Bound one drain to a queue's worth so a fast producer cannot starve
+    // the worker's other streams
+    RawFrame frame;
+    for (size_t i = 0; i < q.frames.capacity() && q.frames.tryPop(frame); ++i)
+        batch.push_back(std::move(frame));
+    if (batch.empty())
+        return false;
+
+    if (static_cast<DropPolicy>(q.policy.load(std::memory_order_relaxed)) == DropPolicy::KEEP_LATEST
+        && batch.size() > 1) {
+        q.dropped.fetch_add(batch.size() - 1, std::memory_order_relaxed);
+        batch.front() = std::move(batch.back());
+        batch.resize(1);
+    }
+
+    q.delivered.fetch_add(batch.size(), std::memory_order_relaxed);
+    m_handler(stream, batch);
+    batch.clear();   // drop payload references, keep capacity
+    return true;
+}
+
+void IngestPipeline::setPolicy(IngestStream stream, DropPolicy policy)
+{
+    queue(stream).policy.store(static_cast<uint8_t>(policy), std::memory_order_relaxed);
+}
+
+DropPolicy IngestPipeline::policy(IngestStream stream) const
+{
+    return static_cast<DropPolicy>(queue(stream).policy.load(std::memory_order_relaxed));
+}
+
+IngestPipeline::QueueStats IngestPipeline::stats(IngestStream stream) const
+{
+    const Queue &q = queue(stream);
+    QueueStats s;
+    s.depth = q.frames.sizeApprox();
+    s.capacity = q.frames.capacity();
+    s.delivered = q.delivered.load(std::memory_order_relaxed);
+    s.dropped = q.dropped.load(std::memory_order_relaxed);
+    s.policy = static_cast<DropPolicy>(q.policy.load(std::memory_order_relaxed));
+    return s;
+}
+
+IngestStream IngestPipeline::streamFor(uint8_t messageType)
+{
+    switch (static_cast<MessageType>(messageType)) {
+        case MessageType::TELEMETRY_UPDATE:     return IngestStream::TELEMETRY;
+        case MessageType::GYRO_DATA:            return IngestStream::GYRO;
+        case MessageType::LIDAR_DATA:           return IngestStream::LIDAR;
+        case MessageType::VIDEO_FRAME:          return IngestStream::VIDEO;
+        case MessageType::SLAM_POSE:            return IngestStream::SLAM_POSE;
+        case MessageType::SLAM_MAP:             return IngestStream::SLAM_MAP;
+        case MessageType::OBJECT_TRACKING_DATA: return IngestStream::OBJECT_TRACKING;
+        default:                                return IngestStream::CONTROL;
+    }
+}
+
+const char *IngestPipeline::streamName(IngestStream stream)
+{
+    switch (stream) {
+        case IngestStream::CONTROL:         return "control";
+        case IngestStream::TELEMETRY:       return "telemetry";
+        case IngestStream::GYRO:            return "gyro";
+        case IngestStream::LIDAR:           return "lidar";
+        case IngestStream::VIDEO:           return "video";
+        case IngestStream::SLAM_POSE:       return "slam_pose";
+        case IngestStream::SLAM_MAP:        return "slam_map";
+        case IngestStream::OBJECT_TRACKING: return "object_tracking";
+        default:                            return "unknown";
+    }
+}
+
+const char *IngestPipeline::policyName(DropPolicy policy)
+{
+    return policy == DropPolicy::KEEP_ALL ? "keep_all" : "keep_latest";
+}
+
+bool IngestPipeline::streamFromName(const std::string &name, IngestStream &stream)
+{
+    for (size_t i = 0; i < static_cast<size_t>(IngestStream::COUNT); ++i) {
+        if (name == streamName(static_cast<IngestStream>(i))) {
+            stream = static_cast<IngestStream>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IngestPipeline::policyFromName(const std::string &name, DropPolicy &policy)
+{
+    for (DropPolicy candidate : {DropPolicy::KEEP_LATEST, DropPolicy::KEEP_ALL}) {
+        if (name == policyName(candidate)) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Spider2
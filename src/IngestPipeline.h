@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RawFrame.h"
+#include "SpscQueue.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Inbound stream classes, one bounded queue each
+ */
+enum class IngestStream : uint8_t {
+    CONTROL = 0,        ///< Heartbeats, acks and anything not listed below
+    TELEMETRY,
+    GYRO,
+    LIDAR,
+    VIDEO,
+    SLAM_POSE,
+    SLAM_MAP,
+    OBJECT_TRACKING,
+    COUNT
+};
+
+/**
+ * @brief What a stream queue does with frames the consumer cannot keep up with
+ */
+enum class DropPolicy : uint8_t {
+    /// Only the newest queued frame is delivered; older ones are dropped as
+    /// stale. On overflow the receive thread parks the newest frame and drops
+    /// the one it replaces, so the latest value is never lost.
+    KEEP_LATEST = 0,
+    /// Every frame is delivered in arrival order. On overflow the incoming
+    /// frame is dropped.
+    KEEP_ALL = 1
+};
+
+/**
+ * @brief Staged receive pipeline: demultiplex on the receive thread, decode on workers
+ *
+ * The receive thread only calls push()/flush(); it classifies each frame by
+ * its Spider2::MessageType and hands it to the stream's SpscQueue. A pool of
+ * worker threads (sized to the core count) drains the queues, applies each
+ * stream's DropPolicy and passes the surviving frames to the handler. Every
+ * queue is owned by exactly one worker, so parsing of a stream stays ordered
+ * and a slow JPEG decode never delays gyro, lidar or pose handling. VIDEO gets
+ * a worker of its own whenever more than one worker is available.
+ */
+class IngestPipeline
+{
+public:
+    /// @brief Called on a worker thread with the frames of one drain of one stream
+    using Handler = std::function<void(IngestStream, const std::vector<RawFrame> &)>;
+
+    struct QueueStats {
+        size_t depth{0};
+        size_t capacity{0};
+        uint64_t delivered{0};
+        uint64_t dropped{0};
+        DropPolicy policy{DropPolicy::KEEP_LATEST};
+    };
+
+    explicit IngestPipeline(Handler handler, unsigned workerCount = 0);
+    ~IngestPipeline();
+
+    IngestPipeline(const IngestPipeline &) = delete;
+    IngestPipeline &operator=(const IngestPipeline &) = delete;
+
+    void start();
+    void stop();
+
+    /// @brief Receive thread only. Never blocks.
+    void push(RawFrame &&frame);
+    /// @brief Receive thread only. Retries frames parked by KEEP_LATEST overflow.
+    void flush();
+    /// @brief Receive thread only. True when push() of @p messageType would queue without dropping.
+    bool canAccept(uint8_t messageType) const;
+    /// @brief Receive thread only. Frames queued or parked and not yet taken by a worker.
+    size_t pendingFrames() const;
+
+    /// @brief Any thread; takes effect from the stream's next drain
+    void setPolicy(IngestStream stream, DropPolicy policy);
+    DropPolicy policy(IngestStream stream) const;
+    QueueStats stats(IngestStream stream) const;
+    unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+    static IngestStream streamFor(uint8_t messageType);
+    static const char *streamName(IngestStream stream);
+    static const char *policyName(DropPolicy policy);
+    /// @brief Inverse of streamName()/policyName(); false for unknown names
+    static bool streamFromName(const std::string &name, IngestStream &stream);
+    static bool policyFromName(const std::string &name, DropPolicy &policy);
+
+private:
+    struct Queue {
+        explicit Queue(size_t capacity) : frames(capacity) {}
+        SpscQueue<RawFrame> frames;
+        std::atomic<uint8_t> policy{static_cast<uint8_t>(DropPolicy::KEEP_LATEST)};
+        std::atomic<uint64_t> delivered{0};
+        std::atomic<uint64_t> dropped{0};
+        RawFrame parked;            // receive-thread private: newest frame that did not fit
+        bool hasParked{false};
+        unsigned worker{0};
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::vector<IngestStream> streams;
+        std::vector<RawFrame> batch;   // reused between drains
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> sleeping{false};
+        bool signalled{false};
+    };
+
+    void assignStreams();
+    void notify(Worker &worker);
+    bool tryEnqueue(Queue &queue, RawFrame &&frame);
+    void workerLoop(Worker &worker);
+    bool drain(Worker &worker, IngestStream stream);
+    Queue &queue(IngestStream stream) { return *m_queues[static_cast<size_t>(stream)]; }
+    const Queue &queue(IngestStream stream) const { return *m_queues[static_cast<size_t>(stream)]; }
+
+    Handler m_handler;
+    std::array<std::unique_ptr<Queue>, static_cast<size_t>(IngestStream::COUNT)> m_queues;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_running{false};
+};
+
+} // namespace Spider2
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace Spider2 {
+
+/**
+ * @brief Which received frames make up the client state at a point in time
+ *
+ * Per message type, the number of newest frames that must be applied to
+ * rebuild what the GUI shows: one SLAM map, the lidar revolutions that are
+ * blended together, the gyro ring, and so on. The recorder snapshots these
+ * frames into keyframes; a seek replays the same selection instead of
+ * everything since the start.
+ */
+struct KeyframePolicy {
+    /// @brief Keep the newest frame per TelemetryUpdate.name
+    static constexpr uint32_t PER_NAME = std::numeric_limits<uint32_t>::max();
+
+    /// @brief Indexed by Spider2::MessageType; 0 = not part of the state (commands, heartbeats)
+    std::array<uint32_t, 32> depth{};
+
+    uint32_t depthOf(uint8_t type) const { return type < depth.size() ? depth[type] : 0; }
+    bool isEmpty() const
+    {
+        for (uint32_t d : depth) {
+            if (d != 0)
+                return false;
+        }
+        return true;
+    }
+};
+
+} // namespace Spider2
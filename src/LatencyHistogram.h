@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Spider2 {
+
+/**
+ * @brief Lock-free log-linear (HDR-style) histogram of durations in microseconds
+ *
+ * Values below 16 µs get exact buckets; above that every power-of-two range
+ * is split into 16 linear sub-buckets, so any reported percentile is within
+ * ~6% of the true value up to ~2^40 µs. record() may be called concurrently
+ * from any number of threads.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    /**
+     * @brief Plain (non-atomic) copy of a histogram for reporting
+     */
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_COUNT> counts{};
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t max{0};
+
+        /// @brief Value at quantile @p q (0..1), in microseconds
+        uint64_t percentile(double q) const {
+            if (count == 0) return 0;
+            if (q >= 1.0) return max;
+            const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    const uint64_t v = bucketMidpoint(i);
+                    return v < max ? v : max;
+                }
+            }
+            return max;
+        }
+
+        double mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+        void merge(const Snapshot &other) {
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) counts[i] += other.counts[i];
+            count += other.count;
+            sum += other.sum;
+            if (other.max > max) max = other.max;
+        }
+    };
+
+    void record(uint64_t valueUs) {
+        m_counts[bucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(valueUs, std::memory_order_relaxed);
+        uint64_t prev = m_max.load(std::memory_order_relaxed);
+        while (valueUs > prev && !m_max.compare_exchange_weak(prev, valueUs, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief Copy the current contents
+     * @param reset Also clear the histogram, so the next snapshot covers a fresh interval
+     */
+    Snapshot snapshot(bool reset = false) {
+        Snapshot s;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            s.counts[i] = reset ? m_counts[i].exchange(0, std::memory_order_relaxed)
+                                : m_counts[i].load(std::memory_order_relaxed);
+            s.count += s.counts[i];
+        }
+        s.sum = reset ? m_sum.exchange(0, std::memory_order_relaxed) : m_sum.load(std::memory_order_relaxed);
+        s.max = reset ? m_max.exchange(0, std::memory_order_relaxed) : m_max.load(std::memory_order_relaxed);
+        if (reset) m_count.store(0, std::memory_order_relaxed);
+        return s;
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    void reset() { snapshot(true); }
+
+    static size_t bucketIndex(uint64_t v) {
+        if (v < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<size_t>(v);
+        int exponent = 63;
+        while (!(v >> exponent)) --exponent;       // floor(log2 v), >= SUB_BUCKET_BITS here
+        if (exponent >= MAX_EXPONENT) return BUCKET_COUNT - 1;
+        const int shift = exponent - SUB_BUCKET_BITS;
+        const size_t sub = static_cast<size_t>((v >> shift) & (SUB_BUCKETS - 1));
+        return SUB_BUCKETS + static_cast<size_t>(shift) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t bucketMidpoint(size_t index) {
+        if (index < static_cast<size_t>(SUB_BUCKETS)) return index;
+        const size_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        const uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        const uint64_t lower = (static_cast<uint64_t>(SUB_BUCKETS) + sub) << shift;
+        return lower + ((uint64_t(1) << shift) >> 1);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+} // namespace Spider2
@@ -0,0 +1,251 @@
+#include "LatencyMonitor.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQuickWindow>
+#include <chrono>
+
+namespace {
+
+double toMs(uint64_t us)
+{
+    return static_cast<double>(us) / 1000.0;
+}
+
+// Streams whose messages carry a robot timestamp
+bool isTimestamped(Spider2::IngestStream stream)
+{
+    switch (stream) {
+        case Spider2::IngestStream::GYRO:
+        case Spider2::IngestStream::LIDAR:
+        case Spider2::IngestStream::VIDEO:
+        case Spider2::IngestStream::SLAM_POSE:
+        case Spider2::IngestStream::SLAM_MAP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+LatencyMonitor::LatencyMonitor(QObject *parent)
+    : QObject(parent)
+    , m_interval(std::make_unique<std::array<std::array<Spider2::LatencyHistogram, STAGE_COUNT>, STREAM_COUNT>>())
+    , m_cumulative(std::make_unique<std::array<std::array<Spider2::LatencyHistogram::Snapshot, STAGE_COUNT>, STREAM_COUNT>>())
+{
+    m_summaryTimer.setInterval(1000);
+    connect(&m_summaryTimer, &QTimer::timeout, this, &LatencyMonitor::updateSummary);
+    m_summaryTimer.start();
+}
+
+LatencyMonitor::~LatencyMonitor()
+{
+    setWindow(nullptr);
+}
+
+int64_t LatencyMonitor::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char *LatencyMonitor::stageName(Stage stage)
+{
+    switch (stage) {
+        case NETWORK: return "network";
+        case PARSE:   return "parse";
+        case APPLY:   return "apply";
+        case PRESENT: return "present";
+        case TOTAL:   return "total";
+        default:      return "unknown";
+    }
+}
+
+void LatencyMonitor::record(Stream stream, Stage stage, int64_t us)
+{
+    // A robot clock slightly ahead of ours shows up as negative network time
+    (*m_interval)[static_cast<size_t>(stream)][stage].record(us > 0 ? static_cast<uint64_t>(us) : 0);
+}
+
+int64_t LatencyMonitor::parsed(Stream stream, int64_t robotMs, int64_t receivedUs)
+{
+    const int64_t now = nowUs();
+    if (robotMs > 0 && receivedUs > 0) {
+        record(stream, NETWORK, receivedUs - robotToLocalUs(robotMs));
+    }
+    if (receivedUs > 0) {
+        record(stream, PARSE, now - receivedUs);
+    }
+    return now;
+}
+
+void LatencyMonitor::applied(Stream stream, int64_t robotMs, int64_t parsedUs)
+{
+    const int64_t now = nowUs();
+    if (parsedUs > 0) {
+        record(stream, APPLY, now - parsedUs);
+    }
+    if (!m_window) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_pending[static_cast<size_t>(stream)] = Pending{robotMs, now};
+}
+
+void LatencyMonitor::setClockOffsetUs(qint64 offsetUs)
+{
+    if (m_clockOffsetUs.exchange(offsetUs, std::memory_order_relaxed) != offsetUs) {
+        QMetaObject::invokeMethod(this, &LatencyMonitor::clockOffsetChanged, Qt::QueuedConnection);
+    }
+}
+
+void LatencyMonitor::setWindow(QQuickWindow *window)
+{
+    if (m_window == window)
+        return;
+
+    if (m_swapConnection)
+        disconnect(m_swapConnection);
+
+    m_window = window;
+    if (m_window) {
+        // Emitted on the render thread right after the frame was handed to the display
+        m_swapConnection = connect(m_window, &QQuickWindow::frameSwapped,
+                                   this, &LatencyMonitor::onFrameSwapped, Qt::DirectConnection);
+    }
+}
+
+void LatencyMonitor::onFrameSwapped()
+{
+    const int64_t now = nowUs();
+    std::array<Pending, STREAM_COUNT> presented;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        presented = m_pending;
+        m_pending.fill(Pending());
+    }
+    for (size_t i = 0; i < STREAM_COUNT; ++i) {
+        if (presented[i].appliedUs == 0)
+            continue;
+        const auto stream = static_cast<Stream>(i);
+        record(stream, PRESENT, now - presented[i].appliedUs);
+        if (presented[i].robotMs > 0)
+            record(stream, TOTAL, now - robotToLocalUs(presented[i].robotMs));
+    }
+}
+
+void LatencyMonitor::updateSummary()
+{
+    QVariantMap summary;
+    for (size_t i = 0; i < STREAM_COUNT; ++i) {
+        const auto stream = static_cast<Stream>(i);
+        QVariantMap stages;
+        for (size_t s = 0; s < STAGE_COUNT; ++s) {
+            const Spider2::LatencyHistogram::Snapshot snapshot = (*m_interval)[i][s].snapshot(true);
+            (*m_cumulative)[i][s].merge(snapshot);
+            if (snapshot.count == 0)
+                continue;
+            QVariantMap entry;
+            entry["count"] = static_cast<qulonglong>(snapshot.count);
+            entry["p50_ms"] = toMs(snapshot.percentile(0.50));
+            entry["p99_ms"] = toMs(snapshot.percentile(0.99));
+            entry["max_ms"] = toMs(snapshot.max);
+            stages[QString::fromLatin1(stageName(static_cast<Stage>(s)))] = entry;
+        }
+        if (!stages.isEmpty() || isTimestamped(stream))
+            summary[QString::fromLatin1(Spider2::IngestPipeline::streamName(stream))] = stages;
+    }
+    m_summary = summary;
+    emit summaryChanged();
+}
+
+bool LatencyMonitor::lookup(const QString &stream, const QString &stage, size_t &streamIndex, size_t &stageIndex) const
+{
+    Spider2::IngestStream ingestStream;
+    if (!Spider2::IngestPipeline::streamFromName(stream.toStdString(), ingestStream))
+        return false;
+    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+        if (stage == QLatin1String(stageName(static_cast<Stage>(s)))) {
+            streamIndex = static_cast<size_t>(ingestStream);
+            stageIndex = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+double LatencyMonitor::percentileMs(const QString &stream, const QString &stage, double quantile) const
+{
+    size_t i = 0;
+    size_t s = 0;
+    if (!lookup(stream, stage, i, s))
+        return 0.0;
+    return toMs((*m_cumulative)[i][s].percentile(quantile));
+}
+
+bool LatencyMonitor::dumpToFile(const QString &path) const
+{
+    QJsonObject streams;
+    for (size_t i = 0; i < STREAM_COUNT; ++i) {
+        QJsonObject stages;
+        for (size_t s = 0; s < STAGE_COUNT; ++s) {
+            const Spider2::LatencyHistogram::Snapshot &snapshot = (*m_cumulative)[i][s];
+            if (snapshot.count == 0)
+                continue;
+
+            // Non-empty buckets as [value_us, count] pairs, enough to rebuild the histogram
+            QJsonArray buckets;
+            for (size_t b = 0; b < Spider2::LatencyHistogram::BUCKET_COUNT; ++b) {
+                if (snapshot.counts[b] == 0)
+                    continue;
+                buckets.append(QJsonArray{static_cast<qint64>(Spider2::LatencyHistogram::bucketMidpoint(b)),
+                                          static_cast<qint64>(snapshot.counts[b])});
+            }
+
+            QJsonObject entry;
+            entry["count"] = static_cast<qint64>(snapshot.count);
+            entry["mean_ms"] = snapshot.mean() / 1000.0;
+            entry["p50_ms"] = toMs(snapshot.percentile(0.50));
+            entry["p90_ms"] = toMs(snapshot.percentile(0.90));
+            entry["p99_ms"] = toMs(snapshot.percentile(0.99));
+            entry["p999_ms"] = toMs(snapshot.percentile(0.999));
+            entry["max_ms"] = toMs(snapshot.max);
+            entry["buckets_us"] = buckets;
+            stages[QString::fromLatin1(stageName(static_cast<Stage>(s)))] = entry;
+        }
+        if (!stages.isEmpty())
+            streams[QString::fromLatin1(Spider2::IngestPipeline::streamName(static_cast<Stream>(i)))] = stages;
+    }
+
+    QJsonObject root;
+    root["clock_offset_us"] = clockOffsetUs();
+    root["streams"] = streams;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "[LATENCY] Cannot write" << path << ":" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    qInfo() << "[LATENCY] Histograms written to" << path;
+    return true;
+}
+
+void LatencyMonitor::reset()
+{
+    for (auto &stages : *m_interval) {
+        for (auto &histogram : stages)
+            histogram.reset();
+    }
+    for (auto &stages : *m_cumulative)
+        stages.fill(Spider2::LatencyHistogram::Snapshot());
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_pending.fill(Pending());
+    }
+    m_summary.clear();
+    emit summaryChanged();
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "IngestPipeline.h"
+#include "LatencyHistogram.h"
+
+class QQuickWindow;
+
+/**
+ * @brief End-to-end latency of the timestamped robot streams, per stage
+ *
+ * For every stream (keyed like the ingest queues) one histogram is kept per stage:
+ *  - network: robot timestamp → ZMQ receive (robot clock converted with clockOffsetUs)
+ *  - parse:   receive → parse / JPEG decode complete
+ *  - apply:   parse complete → applied on the GUI thread
+ *  - present: GUI apply → next QQuickWindow::frameSwapped
+ *  - total:   robot timestamp → presented
+ *
+ * record() is lock-free and may be called from any thread. Once a second the
+ * interval is folded into the cumulative histograms and @c summary is
+ * refreshed for QML; dumpToFile() writes the cumulative data as JSON.
+ */
+class LatencyMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantMap summary READ summary NOTIFY summaryChanged)
+    Q_PROPERTY(qint64 clockOffsetUs READ clockOffsetUs NOTIFY clockOffsetChanged)
+
+public:
+    enum Stage : uint8_t {
+        NETWORK = 0,
+        PARSE,
+        APPLY,
+        PRESENT,
+        TOTAL,
+        STAGE_COUNT
+    };
+    Q_ENUM(Stage)
+
+    using Stream = Spider2::IngestStream;
+
+    explicit LatencyMonitor(QObject *parent = nullptr);
+    ~LatencyMonitor() override;
+
+    /// @brief Local wall clock in µs since the epoch (the clock all stamps use)
+    static int64_t nowUs();
+    static const char *stageName(Stage stage);
+
+    /// @brief Any thread
+    void record(Stream stream, Stage stage, int64_t us);
+
+    /**
+     * @brief Record network and parse stages for one message
+     * @return Parse-complete time, to be passed on to applied()
+     */
+    int64_t parsed(Stream stream, int64_t robotMs, int64_t receivedUs);
+
+    /// @brief GUI thread: record the apply stage and arm the present stage
+    void applied(Stream stream, int64_t robotMs, int64_t parsedUs);
+
+    /// @brief Robot clock + offset = local clock. Any thread.
+    void setClockOffsetUs(qint64 offsetUs);
+    qint64 clockOffsetUs() const { return m_clockOffsetUs.load(std::memory_order_relaxed); }
+    int64_t robotToLocalUs(int64_t robotMs) const { return robotMs * 1000 + clockOffsetUs(); }
+
+    /// @brief Present stage follows this window's frameSwapped; nullptr = not measured
+    void setWindow(QQuickWindow *window);
+
+    /// @brief Last interval: {stream: {stage: {count, p50_ms, p99_ms, max_ms}}}
+    QVariantMap summary() const { return m_summary; }
+
+    /// @brief Cumulative percentile (0..1) in ms; 0 when nothing was recorded
+    Q_INVOKABLE double percentileMs(const QString &stream, const QString &stage, double quantile) const;
+
+    /// @brief Write cumulative histograms and percentiles to @p path as JSON
+    Q_INVOKABLE bool dumpToFile(const QString &path) const;
+
+    /// @brief Clear interval and cumulative data
+    Q_INVOKABLE void reset();
+
+signals:
+    void summaryChanged();
+    void clockOffsetChanged();
+
+private:
+    static constexpr size_t STREAM_COUNT = static_cast<size_t>(Stream::COUNT);
+
+    struct Pending {
+        int64_t robotMs{0};
+        int64_t appliedUs{0};
+    };
+
+    void onFrameSwapped();   // render thread
+    void updateSummary();
+    bool lookup(const QString &stream, const QString &stage, size_t &streamIndex, size_t &stageIndex) const;
+
+    // [stream][stage]
+    std::unique_ptr<std::array<std::array<Spider2::LatencyHistogram, STAGE_COUNT>, STREAM_COUNT>> m_interval;
+    std::unique_ptr<std::array<std::array<Spider2::LatencyHistogram::Snapshot, STAGE_COUNT>, STREAM_COUNT>> m_cumulative;
+
+    std::atomic<qint64> m_clockOffsetUs{0};
+
+    // Applied but not yet presented, per stream (GUI writes, render thread takes)
+    std::mutex m_pendingMutex;
+    std::array<Pending, STREAM_COUNT> m_pending{};
+
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_swapConnection;
+    QTimer m_summaryTimer;
+    QVariantMap m_summary;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace Spider2 {
+
+/**
+ * @brief Lock-free single-writer / single-reader "latest value" slot
+ *
+ * Triple buffer: the writer fills its private buffer and swaps it with the
+ * shared middle one; the reader swaps the middle one with its own buffer when
+ * it is fresh. Neither side ever waits, and the reader always gets the newest
+ * complete value. Values written in between are overwritten, never queued.
+ *
+ * Writers on different threads are fine as long as they are serialized by
+ * something else (e.g. a mutex they already hold).
+ */
+template <typename T>
+class LatestValue
+{
+public:
+    /// @brief Writer side
+    void publish(T value)
+    {
+        m_buffers[m_writeIndex] = std::move(value);
+        const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_writeIndex | FRESH),
+                                                   std::memory_order_acq_rel);
+        m_writeIndex = previous & INDEX_MASK;
+    }
+
+    /// @brief Reader side. Returns false when nothing was published since the last take.
+    bool take(T &out)
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        const uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+        m_readIndex = previous & INDEX_MASK;
+        // Move out so the buffer stops referencing the value (e.g. receive buffers)
+        out = std::move(m_buffers[m_readIndex]);
+        m_buffers[m_readIndex] = T();
+        return true;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> m_buffers{};
+    uint8_t m_writeIndex{0};                 // writer-private
+    std::atomic<uint8_t> m_middle{1};        // index of the shared buffer | FRESH
+    uint8_t m_readIndex{2};                  // reader-private
+};
+
+} // namespace Spider2
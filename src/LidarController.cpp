@@ -7,11 +7,28 @@ LidarController::LidarController(QObject *parent)
 
 LidarController::~LidarController() {}
 
+void LidarController::setMergeFrames(int frames)
+{
+    m_mergeFrames = qMax(1, frames);
+    while (static_cast<int>(m_frameBuffer.size()) > m_mergeFrames)
+        m_frameBuffer.pop_front();
+}
+
 void LidarController::updateLidarData(const QVector<LidarPoint> &points)
 {
-    // Rolling frame buffer: keep the last MERGE_FRAMES revolutions
+    // Rolling frame buffer: keep the last m_mergeFrames revolutions
     m_frameBuffer.push_back(points);
-    while (static_cast<int>(m_frameBuffer.size()) > MERGE_FRAMES)
+    while (static_cast<int>(m_frameBuffer.size()) > m_mergeFrames)
+        m_frameBuffer.pop_front();
+
+    rebuildPointsXY();
+}
+
+void LidarController::updateLidarFrames(const QList<QVector<LidarPoint>> &frames)
+{
+    for (const auto &points : frames)
+        m_frameBuffer.push_back(points);
+    while (static_cast<int>(m_frameBuffer.size()) > m_mergeFrames)
         m_frameBuffer.pop_front();
 
     rebuildPointsXY();
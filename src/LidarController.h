@@ -18,12 +18,18 @@ public:
     explicit LidarController(QObject *parent = nullptr);
     ~LidarController();
 
+    /// @brief Revolutions blended together (MERGE_FRAMES by default)
+    void setMergeFrames(int frames);
+    int mergeFrames() const { return m_mergeFrames; }
+
     QVariantList pointsXY()   const { return m_pointsXY; }
     int          pointCount() const { return m_pointCount; }
     bool         hasData()    const { return m_pointCount > 0; }
 
 public slots:
     void updateLidarData(const QVector<LidarPoint> &points);
+    /// @brief Several revolutions at once, oldest first, blended with a single rebuild
+    void updateLidarFrames(const QList<QVector<LidarPoint>> &frames);
     void clearData();
 
 signals:
@@ -32,8 +38,9 @@ signals:
     void hasDataChanged();
 
 private:
-    // Rolling buffer of the last MERGE_FRAMES revolutions
+    // Rolling buffer of the last m_mergeFrames revolutions
     std::deque<QVector<LidarPoint>> m_frameBuffer;
+    int m_mergeFrames{MERGE_FRAMES};
 
     QVariantList m_pointsXY;
     int          m_pointCount{0};
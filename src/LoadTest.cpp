@@ -0,0 +1,473 @@
+#include "LoadTest.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSysInfo>
+#include <QThread>
+#include <QVariantMap>
+#include <algorithm>
+#include <cstring>
+#include "IngestPipeline.h"
+#include "LatencyMonitor.h"
+#include "RobotController.h"
+#include "TelemetryStore.h"
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using Spider2::RobotSimulator;
+
+namespace {
+
+constexpr int WARMUP_SECONDS = 2;          // the simulator learns the client from its first heartbeat
+constexpr double GENERATOR_SHORTFALL = 0.9;
+constexpr double QUEUE_BACKLOG_FILL = 0.5;
+
+/// @brief tid → (thread name, user + system clock ticks); empty where /proc is missing
+std::map<int, std::pair<QString, uint64_t>> threadTicks()
+{
+    std::map<int, std::pair<QString, uint64_t>> threads;
+#if defined(Q_OS_LINUX)
+    const QStringList tids = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &tid : tids) {
+        QFile file(QString("/proc/self/task/%1/stat").arg(tid));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;   // exited meanwhile
+        // "tid (name) state ...": the name may contain spaces, so fields resume after the last ')'
+        const QByteArray stat = file.readAll();
+        const qsizetype open = stat.indexOf('(');
+        const qsizetype close = stat.lastIndexOf(')');
+        if (open < 0 || close < open)
+            continue;
+        const QList<QByteArray> fields = stat.mid(close + 2).split(' ');
+        if (fields.size() < 13)
+            continue;
+        // fields[0] is stat field 3 (state); utime and stime are fields 14 and 15
+        threads[tid.toInt()] = {QString::fromUtf8(stat.mid(open + 1, close - open - 1)),
+                                fields[11].toULongLong() + fields[12].toULongLong()};
+    }
+#endif
+    return threads;
+}
+
+double ticksPerSecond()
+{
+#if defined(Q_OS_UNIX)
+    return static_cast<double>(sysconf(_SC_CLK_TCK));
+#else
+    return 100.0;
+#endif
+}
+
+/// @brief A "VmRSS:"-style line of /proc/self/status in MB; 0 elsewhere
+double statusMb(const char *key)
+{
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return 0.0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.startsWith(key))
+            return line.mid(static_cast<qsizetype>(strlen(key))).trimmed().split(' ').value(0).toDouble() / 1024.0;
+    }
+#else
+    Q_UNUSED(key);
+#endif
+    return 0.0;
+}
+
+double peakRssMb()
+{
+#if defined(Q_OS_LINUX)
+    return statusMb("VmHWM:");
+#elif defined(Q_OS_UNIX)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / (1024.0 * 1024.0);   // bytes outside Linux
+#else
+    return 0.0;
+#endif
+}
+
+double ratio(uint64_t part, uint64_t whole)
+{
+    return whole > 0 ? static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+} // namespace
+
+LoadTest::LoadTest(RobotController *controller, const Config &config, QObject *parent)
+    : QObject(parent)
+    , m_controller(controller)
+    , m_config(config)
+{
+    if (m_config.streams.empty()) {
+        for (size_t i = 0; i < static_cast<size_t>(Stream::COUNT); ++i)
+            m_config.streams.push_back(static_cast<Stream>(i));
+    }
+    m_config.settleSeconds = std::max(1, m_config.settleSeconds);
+    m_config.stepSeconds = std::max(1, m_config.stepSeconds);
+    m_config.factor = std::max(1.05, m_config.factor);
+
+    m_timer.setInterval(1000);
+    connect(&m_timer, &QTimer::timeout, this, &LoadTest::tick);
+}
+
+LoadTest::~LoadTest()
+{
+    if (m_simulator)
+        m_simulator->stop();
+}
+
+bool LoadTest::start()
+{
+    RobotSimulator::Config simulator = m_config.simulator;
+    for (size_t i = 0; i < simulator.rates.size(); ++i)
+        simulator.rates[i] = backgroundRate(static_cast<Stream>(i));
+
+    // inproc:// only reaches sockets of the same context: the simulator has to bind in the controller's
+    const bool inproc = simulator.endpoint.rfind("inproc://", 0) == 0;
+    if (inproc && !m_config.context) {
+        qCritical() << "[LOAD]" << simulator.endpoint.c_str() << "needs the controller's ZeroMQ context";
+        return false;
+    }
+
+    // Whatever the simulator's start adds to the process is the generator's, not the client's
+    const auto threadsBefore = threadTicks();
+    const double rssBeforeMb = statusMb("VmRSS:");
+    m_context = inproc ? m_config.context : std::make_shared<zmq::context_t>(1);
+    m_simulator = std::make_unique<RobotSimulator>();
+    if (!m_simulator->start(*m_context, simulator)) {
+        m_simulator.reset();
+        return false;
+    }
+    m_generatorThreads.clear();
+    for (const auto &[tid, thread] : threadTicks()) {
+        if (!threadsBefore.count(tid) || thread.first == QLatin1String("s2-sim"))
+            m_generatorThreads.insert(tid);
+    }
+    m_generatorRssMb = std::max(0.0, statusMb("VmRSS:") - rssBeforeMb);
+
+    // A wildcard bind address is not something to connect to
+    QString endpoint = QString::fromStdString(simulator.endpoint);
+    endpoint.replace("://*:", "://127.0.0.1:");
+    m_controller->setRememberServers(false);
+    m_controller->setServerIp(endpoint);
+    m_controller->connectToRobot();
+    if (!m_controller->connected()) {
+        m_simulator->stop();
+        m_simulator.reset();
+        return false;
+    }
+
+    m_report = QJsonObject();
+    m_report["endpoint"] = endpoint;
+    m_report["machine"] = QSysInfo::prettyProductName();
+    m_report["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+    m_report["ideal_thread_count"] = QThread::idealThreadCount();
+    m_report["isolated"] = m_config.isolate;
+    m_report["max_drop_ratio"] = m_config.maxDropRatio;
+    m_report["max_lag_ms"] = m_config.maxLagMs;
+    m_report["generator_rss_mb"] = m_generatorRssMb;
+
+    qInfo().noquote() << "[LOAD] Connected to" << endpoint << "- ramping" << m_config.streams.size() << "stream(s)";
+    m_clock.start();
+    m_phase = Phase::WARMUP;
+    m_secondsLeft = WARMUP_SECONDS;
+    m_timer.start();
+    return true;
+}
+
+void LoadTest::tick()
+{
+    if (!m_controller->connected()) {
+        qWarning() << "[LOAD] Client disconnected, aborting";
+        finishTest(1);
+        return;
+    }
+
+    if (m_phase == Phase::MEASURE)
+        sampleWindow();
+    if (--m_secondsLeft > 0)
+        return;
+
+    switch (m_phase) {
+    case Phase::WARMUP:
+        beginStream();
+        break;
+    case Phase::SETTLE:
+        m_phase = Phase::MEASURE;
+        m_secondsLeft = m_config.stepSeconds;
+        m_windowStart = snapshot();
+        m_windowLagMs = 0.0;
+        m_windowQueueFill = 0.0;
+        m_windowDecoded = 0;
+        m_windowDecodeDropped = 0;
+        break;
+    case Phase::MEASURE:
+        evaluateStep();
+        break;
+    }
+}
+
+void LoadTest::beginStream()
+{
+    if (m_streamIndex >= m_config.streams.size()) {
+        finishTest(0);
+        return;
+    }
+    const Stream stream = m_config.streams[m_streamIndex];
+    m_rate = std::max(m_config.simulator.rates[static_cast<size_t>(stream)],
+                      m_config.minStartRate / messagesPerRateUnit(stream));
+    m_lastPass = QJsonObject();
+    m_steps = QJsonArray();
+    beginStep();
+}
+
+void LoadTest::beginStep()
+{
+    m_simulator->setRate(m_config.streams[m_streamIndex], m_rate);
+    m_phase = Phase::SETTLE;
+    m_secondsLeft = m_config.settleSeconds;
+}
+
+void LoadTest::sampleWindow()
+{
+    const QString name = ingestName(m_config.streams[m_streamIndex]);
+    TelemetryStore *telemetry = m_controller->telemetryData();
+
+    // Robot stamp → applied on the GUI thread, as the sum of the stage p99s (errs on the high side)
+    const QVariantMap stages = m_controller->latencyMonitor()->summary().value(name).toMap();
+    double lag = 0.0;
+    for (LatencyMonitor::Stage stage : {LatencyMonitor::NETWORK, LatencyMonitor::PARSE, LatencyMonitor::APPLY})
+        lag += stages.value(QLatin1String(LatencyMonitor::stageName(stage))).toMap().value("p99_ms").toDouble();
+    m_windowLagMs = std::max(m_windowLagMs, lag);
+
+    // Keep-latest queues never back up, they drop (counted in the window delta)
+    const QVariantMap queue = telemetry->value("ingest_queues").toMap().value(name).toMap();
+    const double capacity = queue.value("capacity").toDouble();
+    if (queue.value("policy").toString() == QLatin1String("keep_all") && capacity > 0.0)
+        m_windowQueueFill = std::max(m_windowQueueFill, queue.value("depth").toDouble() / capacity);
+
+    // Per-second counters of the decoder; only their ratio is used, so the tick phase does not matter
+    if (m_config.streams[m_streamIndex] == Stream::VIDEO) {
+        const QVariantMap decode = telemetry->value("video_decode").toMap();
+        m_windowDecoded += decode.value("decoded_per_sec").toULongLong();
+        m_windowDecodeDropped += decode.value("overrun_dropped_per_sec").toULongLong()
+                               + decode.value("stale_dropped_per_sec").toULongLong();
+    }
+}
+
+void LoadTest::evaluateStep()
+{
+    const Stream stream = m_config.streams[m_streamIndex];
+    const size_t index = static_cast<size_t>(stream);
+    const Snapshot end = snapshot();
+    const double seconds = std::max(1, static_cast<int>(end.elapsedMs - m_windowStart.elapsedMs)) / 1000.0;
+
+    const RobotSimulator::StreamStats &before = m_windowStart.simulator.streams[index];
+    const RobotSimulator::StreamStats &after = end.simulator.streams[index];
+    const uint64_t sent = after.sent - before.sent;
+    const uint64_t socketDropped = after.dropped - before.dropped;
+    const double bytes = static_cast<double>(after.bytes - before.bytes);
+    const uint64_t delivered = end.delivered - m_windowStart.delivered;
+    const uint64_t ingestDropped = end.dropped - m_windowStart.dropped;
+    const double ingestDropRatio = ratio(ingestDropped, delivered + ingestDropped);
+    const double decodeDropRatio = ratio(m_windowDecodeDropped, m_windowDecoded + m_windowDecodeDropped);
+
+    // CPU per client thread over the window, busiest first
+    const double tickSeconds = ticksPerSecond() * seconds;
+    double processCpu = 0.0;
+    double generatorCpu = 0.0;
+    std::vector<std::pair<double, QJsonObject>> threads;
+    for (const auto &[tid, thread] : end.threadTicks) {
+        const auto previous = m_windowStart.threadTicks.find(tid);
+        const uint64_t startTicks = previous != m_windowStart.threadTicks.end() ? previous->second.second : 0;
+        const double percent = 100.0 * static_cast<double>(thread.second - startTicks) / tickSeconds;
+        if (m_generatorThreads.count(tid)) {
+            generatorCpu += percent;
+            continue;
+        }
+        processCpu += percent;
+        if (percent < 0.5)
+            continue;
+        QJsonObject entry;
+        entry["thread"] = thread.first;
+        entry["tid"] = tid;
+        entry["cpu_percent"] = qRound(percent * 10.0) / 10.0;
+        threads.emplace_back(percent, entry);
+    }
+    std::sort(threads.begin(), threads.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    QJsonArray threadArray;
+    for (const auto &thread : threads)
+        threadArray.append(thread.second);
+
+    QString failure;
+    if (socketDropped > 0)
+        failure = "socket_backlog";
+    else if (ingestDropRatio > m_config.maxDropRatio)
+        failure = "ingest_drops";
+    else if (decodeDropRatio > m_config.maxDropRatio)
+        failure = "decode_drops";
+    else if (m_windowQueueFill > QUEUE_BACKLOG_FILL)
+        failure = "queue_backlog";
+    else if (m_windowLagMs > m_config.maxLagMs)
+        failure = "latency";
+
+    const double targetRate = m_rate * messagesPerRateUnit(stream);
+    QJsonObject step;
+    step["target_msgs_per_sec"] = targetRate;
+    step["msgs_per_sec"] = sent / seconds;
+    step["mb_per_sec"] = bytes / seconds / (1024.0 * 1024.0);
+    step["socket_dropped"] = static_cast<qint64>(socketDropped);
+    step["ingest_drop_ratio"] = ingestDropRatio;
+    if (stream == Stream::VIDEO)
+        step["decode_drop_ratio"] = decodeDropRatio;
+    step["queue_fill"] = m_windowQueueFill;
+    step["lag_p99_ms"] = m_windowLagMs;
+    step["process_cpu_percent"] = qRound(processCpu * 10.0) / 10.0;
+    step["generator_cpu_percent"] = qRound(generatorCpu * 10.0) / 10.0;
+    step["threads"] = threadArray;
+    step["rss_mb"] = clientRssMb(statusMb("VmRSS:"));
+    step["result"] = failure.isEmpty() ? QStringLiteral("ok") : failure;
+    m_steps.append(step);
+
+    qInfo().noquote() << QString("[LOAD] %1 %2 msg/s: %3 (sent %4/s, %5 MB/s, ingest drops %6%, lag p99 %7 ms, cpu %8%)")
+                             .arg(ingestName(stream)).arg(targetRate, 0, 'f', 1)
+                             .arg(failure.isEmpty() ? QStringLiteral("ok") : failure)
+                             .arg(sent / seconds, 0, 'f', 1).arg(step["mb_per_sec"].toDouble(), 0, 'f', 2)
+                             .arg(ingestDropRatio * 100.0, 0, 'f', 2).arg(m_windowLagMs, 0, 'f', 1)
+                             .arg(processCpu, 0, 'f', 0);
+
+    if (!failure.isEmpty()) {
+        finishStream(failure, sent / seconds);
+        return;
+    }
+    m_lastPass = step;
+    if (static_cast<double>(sent + socketDropped) < GENERATOR_SHORTFALL * targetRate * seconds) {
+        finishStream("generator", 0.0);
+    } else if (targetRate * m_config.factor > m_config.maxRate) {
+        finishStream("max_rate", 0.0);
+    } else {
+        m_rate *= m_config.factor;
+        beginStep();
+    }
+}
+
+void LoadTest::finishStream(const QString &limitedBy, double failedAtRate)
+{
+    const Stream stream = m_config.streams[m_streamIndex];
+
+    QJsonObject result;
+    result["stream"] = ingestName(stream);
+    result["sustainable_msgs_per_sec"] = m_lastPass.value("msgs_per_sec").toDouble();
+    result["sustainable_mb_per_sec"] = m_lastPass.value("mb_per_sec").toDouble();
+    result["limited_by"] = limitedBy;
+    if (failedAtRate > 0.0)
+        result["failed_at_msgs_per_sec"] = failedAtRate;
+    result["process_cpu_percent"] = m_lastPass.value("process_cpu_percent");
+    result["generator_cpu_percent"] = m_lastPass.value("generator_cpu_percent");
+    result["threads"] = m_lastPass.value("threads");
+    result["rss_mb"] = m_lastPass.value("rss_mb");
+    result["steps"] = m_steps;
+    m_streams.append(result);
+    m_report["streams"] = m_streams;
+    m_report["peak_rss_mb"] = clientRssMb(peakRssMb());
+
+    // Back to its background rate; let any backlog drain before the next stream
+    m_simulator->setRate(stream, backgroundRate(stream));
+    ++m_streamIndex;
+    m_phase = Phase::WARMUP;
+    m_secondsLeft = 2 * m_config.settleSeconds;
+}
+
+void LoadTest::finishTest(int exitCode)
+{
+    m_timer.stop();
+    m_controller->disconnectFromRobot();
+    if (m_simulator) {
+        m_simulator->stop();
+        m_simulator.reset();
+    }
+    m_report["streams"] = m_streams;
+    m_report["peak_rss_mb"] = clientRssMb(peakRssMb());
+    m_report["duration_s"] = m_clock.elapsed() / 1000.0;
+    emit finished(exitCode);
+}
+
+LoadTest::Snapshot LoadTest::snapshot() const
+{
+    Snapshot s;
+    s.simulator = m_simulator->stats();
+    const QVariantMap queue = m_controller->telemetryData()->value("ingest_queues").toMap()
+                                  .value(ingestName(m_config.streams[m_streamIndex])).toMap();
+    s.delivered = queue.value("delivered").toULongLong();
+    s.dropped = queue.value("dropped").toULongLong();
+    s.threadTicks = threadTicks();
+    s.elapsedMs = m_clock.elapsed();
+    return s;
+}
+
+double LoadTest::backgroundRate(Stream stream) const
+{
+    return m_config.isolate ? 0.0 : m_config.simulator.rates[static_cast<size_t>(stream)];
+}
+
+double LoadTest::messagesPerRateUnit(Stream stream) const
+{
+    return stream == Stream::TELEMETRY ? std::max(1, m_config.simulator.telemetryMetrics) : 1.0;
+}
+
+double LoadTest::clientRssMb(double processRssMb) const
+{
+    return processRssMb > 0.0 ? std::max(0.0, processRssMb - m_generatorRssMb) : 0.0;
+}
+
+QString LoadTest::ingestName(Stream stream)
+{
+    Spider2::IngestStream ingest = Spider2::IngestStream::CONTROL;
+    switch (stream) {
+    case Stream::LIDAR:     ingest = Spider2::IngestStream::LIDAR; break;
+    case Stream::GYRO:      ingest = Spider2::IngestStream::GYRO; break;
+    case Stream::VIDEO:     ingest = Spider2::IngestStream::VIDEO; break;
+    case Stream::SLAM_POSE: ingest = Spider2::IngestStream::SLAM_POSE; break;
+    case Stream::SLAM_MAP:  ingest = Spider2::IngestStream::SLAM_MAP; break;
+    case Stream::TELEMETRY: ingest = Spider2::IngestStream::TELEMETRY; break;
+    default: break;
+    }
+    return QString::fromLatin1(Spider2::IngestPipeline::streamName(ingest));
+}
+
+QStringList LoadTest::summary() const
+{
+    QStringList lines;
+    lines << QString("%1 %2 %3  %4").arg("stream", -10).arg("msg/s", 12).arg("MB/s", 9).arg("limited by");
+    for (const QJsonValue &value : m_streams) {
+        const QJsonObject stream = value.toObject();
+        QString limit = stream["limited_by"].toString();
+        if (stream.contains("failed_at_msgs_per_sec"))
+            limit += QString(" at %1 msg/s").arg(stream["failed_at_msgs_per_sec"].toDouble(), 0, 'f', 1);
+        lines << QString("%1 %2 %3  %4").arg(stream["stream"].toString(), -10)
+                     .arg(stream["sustainable_msgs_per_sec"].toDouble(), 12, 'f', 1)
+                     .arg(stream["sustainable_mb_per_sec"].toDouble(), 9, 'f', 2)
+                     .arg(limit);
+
+        // The busiest threads at the sustainable rate
+        QStringList busiest;
+        const QJsonArray threads = stream["threads"].toArray();
+        for (qsizetype i = 0; i < std::min<qsizetype>(threads.size(), 4); ++i) {
+            const QJsonObject thread = threads[i].toObject();
+            busiest << QString("%1 %2%").arg(thread["thread"].toString()).arg(thread["cpu_percent"].toDouble(), 0, 'f', 0);
+        }
+        if (!busiest.isEmpty())
+            lines << QString("%1 cpu %2% total: %3").arg("", -10)
+                         .arg(stream["process_cpu_percent"].toDouble(), 0, 'f', 0).arg(busiest.join(", "));
+    }
+    if (m_report.value("peak_rss_mb").toDouble() > 0.0)
+        lines << QString("peak RSS %1 MB (simulator's %2 MB excluded)")
+                     .arg(m_report.value("peak_rss_mb").toDouble(), 0, 'f', 1)
+                     .arg(m_report.value("generator_rss_mb").toDouble(), 0, 'f', 1);
+    return lines;
+}
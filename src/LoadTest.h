@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include <zmq.hpp>
+#include "RobotSimulator.h"
+
+class RobotController;
+
+/**
+ * @brief Headless capacity test: ramps each robot stream until the client falls behind
+ *
+ * Hosts a RobotSimulator in a ZeroMQ context of its own, so the transport is
+ * part of the measurement, and connects the given RobotController to it. An
+ * inproc:// endpoint is bound in Config::context instead, the context the
+ * controller was constructed with, which leaves only the client's own cost.
+ * Streams are ramped one at a time while the others keep their usual rates:
+ * every step multiplies the rate by Config::factor, lets the pipeline settle,
+ * then measures for Config::stepSeconds. A step fails when
+ *  - the simulator's send queue to the client overflowed (receive thread behind),
+ *  - the stream's ingest queue dropped more than maxDropRatio of its frames,
+ *  - for video, the decoders dropped more than maxDropRatio of the frames,
+ *  - a keep-all ingest queue stayed over half full, or
+ *  - robot stamp → GUI apply (network + parse + apply p99) exceeded maxLagMs.
+ *
+ * The last passing step is the stream's sustainable rate. When the simulator
+ * cannot produce the requested rate the stream is reported as generator-bound
+ * rather than client-bound. CPU time per thread (Linux) and resident memory
+ * are sampled for every step. The simulator shares the process, so its
+ * threads (the ones its start created) are left out of the client's CPU and
+ * reported as the generator's, and the resident memory its start took
+ * (prepared payloads, its ZeroMQ context) is subtracted from the client's.
+ *
+ * Rates are in messages per second throughout; a telemetry burst counts as
+ * telemetryMetrics messages.
+ */
+class LoadTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Stream = Spider2::RobotSimulator::Stream;
+
+    struct Config {
+        Spider2::RobotSimulator::Config simulator;   ///< Endpoint, payload shapes and background rates
+        std::shared_ptr<zmq::context_t> context;     ///< The controller's context; required for inproc://
+        std::vector<Stream> streams;                 ///< Ramped in this order; empty = all
+        bool isolate{false};                         ///< Other streams off while one is ramped
+        double factor{1.5};                          ///< Rate multiplier per step
+        double minStartRate{5.0};                    ///< First step: max(background rate, this) messages/s
+        double maxRate{100000.0};                    ///< Messages/s
+        int settleSeconds{1};
+        int stepSeconds{3};
+        double maxDropRatio{0.01};
+        double maxLagMs{100.0};
+    };
+
+    LoadTest(RobotController *controller, const Config &config, QObject *parent = nullptr);
+    ~LoadTest() override;
+
+    /// @brief Start the simulator and connect; false if either fails
+    bool start();
+
+    /// @brief {streams: [{stream, sustainable_msgs_per_sec, limited_by, threads, ...}], peak_rss_mb, ...}
+    QJsonObject report() const { return m_report; }
+
+    /// @brief Human-readable summary of report(), one line per entry
+    QStringList summary() const;
+
+signals:
+    /// @brief Every stream has been ramped; @p exitCode is 0 unless the client disconnected
+    void finished(int exitCode);
+
+private:
+    enum class Phase { WARMUP, SETTLE, MEASURE };
+
+    struct Snapshot {
+        Spider2::RobotSimulator::Stats simulator;
+        uint64_t delivered{0};               ///< Ingest queue of the ramped stream
+        uint64_t dropped{0};
+        std::map<int, std::pair<QString, uint64_t>> threadTicks;   ///< tid → (name, user + system ticks)
+        qint64 elapsedMs{0};
+    };
+
+    void tick();
+    void beginStream();
+    void beginStep();
+    void evaluateStep();
+    void finishStream(const QString &limitedBy, double failedAtRate);
+    void finishTest(int exitCode);
+    void sampleWindow();
+    Snapshot snapshot() const;
+    double backgroundRate(Stream stream) const;
+    /// @brief Messages per unit of RobotSimulator::setRate(): the burst size for telemetry, else 1
+    double messagesPerRateUnit(Stream stream) const;
+    double clientRssMb(double processRssMb) const;
+    static QString ingestName(Stream stream);
+
+    RobotController *m_controller;
+    Config m_config;
+    std::shared_ptr<zmq::context_t> m_context;
+    std::unique_ptr<Spider2::RobotSimulator> m_simulator;
+
+    QTimer m_timer;                  // 1 s ticks drive the phases
+    QElapsedTimer m_clock;
+    Phase m_phase{Phase::WARMUP};
+    int m_secondsLeft{0};
+    size_t m_streamIndex{0};
+    double m_rate{0.0};              // in RobotSimulator::setRate() units
+    std::set<int> m_generatorThreads;  // tids the simulator started
+    double m_generatorRssMb{0.0};      // resident memory the simulator's start took
+
+    // Current measurement window
+    Snapshot m_windowStart;
+    double m_windowLagMs{0.0};
+    double m_windowQueueFill{0.0};  // highest depth / capacity seen
+    uint64_t m_windowDecoded{0};
+    uint64_t m_windowDecodeDropped{0};
+
+    QJsonObject m_lastPass;          // best step of the current stream
+    QJsonArray m_steps;              // every step of the current stream
+    QJsonArray m_streams;
+    QJsonObject m_report;
+};
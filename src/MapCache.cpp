@@ -0,0 +1,220 @@
+#include "MapCache.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+#include "ThreadName.h"
+
+namespace Spider2 {
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'S', 'P', '2', 'M', 'A', 'P', '\0', '\0'};
+constexpr uint32_t VERSION = 1;
+// A live SLAM_MAP brings all sizePixels² cells in one message, which keeps real maps far below
+// this; anything larger is a corrupt header and would overflow the tile arithmetic
+constexpr int32_t MAX_SIZE_PIXELS = 32768;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tileSize;      ///< MAP_TILE_SIZE the chunks were written with
+    int64_t savedUs;        ///< Local wall clock, µs since the epoch
+    double sizeMeters;
+    int32_t sizePixels;
+    uint32_t tileCount;
+    uint32_t poseCount;
+    uint32_t reserved;
+};
+
+struct TileEntry {
+    int32_t level;
+    int32_t column;
+    int32_t row;
+    uint32_t reserved;
+};
+
+struct PoseRecord {
+    double x_mm;
+    double y_mm;
+    double theta_deg;
+};
+
+static_assert(sizeof(FileHeader) == 48, "FileHeader layout");
+static_assert(sizeof(TileEntry) == 16, "TileEntry layout");
+static_assert(sizeof(PoseRecord) == 24, "PoseRecord layout");
+static_assert(sizeof(MapChunk) == MAP_TILE_SIZE * MAP_TILE_SIZE, "MapChunk is written as raw cells");
+
+} // namespace
+
+MapCache::MapCache(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+MapCache::~MapCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_pendingAvailable.notify_all();
+    if (m_writer.joinable())
+        m_writer.join();
+}
+
+QString MapCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/maps";
+}
+
+QString MapCache::pathFor(const QString &server) const
+{
+    // "tcp://10.0.0.5:5555" → "tcp___10.0.0.5_5555.s2map"
+    static const QRegularExpression unsafe("[^A-Za-z0-9._-]");
+    return m_directory + "/" + QString(server).replace(unsafe, "_") + ".s2map";
+}
+
+bool MapCache::load(const QString &server, Snapshot &snapshot) const
+{
+    QFile file(pathFor(server));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 fileSize = file.size();
+    if (fileSize < static_cast<qint64>(sizeof(FileHeader)))
+        return false;
+    const uchar *data = file.map(0, fileSize);
+    if (!data) {
+        qWarning() << "[MAP] Cannot map" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const uint64_t expected = sizeof(FileHeader) + uint64_t(header.tileCount) * sizeof(TileEntry)
+                              + uint64_t(header.poseCount) * sizeof(PoseRecord)
+                              + uint64_t(header.tileCount) * sizeof(MapChunk);
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != VERSION
+        || header.tileSize != static_cast<uint32_t>(MAP_TILE_SIZE)
+        || header.sizePixels <= 0 || header.sizePixels > MAX_SIZE_PIXELS
+        || expected != static_cast<uint64_t>(fileSize)) {
+        qWarning() << "[MAP] Ignoring" << file.fileName() << ": not a readable map cache";
+        return false;
+    }
+
+    const int levels = mapLevelCount(header.sizePixels);
+    const uchar *entries = data + sizeof(FileHeader);
+    const uchar *poses = entries + size_t(header.tileCount) * sizeof(TileEntry);
+    const uchar *chunks = poses + size_t(header.poseCount) * sizeof(PoseRecord);
+
+    MapTileUpdate map;
+    map.sizePixels = header.sizePixels;
+    map.sizeMeters = header.sizeMeters;
+    map.reset = true;
+    map.tiles.reserve(header.tileCount);
+    for (uint32_t i = 0; i < header.tileCount; ++i) {
+        TileEntry entry;
+        std::memcpy(&entry, entries + size_t(i) * sizeof(TileEntry), sizeof(entry));
+        const int columns = entry.level >= 0 && entry.level < levels
+            ? mapTileColumns(mapLevelSize(header.sizePixels, entry.level)) : 0;
+        if (entry.column < 0 || entry.row < 0 || entry.column >= columns || entry.row >= columns) {
+            qWarning() << "[MAP] Ignoring" << file.fileName() << ": tile out of range";
+            return false;
+        }
+        // Copied out of the mapping: the file may be replaced while the chunk is still shown
+        auto chunk = std::make_shared<MapChunk>();
+        std::memcpy(chunk->cells.data(), chunks + size_t(i) * sizeof(MapChunk), sizeof(MapChunk));
+        map.tiles.push_back(MapTile{entry.column, entry.row, entry.level, std::move(chunk)});
+    }
+
+    std::vector<Pose> trail(header.poseCount);
+    for (uint32_t i = 0; i < header.poseCount; ++i) {
+        PoseRecord record;
+        std::memcpy(&record, poses + size_t(i) * sizeof(PoseRecord), sizeof(record));
+        trail[i] = Pose{record.x_mm, record.y_mm, record.theta_deg};
+    }
+
+    snapshot.map = std::move(map);
+    snapshot.trail = std::move(trail);
+    return true;
+}
+
+void MapCache::save(const QString &server, Snapshot snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending[pathFor(server)] = std::move(snapshot);
+        if (!m_writer.joinable()) {
+            m_running = true;
+            m_writer = std::thread([this]() {
+                setCurrentThreadName("s2-mapcache");
+                writerLoop();
+            });
+        }
+    }
+    m_pendingAvailable.notify_one();
+}
+
+void MapCache::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_pendingAvailable.wait(lock, [this]() { return !m_pending.empty() || !m_running; });
+        if (m_pending.empty())
+            return;   // stopped, and everything queued is on disk
+        auto pending = m_pending.extract(m_pending.begin());
+        lock.unlock();
+        write(pending.key(), pending.mapped());
+        lock.lock();
+    }
+}
+
+bool MapCache::write(const QString &path, const Snapshot &snapshot)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[MAP] Cannot write" << path << ":" << file.errorString();
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = VERSION;
+    header.tileSize = MAP_TILE_SIZE;
+    header.savedUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    header.sizeMeters = snapshot.map.sizeMeters;
+    header.sizePixels = snapshot.map.sizePixels;
+    header.poseCount = static_cast<uint32_t>(snapshot.trail.size());
+    for (const MapTile &tile : snapshot.map.tiles)
+        header.tileCount += tile.chunk ? 1 : 0;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for (const MapTile &tile : snapshot.map.tiles) {
+        if (!tile.chunk)
+            continue;
+        const TileEntry entry{tile.level, tile.column, tile.row, 0};
+        file.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    }
+    for (const Pose &pose : snapshot.trail) {
+        const PoseRecord record{pose.x_mm, pose.y_mm, pose.theta_deg};
+        file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    for (const MapTile &tile : snapshot.map.tiles) {
+        if (tile.chunk)
+            file.write(reinterpret_cast<const char *>(tile.chunk->cells.data()), sizeof(MapChunk));
+    }
+
+    if (!file.commit()) {
+        qWarning() << "[MAP] Cannot write" << path << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace Spider2
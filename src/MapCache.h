@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QString>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MapTiles.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Last SLAM map and pose trail of each robot, kept on disk (.s2map)
+ *
+ * One file per server address, so the map of the robot being connected to
+ * can be shown straight away instead of waiting seconds for its next
+ * SLAM_MAP. Files hold every stored chunk of every pyramid level as-is,
+ * laid out to be read through a memory mapping:
+ *
+ *   FileHeader
+ *   TileEntry[tileCount]                   level, column, row of each chunk
+ *   PoseRecord[poseCount]                  oldest first
+ *   MapChunk[tileCount]                    MAP_TILE_SIZE² cells each
+ *
+ * Restoring is a validation pass plus one copy per chunk; nothing is
+ * recomputed. Saves run on a writer thread and replace the file atomically,
+ * so a crash leaves the previous map intact. Like SessionFormat, fields are
+ * little-endian and structs are written as-is.
+ */
+class MapCache
+{
+public:
+    struct Pose {
+        double x_mm{0.0};
+        double y_mm{0.0};
+        double theta_deg{0.0};
+    };
+
+    struct Snapshot {
+        MapTileUpdate map;          ///< A reset update holding every stored tile of every level
+        std::vector<Pose> trail;    ///< Pose trail, oldest first; the last one is the last known pose (with heading)
+    };
+
+    /// @param directory Created on the first save
+    explicit MapCache(const QString &directory);
+    /// @brief Finishes the saves still queued
+    ~MapCache();
+
+    MapCache(const MapCache &) = delete;
+    MapCache &operator=(const MapCache &) = delete;
+
+    /// @brief AppDataLocation/maps
+    static QString defaultDirectory();
+
+    QString pathFor(const QString &server) const;
+
+    /// @brief Read the cached map of @p server. False when there is none or it is unreadable.
+    bool load(const QString &server, Snapshot &snapshot) const;
+
+    /// @brief Queue @p snapshot to be written for @p server. Never blocks on the disk.
+    void save(const QString &server, Snapshot snapshot);
+
+private:
+    void writerLoop();
+    static bool write(const QString &path, const Snapshot &snapshot);
+
+    QString m_directory;
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_pendingAvailable;
+    std::map<QString, Snapshot> m_pending;   // by path; a newer snapshot replaces one not yet written
+    bool m_running{false};
+};
+
+} // namespace Spider2
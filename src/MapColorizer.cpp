@@ -0,0 +1,490 @@
+#include "MapColorizer.h"
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include "ThreadName.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPIDER2_MAP_SSE2 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPIDER2_MAP_AVX2 1
+#endif
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#include <arm_neon.h>
+#define SPIDER2_MAP_NEON 1
+#endif
+
+namespace {
+
+/**
+ * BreezySLAM stores 0 = obstacle, 255 = free. With v = 255 − cell, free (v 0)
+ * is green, unknown (v 127) yellow and occupied (v 255) red:
+ *   v < 128: r = 255·v / 127, g = 255
+ *   else:    r = 255,         g = 255·(255 − v) / 127
+ * 255·n / 127 = 2n + [n == 127] for n ≤ 127, so in terms of the cell
+ *   r = sat(2·(255 − cell)) + [cell == 128]
+ *   g = sat(2·cell) + [cell == 127]
+ * which is what the vector paths compute, 16 or 32 cells at a time.
+ */
+std::array<QRgb, 256> buildColorTable()
+{
+    std::array<QRgb, 256> table{};
+    for (int cell = 0; cell < 256; ++cell) {
+        const int v = 255 - cell;
+        const int r = v < 128 ? (255 * v) / 127 : 255;
+        const int g = v < 128 ? 255 : (255 * (255 - v)) / 127;
+        table[static_cast<size_t>(cell)] = qRgb(r, g, 0);
+    }
+    return table;
+}
+
+const std::array<QRgb, 256> &colorTable()
+{
+    static const std::array<QRgb, 256> table = buildColorTable();
+    return table;
+}
+
+} // namespace
+
+MapColorizer::MapColorizer(MapCallback callback, int helperCount)
+    : m_callback(std::move(callback))
+{
+    if (helperCount < 0) {
+        // Diffing and filling a 4096² map is mostly memory bandwidth: a few cores saturate it
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        helperCount = static_cast<int>(std::clamp(cores, 1u, 4u)) - 1;
+    }
+    m_helperCount = helperCount;
+}
+
+MapColorizer::~MapColorizer()
+{
+    stop();
+}
+
+void MapColorizer::start()
+{
+    if (m_running.exchange(true)) return;
+    for (int i = 0; i < m_helperCount; ++i) {
+        m_helpers.emplace_back([this, i]() {
+            Spider2::setCurrentThreadName("s2-map-" + std::to_string(i + 1));
+            helperLoop();
+        });
+    }
+    m_thread = std::thread([this]() {
+        Spider2::setCurrentThreadName("s2-map-0");
+        colorizeLoop();
+    });
+}
+
+void MapColorizer::stop()
+{
+    if (!m_running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_pending.reset();
+    }
+    m_jobAvailable.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+
+    {
+        // Pairs with the helpers' wait: none can miss m_running going false
+        std::lock_guard<std::mutex> lock(m_workMutex);
+    }
+    m_workAvailable.notify_all();
+    for (auto &t : m_helpers) {
+        if (t.joinable()) t.join();
+    }
+    m_helpers.clear();
+}
+
+void MapColorizer::submit(const Spider2::RawFrame &frame, const uint8_t *cells, int sizePixels, double sizeMeters,
+                          qint64 timestamp)
+{
+    Job job;
+    job.frame = frame;
+    job.cells = cells;
+    if (!frame.owner) {
+        // Nothing keeps the bytes alive once the caller returns
+        const size_t count = static_cast<size_t>(sizePixels) * static_cast<size_t>(sizePixels);
+        auto copy = std::make_shared<std::string>(reinterpret_cast<const char *>(cells), count);
+        job.cells = reinterpret_cast<const uint8_t *>(copy->data());
+        job.frame.owner = std::move(copy);
+    }
+    job.sizePixels = sizePixels;
+    job.sizeMeters = sizeMeters;
+    job.timestamp = timestamp;
+    job.receivedUs = frame.receivedUs;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_pending)
+            m_overrunDropped.fetch_add(1, std::memory_order_relaxed);
+        m_pending = std::move(job);
+    }
+    m_jobAvailable.notify_one();
+}
+
+void MapColorizer::colorizeLoop()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobAvailable.wait(lock, [this]() { return m_pending.has_value() || !m_running; });
+            if (!m_running) return;
+            job = std::move(*m_pending);
+            m_pending.reset();
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        Spider2::MapTileUpdate update = diffMap(job.cells, job.sizePixels, job.sizeMeters);
+        job.frame = Spider2::RawFrame();   // release the receive buffer before handing the tiles on
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        m_colorizeTime.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        m_colorized.fetch_add(1, std::memory_order_relaxed);
+        m_tilesChanged.fetch_add(update.tiles.size(), std::memory_order_relaxed);
+
+        m_callback(std::move(update), job.timestamp, job.receivedUs);
+    }
+}
+
+Spider2::MapTileUpdate MapColorizer::diffMap(const uint8_t *cells, int sizePixels, double sizeMeters)
+{
+    Spider2::MapTileUpdate update;
+    update.sizePixels = sizePixels;
+    update.sizeMeters = sizeMeters;
+    update.reset = sizePixels != m_size;
+    if (update.reset) {
+        // Start from an all-unknown grid: every tile with a known cell shows up as changed
+        m_size = sizePixels;
+        m_levels.resize(static_cast<size_t>(Spider2::mapLevelCount(sizePixels)));
+        for (size_t level = 0; level < m_levels.size(); ++level)
+            m_levels[level].reset(Spider2::mapLevelSize(sizePixels, static_cast<int>(level)));
+    }
+
+    TileWork work;
+    work.cells = cells;
+    work.size = sizePixels;
+    work.bands = Spider2::mapTileColumns(sizePixels);
+    m_rowTiles.resize(static_cast<size_t>(work.bands));
+
+    if (m_helpers.empty() || work.bands < 2 || sizePixels * sizePixels < PARALLEL_MIN_CELLS) {
+        m_nextBand.store(0, std::memory_order_relaxed);
+        diffBands(work);
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(m_workMutex);
+            m_work = work;
+            m_nextBand.store(0, std::memory_order_relaxed);
+            m_bandsLeft = work.bands;
+            ++m_workGeneration;
+        }
+        m_workAvailable.notify_all();
+        diffBands(work);
+
+        std::unique_lock<std::mutex> lock(m_workMutex);
+        m_workDone.wait(lock, [this]() { return m_bandsLeft == 0 && m_activeHelpers == 0; });
+    }
+
+    // The store is only written here, once the threads are done reading it
+    Spider2::MapStore &store = m_levels[0];
+    for (auto &row : m_rowTiles) {
+        for (Spider2::MapTile &tile : row) {
+            store.setChunk(tile.column, tile.row, tile.chunk);
+            update.tiles.push_back(std::move(tile));
+        }
+        row.clear();
+    }
+    updatePyramid(update);
+    updateStoreStats();
+    return update;
+}
+
+void MapColorizer::seed(const Spider2::MapTileUpdate &map)
+{
+    m_size = map.sizePixels;
+    m_levels.resize(static_cast<size_t>(map.sizePixels > 0 ? Spider2::mapLevelCount(map.sizePixels) : 0));
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        m_levels[level].reset(Spider2::mapLevelSize(map.sizePixels, static_cast<int>(level)));
+    for (const Spider2::MapTile &tile : map.tiles) {
+        if (tile.level < 0 || tile.level >= static_cast<int>(m_levels.size()))
+            continue;
+        Spider2::MapStore &store = m_levels[static_cast<size_t>(tile.level)];
+        if (tile.column < store.columns() && tile.row < store.columns())
+            store.setChunk(tile.column, tile.row, tile.chunk);
+    }
+    updateStoreStats();
+}
+
+void MapColorizer::updateStoreStats()
+{
+    size_t bytes = 0;
+    size_t chunks = 0;
+    for (const Spider2::MapStore &level : m_levels) {
+        bytes += level.memoryBytes();
+        chunks += level.chunkCount();
+    }
+    m_storeBytes.store(bytes, std::memory_order_relaxed);
+    m_storeChunks.store(chunks, std::memory_order_relaxed);
+}
+
+void MapColorizer::updatePyramid(Spider2::MapTileUpdate &update)
+{
+    constexpr int TILE = Spider2::MAP_TILE_SIZE;
+    constexpr int HALF = TILE / 2;
+    std::vector<std::pair<int, int>> dirty;   // (row, column) of changed tiles one level down, sorted
+    for (const Spider2::MapTile &tile : update.tiles)
+        dirty.emplace_back(tile.row, tile.column);
+    std::sort(dirty.begin(), dirty.end());
+
+    for (size_t level = 1; level < m_levels.size() && !dirty.empty(); ++level) {
+        const Spider2::MapStore &finer = m_levels[level - 1];
+        Spider2::MapStore &coarser = m_levels[level];
+
+        std::vector<std::pair<int, int>> parents;
+        parents.reserve(dirty.size());
+        for (const auto &[row, column] : dirty)
+            parents.emplace_back(row / 2, column / 2);
+        std::sort(parents.begin(), parents.end());
+        parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+
+        std::vector<std::pair<int, int>> changed;
+        for (const auto &[row, column] : parents) {
+            const Spider2::MapChunkPtr &previous = coarser.chunk(column, row);
+            auto chunk = std::make_shared<Spider2::MapChunk>(previous ? *previous : Spider2::MapStore::unknownChunk());
+
+            // Each changed child shrinks into its quarter of the parent; a coarser cell
+            // is the minimum of the (up to) 2×2 finer cells under it
+            for (int quarter = 0; quarter < 4; ++quarter) {
+                const int childRow = row * 2 + quarter / 2;
+                const int childColumn = column * 2 + quarter % 2;
+                if (!std::binary_search(dirty.begin(), dirty.end(), std::make_pair(childRow, childColumn)))
+                    continue;
+                const Spider2::MapChunkPtr &child = finer.chunk(childColumn, childRow);
+                const int childWidth = std::min(TILE, finer.size() - childColumn * TILE);
+                const int childHeight = std::min(TILE, finer.size() - childRow * TILE);
+                uint8_t *out = chunk->cells.data() + static_cast<size_t>(quarter / 2 * HALF) * TILE
+                             + static_cast<size_t>(quarter % 2 * HALF);
+                for (int y = 0; y < (childHeight + 1) / 2; ++y) {
+                    uint8_t *outRow = out + static_cast<size_t>(y) * TILE;
+                    if (!child) {
+                        std::memset(outRow, Spider2::MAP_UNKNOWN, static_cast<size_t>((childWidth + 1) / 2));
+                        continue;
+                    }
+                    const uint8_t *upper = child->cells.data() + static_cast<size_t>(2 * y) * TILE;
+                    const uint8_t *lower = 2 * y + 1 < childHeight ? upper + TILE : upper;
+                    for (int x = 0; x < (childWidth + 1) / 2; ++x) {
+                        const int x1 = std::min(2 * x + 1, childWidth - 1);
+                        outRow[x] = std::min(std::min(upper[2 * x], upper[x1]), std::min(lower[2 * x], lower[x1]));
+                    }
+                }
+            }
+
+            // A parent that came out the same stops the change from travelling further up
+            if (previous ? std::memcmp(chunk->cells.data(), previous->cells.data(), chunk->cells.size()) == 0
+                         : Spider2::MapStore::isUnknown(*chunk))
+                continue;
+            Spider2::MapChunkPtr stored;
+            if (!Spider2::MapStore::isUnknown(*chunk))
+                stored = std::move(chunk);
+            coarser.setChunk(column, row, stored);
+            update.tiles.push_back(Spider2::MapTile{column, row, static_cast<int>(level), std::move(stored)});
+            changed.emplace_back(row, column);
+        }
+        dirty = std::move(changed);
+    }
+}
+
+void MapColorizer::helperLoop()
+{
+    uint64_t seen = 0;
+    while (true) {
+        TileWork work;
+        {
+            std::unique_lock<std::mutex> lock(m_workMutex);
+            m_workAvailable.wait(lock, [&]() { return m_workGeneration != seen || !m_running; });
+            if (!m_running) return;
+            seen = m_workGeneration;
+            // Woken after the others finished this map: nothing left, and the next one has not begun
+            if (m_bandsLeft == 0) continue;
+            work = m_work;
+            ++m_activeHelpers;
+        }
+        diffBands(work);
+        {
+            std::lock_guard<std::mutex> lock(m_workMutex);
+            --m_activeHelpers;
+        }
+        m_workDone.notify_one();
+    }
+}
+
+void MapColorizer::diffBands(const TileWork &work)
+{
+    int band;
+    while ((band = m_nextBand.fetch_add(1, std::memory_order_relaxed)) < work.bands) {
+        diffTileRow(work, band, m_rowTiles[static_cast<size_t>(band)]);
+        // Single-threaded runs never published m_bandsLeft
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        if (m_bandsLeft > 0)
+            --m_bandsLeft;
+    }
+}
+
+void MapColorizer::diffTileRow(const TileWork &work, int row, std::vector<Spider2::MapTile> &tiles)
+{
+    constexpr int TILE = Spider2::MAP_TILE_SIZE;
+    const Spider2::MapStore &store = m_levels[0];
+    const Spider2::MapChunk &unknown = Spider2::MapStore::unknownChunk();
+    const size_t stride = static_cast<size_t>(work.size);
+    const int top = row * TILE;
+    const int height = std::min(TILE, work.size - top);
+    for (int left = 0; left < work.size; left += TILE) {
+        const int column = left / TILE;
+        const int width = std::min(TILE, work.size - left);
+        const uint8_t *first = work.cells + static_cast<size_t>(top) * stride + static_cast<size_t>(left);
+
+        // A tile without a chunk is all unknown: compare against that
+        const Spider2::MapChunkPtr &previous = store.chunk(column, row);
+        const uint8_t *before = previous ? previous->cells.data() : unknown.cells.data();
+        bool changed = false;
+        for (int y = 0; !changed && y < height; ++y) {
+            changed = std::memcmp(first + static_cast<size_t>(y) * stride, before + static_cast<size_t>(y) * TILE,
+                                  static_cast<size_t>(width)) != 0;
+        }
+        if (!changed) continue;
+
+        auto chunk = std::make_shared<Spider2::MapChunk>();
+        if (width < TILE || height < TILE)
+            chunk->cells = unknown.cells;   // edge tile: the part past the map stays unknown
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(chunk->cells.data() + static_cast<size_t>(y) * TILE, first + static_cast<size_t>(y) * stride,
+                        static_cast<size_t>(width));
+        }
+        Spider2::MapChunkPtr stored;
+        if (!Spider2::MapStore::isUnknown(*chunk))
+            stored = std::move(chunk);
+        tiles.push_back(Spider2::MapTile{column, row, 0, std::move(stored)});
+    }
+}
+
+QImage MapColorizer::tileImage(const Spider2::MapChunk *chunk, int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    const uint8_t *cells = chunk ? chunk->cells.data() : Spider2::MapStore::unknownChunk().cells.data();
+    for (int y = 0; y < height; ++y) {
+        colorizeRow(cells + static_cast<size_t>(y) * Spider2::MAP_TILE_SIZE, reinterpret_cast<QRgb *>(image.scanLine(y)),
+                    width);
+    }
+    return image;
+}
+
+QRgb MapColorizer::colorOf(uint8_t cell)
+{
+    return colorTable()[cell];
+}
+
+void MapColorizer::colorizeRow(const uint8_t *cells, QRgb *pixels, int count)
+{
+    int x = 0;
+
+#if defined(SPIDER2_MAP_AVX2)
+    {
+        const __m256i one = _mm256_set1_epi8(1);
+        const __m256i cell128 = _mm256_set1_epi8(static_cast<char>(128));
+        const __m256i cell127 = _mm256_set1_epi8(127);
+        const __m256i ones = _mm256_set1_epi8(-1);
+        const __m256i zero = _mm256_setzero_si256();
+        for (; x + 32 <= count; x += 32) {
+            const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + x));
+            const __m256i inverted = _mm256_xor_si256(c, ones);
+            const __m256i r = _mm256_adds_epu8(_mm256_adds_epu8(inverted, inverted),
+                                               _mm256_and_si256(_mm256_cmpeq_epi8(c, cell128), one));
+            const __m256i g = _mm256_adds_epu8(_mm256_adds_epu8(c, c),
+                                               _mm256_and_si256(_mm256_cmpeq_epi8(c, cell127), one));
+            // Unpacks work per 128-bit lane: p0 holds pixels 0-3 | 16-19, p1 4-7 | 20-23, ...
+            const __m256i bgLo = _mm256_unpacklo_epi8(zero, g);
+            const __m256i bgHi = _mm256_unpackhi_epi8(zero, g);
+            const __m256i raLo = _mm256_unpacklo_epi8(r, ones);
+            const __m256i raHi = _mm256_unpackhi_epi8(r, ones);
+            const __m256i p0 = _mm256_unpacklo_epi16(bgLo, raLo);
+            const __m256i p1 = _mm256_unpackhi_epi16(bgLo, raLo);
+            const __m256i p2 = _mm256_unpacklo_epi16(bgHi, raHi);
+            const __m256i p3 = _mm256_unpackhi_epi16(bgHi, raHi);
+            auto *out = reinterpret_cast<__m256i *>(pixels + x);
+            _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+            _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+            _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+            _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+        }
+    }
+#endif
+
+#if defined(SPIDER2_MAP_SSE2)
+    {
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i cell128 = _mm_set1_epi8(static_cast<char>(128));
+        const __m128i cell127 = _mm_set1_epi8(127);
+        const __m128i ones = _mm_set1_epi8(-1);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 16 <= count; x += 16) {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + x));
+            const __m128i inverted = _mm_xor_si128(c, ones);
+            const __m128i r = _mm_adds_epu8(_mm_adds_epu8(inverted, inverted),
+                                            _mm_and_si128(_mm_cmpeq_epi8(c, cell128), one));
+            const __m128i g = _mm_adds_epu8(_mm_adds_epu8(c, c), _mm_and_si128(_mm_cmpeq_epi8(c, cell127), one));
+            // Little-endian ARGB32 is B, G, R, A in memory
+            const __m128i bgLo = _mm_unpacklo_epi8(zero, g);
+            const __m128i bgHi = _mm_unpackhi_epi8(zero, g);
+            const __m128i raLo = _mm_unpacklo_epi8(r, ones);
+            const __m128i raHi = _mm_unpackhi_epi8(r, ones);
+            auto *out = reinterpret_cast<__m128i *>(pixels + x);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bgLo, raLo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+        }
+    }
+#elif defined(SPIDER2_MAP_NEON)
+    {
+        const uint8x16_t one = vdupq_n_u8(1);
+        const uint8x16_t cell128 = vdupq_n_u8(128);
+        const uint8x16_t cell127 = vdupq_n_u8(127);
+        uint8x16x4_t bgra;
+        bgra.val[0] = vdupq_n_u8(0);
+        bgra.val[3] = vdupq_n_u8(255);
+        for (; x + 16 <= count; x += 16) {
+            const uint8x16_t c = vld1q_u8(cells + x);
+            const uint8x16_t inverted = vmvnq_u8(c);
+            bgra.val[1] = vqaddq_u8(vqaddq_u8(c, c), vandq_u8(vceqq_u8(c, cell127), one));
+            bgra.val[2] = vqaddq_u8(vqaddq_u8(inverted, inverted), vandq_u8(vceqq_u8(c, cell128), one));
+            vst4q_u8(reinterpret_cast<uint8_t *>(pixels + x), bgra);
+        }
+    }
+#endif
+
+    const std::array<QRgb, 256> &table = colorTable();
+    for (; x < count; ++x)
+        pixels[x] = table[cells[x]];
+}
+
+MapColorizer::Stats MapColorizer::takeStats()
+{
+    Stats s;
+    s.colorized = m_colorized.exchange(0, std::memory_order_relaxed);
+    s.overrunDropped = m_overrunDropped.exchange(0, std::memory_order_relaxed);
+    s.tilesChanged = m_tilesChanged.exchange(0, std::memory_order_relaxed);
+    s.storeChunks = m_storeChunks.load(std::memory_order_relaxed);
+    s.storeBytes = m_storeBytes.load(std::memory_order_relaxed);
+    s.colorizeTime = m_colorizeTime.snapshot(true);
+    return s;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <QImage>
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "MapStore.h"
+#include "MapTiles.h"
+#include "RawFrame.h"
+
+/**
+ * @brief Turns SLAM_MAP occupancy cells into map tiles, off the GUI thread
+ *
+ * Only the newest map matters: a map submitted while another one waits
+ * replaces it. The colorizer keeps the previous map in a sparse
+ * Spider2::MapStore and compares each new map with it in MAP_TILE_SIZE²
+ * tiles; only tiles that differ get a new chunk and are passed on, as a
+ * Spider2::MapTileUpdate. SLAM maps mostly change around the robot, so that
+ * is usually a handful of tiles. Chunks stay 8-bit all the way to the render
+ * thread, which colorizes a tile (tileImage()) just before uploading it.
+ *
+ * It also keeps a pyramid of the grid (see Spider2::mapLevelCount()) for
+ * zoomed-out views. A coarser cell is the minimum of the 2×2 cells below it,
+ * so obstacles (0) survive over unknown (127) and unknown over free (255),
+ * and thin walls stay visible. Only the part under changed tiles is
+ * recomputed, level by level.
+ *
+ * Each cell maps to a colour through a 256-entry table. Rows are converted 16
+ * or 32 cells at a time with SSE2, AVX2 (when the build enables it) or NEON,
+ * using arithmetic that reproduces the table exactly. On large maps the rows
+ * of tiles are diffed by helper threads as well.
+ */
+class MapColorizer
+{
+public:
+    /**
+     * @brief Invoked on the colorizer thread for every map, changed tiles or not
+     * @param receivedUs RawFrame::receivedUs of the map
+     */
+    using MapCallback = std::function<void(Spider2::MapTileUpdate &&update, qint64 timestamp, qint64 receivedUs)>;
+
+    struct Stats {
+        uint64_t colorized{0};
+        uint64_t overrunDropped{0};   ///< Replaced by a newer map while waiting
+        uint64_t tilesChanged{0};
+        uint64_t storeChunks{0};      ///< Chunks held now, all levels
+        uint64_t storeBytes{0};       ///< Memory they take (Spider2::MapStore::memoryBytes())
+        Spider2::LatencyHistogram::Snapshot colorizeTime;   ///< Diff and pyramid update per map
+    };
+
+    /// @param helperCount Threads that share large maps besides the colorizer thread; -1 = by core count
+    explicit MapColorizer(MapCallback callback, int helperCount = -1);
+    ~MapColorizer();
+
+    void start();
+    void stop();
+
+    /**
+     * @brief Queue a map. Never blocks.
+     * @param frame Keeps the receive buffer behind @p cells alive (copied when it has no owner)
+     * @param cells sizePixels² occupancy bytes, row-major
+     * @param timestamp SlamMap.timestamp (robot clock, ms)
+     */
+    void submit(const Spider2::RawFrame &frame, const uint8_t *cells, int sizePixels, double sizeMeters,
+                qint64 timestamp);
+
+    /**
+     * @brief Diff @p cells against the previous map and update the pyramid where tiles changed
+     *
+     * Shares the work with the helpers once started. One caller at a time: the
+     * colorizer thread while maps are being submitted.
+     */
+    Spider2::MapTileUpdate diffMap(const uint8_t *cells, int sizePixels, double sizeMeters);
+
+    /**
+     * @brief Diff the next map against @p map (a reset update holding every
+     * stored tile, e.g. the one on screen) instead of an empty grid
+     *
+     * Call before start().
+     */
+    void seed(const Spider2::MapTileUpdate &map);
+
+    /// @brief The top-left @p width × @p height cells of @p chunk as pixels; nullptr = all unknown
+    static QImage tileImage(const Spider2::MapChunk *chunk, int width, int height);
+
+    /// @brief Colour of one cell: BreezySLAM 255 = free (green), 127 = unknown (yellow), 0 = occupied (red)
+    static QRgb colorOf(uint8_t cell);
+
+    /// @brief @p count cells to pixels, vectorized where available
+    static void colorizeRow(const uint8_t *cells, QRgb *pixels, int count);
+
+    unsigned threadCount() const { return static_cast<unsigned>(m_helperCount) + 1; }
+
+    /// @brief Counters and colorize-time histogram since the previous call
+    Stats takeStats();
+
+    /// @brief Maps below this many cells are colorized by one thread
+    static constexpr int PARALLEL_MIN_CELLS = 512 * 512;
+
+private:
+    struct Job {
+        Spider2::RawFrame frame;
+        const uint8_t *cells{nullptr};
+        int sizePixels{0};
+        double sizeMeters{0.0};
+        qint64 timestamp{0};
+        qint64 receivedUs{0};
+    };
+
+    struct TileWork {
+        const uint8_t *cells{nullptr};
+        int size{0};
+        int bands{0};            // one per row of tiles
+    };
+
+    void colorizeLoop();
+    void helperLoop();
+    void diffBands(const TileWork &work);
+    void diffTileRow(const TileWork &work, int row, std::vector<Spider2::MapTile> &tiles);
+    void updatePyramid(Spider2::MapTileUpdate &update);
+    void updateStoreStats();
+
+    MapCallback m_callback;
+    int m_helperCount{0};
+    std::thread m_thread;
+    std::vector<std::thread> m_helpers;
+    std::atomic<bool> m_running{false};
+
+    // Latest submitted map
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobAvailable;
+    std::optional<Job> m_pending;
+
+    // Previous map (level 0: what the next one is diffed against) and its pyramid
+    std::vector<Spider2::MapStore> m_levels;
+    int m_size{0};
+
+    // Rows of tiles of the map being colorized, shared with the helpers
+    std::mutex m_workMutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_workDone;
+    TileWork m_work;
+    std::vector<std::vector<Spider2::MapTile>> m_rowTiles;   // changed tiles per row, written by whoever takes the band
+    uint64_t m_workGeneration{0};
+    std::atomic<int> m_nextBand{0};
+    int m_bandsLeft{0};
+    int m_activeHelpers{0};
+
+    std::atomic<uint64_t> m_colorized{0};
+    std::atomic<uint64_t> m_overrunDropped{0};
+    std::atomic<uint64_t> m_tilesChanged{0};
+    std::atomic<uint64_t> m_storeChunks{0};
+    std::atomic<uint64_t> m_storeBytes{0};
+    Spider2::LatencyHistogram m_colorizeTime;
+};
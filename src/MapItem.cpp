@@ -0,0 +1,325 @@
+#include "MapItem.h"
+#include <QMatrix4x4>
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QSGFlatColorMaterial>
+#include <QSGNode>
+#include <QSGRectangleNode>
+#include <algorithm>
+#include <cmath>
+#include "ImageTexture.h"
+#include "MapColorizer.h"
+
+/**
+ * @brief Tile texture fed with 8-bit map cells
+ *
+ * The chunk is colorized in commitTextureOperations(), on the render thread
+ * right before the upload, so 32-bit pixels of the map exist only for as
+ * long as an upload takes.
+ */
+class MapTileTexture : public ImageTexture
+{
+public:
+    QSize textureSize() const override { return m_cells; }
+
+    void setChunk(Spider2::MapChunkPtr chunk, const QSize &cells)
+    {
+        m_chunk = std::move(chunk);
+        m_cells = cells;
+    }
+
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override
+    {
+        if (m_chunk) {
+            setImage(MapColorizer::tileImage(m_chunk.get(), m_cells.width(), m_cells.height()));
+            m_chunk.reset();
+        }
+        ImageTexture::commitTextureOperations(rhi, resourceUpdates);
+    }
+
+private:
+    Spider2::MapChunkPtr m_chunk;
+    QSize m_cells;
+};
+
+MapItem::MapItem(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void MapItem::setController(SlamController *controller)
+{
+    if (m_controller == controller)
+        return;
+
+    if (m_tilesConnection)
+        disconnect(m_tilesConnection);
+    if (m_mapConnection)
+        disconnect(m_mapConnection);
+    if (m_trailConnection)
+        disconnect(m_trailConnection);
+
+    m_controller = controller;
+    if (m_controller) {
+        m_tilesConnection = connect(m_controller, &SlamController::mapFrameIndexChanged,
+                                    this, &QQuickItem::update);
+        m_trailConnection = connect(m_controller, &SlamController::trailChanged,
+                                    this, &QQuickItem::update);
+        m_mapConnection = connect(m_controller, &SlamController::mapChanged,
+                                  this, &MapItem::updatePaintedRect);
+    }
+    updatePaintedRect();
+    update();
+    emit controllerChanged();
+}
+
+void MapItem::setTrailColor(const QColor &color)
+{
+    if (m_trailColor == color)
+        return;
+    m_trailColor = color;
+    m_trailDirty = true;
+    update();
+    emit trailColorChanged();
+}
+
+void MapItem::setZoom(qreal zoom)
+{
+    if (qFuzzyCompare(m_zoom, zoom))
+        return;
+    m_zoom = zoom;
+    updateLevel();
+    emit zoomChanged();
+}
+
+void MapItem::updatePaintedRect()
+{
+    QRectF painted;
+    const int size = m_controller ? m_controller->mapSizePixels() : 0;
+    if (size > 0 && width() > 0 && height() > 0) {
+        // Image.PreserveAspectFit equivalent; SLAM maps are square
+        const qreal side = qMin(width(), height());
+        painted = QRectF((width() - side) / 2.0, (height() - side) / 2.0, side, side);
+    }
+    if (painted != m_paintedRect) {
+        m_paintedRect = painted;
+        emit paintedGeometryChanged();
+        update();
+    }
+    updateLevel();
+}
+
+void MapItem::updateLevel()
+{
+    // Map cells per device pixel at the current zoom; each level halves it
+    int level = 0;
+    const int size = m_controller ? m_controller->mapSizePixels() : 0;
+    const int levels = m_controller ? m_controller->mapLevelCount() : 0;
+    const qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    const qreal shown = m_paintedRect.width() * m_zoom * dpr;
+    if (size > 0 && shown > 0) {
+        for (qreal cellsPerPixel = size / shown; level + 1 < levels && cellsPerPixel >= 2.0; cellsPerPixel /= 2.0)
+            ++level;
+    }
+    if (level != m_level) {
+        m_level = level;
+        emit levelChanged();
+        update();
+    }
+}
+
+QSGNode *MapItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    QQuickWindow *win = window();
+    auto *root = static_cast<QSGTransformNode *>(oldNode);
+    const int size = m_controller ? m_controller->mapSizePixels() : 0;
+    const int levels = m_controller ? m_controller->mapLevelCount() : 0;
+
+    if (!win || size <= 0 || levels <= 0 || m_paintedRect.isEmpty()) {
+        delete root;
+        m_levelNodes.clear();
+        m_trailNode = nullptr;
+        m_mapSize = 0;
+        return nullptr;
+    }
+
+    if (!root || size != m_mapSize || levels != static_cast<int>(m_levelNodes.size())) {
+        // New map size (or first sync): the old tile nodes go with the old root
+        delete root;
+        root = new QSGTransformNode;
+
+        // Unknown cells are not stored, so they have no tiles: one rectangle shows them all
+        QSGRectangleNode *unknown = win->createRectangleNode();
+        unknown->setColor(QColor::fromRgb(MapColorizer::colorOf(Spider2::MAP_UNKNOWN)));
+        unknown->setRect(QRectF(0, 0, size, size));
+        root->appendChildNode(unknown);
+
+        m_levelNodes.assign(static_cast<size_t>(levels), LevelNode());
+        for (int level = 0; level < levels; ++level) {
+            LevelNode &levelNode = m_levelNodes[static_cast<size_t>(level)];
+            levelNode.group = new QSGOpacityNode;
+            levelNode.columns = m_controller->mapLevel(level).columns();
+            levelNode.tiles.assign(static_cast<size_t>(levelNode.columns) * static_cast<size_t>(levelNode.columns),
+                                   TileNode());
+            root->appendChildNode(levelNode.group);
+        }
+
+        // Pose trail on top of every level
+        m_trailNode = new QSGGeometryNode;
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+        m_trailNode->setGeometry(geometry);
+        m_trailNode->setFlag(QSGNode::OwnsGeometry);
+        m_trailNode->setMaterial(new QSGFlatColorMaterial);
+        m_trailNode->setFlag(QSGNode::OwnsMaterial);
+        root->appendChildNode(m_trailNode);
+        m_trailDirty = true;
+        m_mapSize = size;
+    }
+
+    const int shown = std::min(m_level, levels - 1);
+    for (int level = 0; level < levels; ++level)
+        m_levelNodes[static_cast<size_t>(level)].group->setOpacity(level == shown ? 1.0 : 0.0);
+
+    // Only the level on screen is kept current; the others catch up when shown again
+    LevelNode &levelNode = m_levelNodes[static_cast<size_t>(shown)];
+    const Spider2::MapStore &store = m_controller->mapLevel(shown);
+    const qreal cellSize = static_cast<qreal>(1 << shown);   // map pixels per cell of this level
+    for (int index = 0; index < static_cast<int>(levelNode.tiles.size()); ++index) {
+        const int column = index % levelNode.columns;
+        const int row = index / levelNode.columns;
+        TileNode &tile = levelNode.tiles[static_cast<size_t>(index)];
+        const quint64 revision = m_controller->mapTileRevision(shown, column, row);
+        if (revision == tile.revision)
+            continue;
+        tile.revision = revision;
+
+        const Spider2::MapChunkPtr &chunk = store.chunk(column, row);
+        if (!chunk) {
+            // Back to all unknown: the background shows through
+            if (tile.node) {
+                levelNode.group->removeChildNode(tile.node);
+                delete tile.node;
+                tile = TileNode{nullptr, nullptr, revision};
+            }
+            continue;
+        }
+
+        if (!tile.node) {
+            tile.node = win->createImageNode();
+            tile.node->setOwnsTexture(true);
+            tile.node->setFiltering(QSGTexture::Nearest);
+            levelNode.group->appendChildNode(tile.node);
+        }
+        const QSize cells(std::min(Spider2::MAP_TILE_SIZE, store.size() - column * Spider2::MAP_TILE_SIZE),
+                          std::min(Spider2::MAP_TILE_SIZE, store.size() - row * Spider2::MAP_TILE_SIZE));
+        if (win->rhi()) {
+            if (!tile.texture) {
+                tile.texture = new MapTileTexture;
+                tile.node->setTexture(tile.texture);
+            }
+            tile.texture->setChunk(chunk, cells);
+        } else {
+            // Software backend: textures are plain image wrappers
+            tile.node->setTexture(win->createTextureFromImage(
+                MapColorizer::tileImage(chunk.get(), cells.width(), cells.height())));
+        }
+
+        // In map pixels; the last cell of an odd-sized level reaches past the map edge, so clip it
+        const qreal x = column * Spider2::MAP_TILE_SIZE * cellSize;
+        const qreal y = row * Spider2::MAP_TILE_SIZE * cellSize;
+        const qreal width = std::min(cells.width() * cellSize, size - x);
+        const qreal height = std::min(cells.height() * cellSize, size - y);
+        tile.node->setRect(QRectF(x, y, width, height));
+        tile.node->setSourceRect(QRectF(0, 0, width / cellSize, height / cellSize));
+        tile.node->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    updateTrailNode(size);
+
+    // Map pixels → item coordinates
+    QMatrix4x4 matrix;
+    matrix.translate(static_cast<float>(m_paintedRect.x()), static_cast<float>(m_paintedRect.y()));
+    matrix.scale(static_cast<float>(m_paintedRect.width() / size), static_cast<float>(m_paintedRect.height() / size));
+    root->setMatrix(matrix);
+    return root;
+}
+
+void MapItem::updateTrailNode(int size)
+{
+    // A triangle strip around the trail, since line widths other than 1 are not supported with
+    // RHI; at most PoseTrail's bounded point count, rebuilt only when the trail or the scale changed
+    const Spider2::PoseTrail &trail = m_controller->trail();
+    const double pixelsPerMm = m_controller->mapSizeMeters() > 0.0
+        ? size / (m_controller->mapSizeMeters() * 1000.0) : 0.0;
+    const double halfWidth = TRAIL_WIDTH / 2.0 * size / m_paintedRect.width();
+    if (!m_trailDirty && trail.revision() == m_trailRevision && pixelsPerMm == m_trailPixelsPerMm
+        && halfWidth == m_trailHalfWidth)
+        return;
+    m_trailDirty = false;
+    m_trailRevision = trail.revision();
+    m_trailPixelsPerMm = pixelsPerMm;
+    m_trailHalfWidth = halfWidth;
+
+    QSGGeometry *geometry = m_trailNode->geometry();
+    const std::vector<Spider2::PoseTrail::Point> points = trail.points();
+    const int count = points.size() >= 2 && pixelsPerMm > 0.0 ? static_cast<int>(points.size()) : 0;
+    geometry->allocate(2 * count);
+    QSGGeometry::Point2D *vertex = geometry->vertexDataAsPoint2D();
+    const auto scale = static_cast<float>(pixelsPerMm);
+    const auto half = static_cast<float>(halfWidth);
+    float normalX = 0.0f;
+    float normalY = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        // Offset across the direction of travel at this point (previous → next point)
+        const Spider2::PoseTrail::Point &from = points[static_cast<size_t>(std::max(i - 1, 0))];
+        const Spider2::PoseTrail::Point &to = points[static_cast<size_t>(std::min(i + 1, count - 1))];
+        const float dx = to.x_mm - from.x_mm;
+        const float dy = to.y_mm - from.y_mm;
+        const float length = std::hypot(dx, dy);
+        if (length > 0.0f) {
+            normalX = -dy / length * half;
+            normalY = dx / length * half;
+        }
+        const float x = points[static_cast<size_t>(i)].x_mm * scale;
+        const float y = points[static_cast<size_t>(i)].y_mm * scale;
+        (vertex++)->set(x + normalX, y + normalY);
+        (vertex++)->set(x - normalX, y - normalY);
+    }
+    static_cast<QSGFlatColorMaterial *>(m_trailNode->material())->setColor(m_trailColor);
+    m_trailNode->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+}
+
+QPointF MapItem::itemToWorld(qreal x, qreal y) const
+{
+    const int size = m_controller ? m_controller->mapSizePixels() : 0;
+    if (size <= 0 || m_paintedRect.isEmpty())
+        return QPointF();
+    const qreal mmPerItemPixel = m_controller->mapSizeMeters() * 1000.0 / m_paintedRect.width();
+    return QPointF((x - m_paintedRect.x()) * mmPerItemPixel, (y - m_paintedRect.y()) * mmPerItemPixel);
+}
+
+QPointF MapItem::worldToItem(qreal x_mm, qreal y_mm) const
+{
+    const int size = m_controller ? m_controller->mapSizePixels() : 0;
+    if (size <= 0 || m_paintedRect.isEmpty() || m_controller->mapSizeMeters() <= 0.0)
+        return QPointF();
+    const qreal itemPixelsPerMm = m_paintedRect.width() / (m_controller->mapSizeMeters() * 1000.0);
+    return QPointF(m_paintedRect.x() + x_mm * itemPixelsPerMm, m_paintedRect.y() + y_mm * itemPixelsPerMm);
+}
+
+void MapItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+        updatePaintedRect();
+}
+
+void MapItem::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+    if (change == ItemSceneChange || change == ItemDevicePixelRatioHasChanged)
+        updateLevel();
+}
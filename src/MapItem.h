@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QColor>
+#include <QPointF>
+#include <QPointer>
+#include <QQuickItem>
+#include <QRectF>
+#include <vector>
+#include "SlamController.h"
+
+class MapTileTexture;
+class QSGGeometryNode;
+class QSGImageNode;
+class QSGOpacityNode;
+
+/**
+ * @brief Scene-graph item that shows the SLAM map as a grid of tile textures
+ *
+ * Replaces the "image://map" round-trip, which copied (and possibly rescaled)
+ * the whole map and uploaded a new full-size texture for every SLAM_MAP. The
+ * item draws SlamController's stored chunks, one image node each, on a single
+ * rectangle for the unknown area, and re-uploads only tiles whose revision
+ * changed since the last sync. Chunks are colorized on the render thread as
+ * they are uploaded.
+ *
+ * Tiles are laid out in map pixels under one transform node that fits the
+ * map into the item (Image.PreserveAspectFit), so resizing the item, or
+ * panning and zooming it through QML transforms, never touches the textures.
+ * The fitted rectangle is exposed as paintedX / paintedY / paintedWidth /
+ * paintedHeight, like Image, for overlays and hit-testing.
+ *
+ * Zoomed out, the item draws a coarser level of SlamController's pyramid:
+ * the finest one that still has at least one map cell per device pixel at
+ * the current zoom. Each level keeps its textures once uploaded and is
+ * hidden rather than dropped when another level is shown, so zooming back
+ * only uploads what changed meanwhile.
+ *
+ * SlamController's pose trail is drawn over the map as a single line strip,
+ * rebuilt only when the trail changes; its point count is bounded however
+ * long the run, so the cost per frame is too.
+ */
+class MapItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(SlamController* controller READ controller WRITE setController NOTIFY controllerChanged)
+    Q_PROPERTY(qreal paintedX READ paintedX NOTIFY paintedGeometryChanged)
+    Q_PROPERTY(qreal paintedY READ paintedY NOTIFY paintedGeometryChanged)
+    Q_PROPERTY(qreal paintedWidth READ paintedWidth NOTIFY paintedGeometryChanged)
+    Q_PROPERTY(qreal paintedHeight READ paintedHeight NOTIFY paintedGeometryChanged)
+    Q_PROPERTY(qreal zoom READ zoom WRITE setZoom NOTIFY zoomChanged)
+    Q_PROPERTY(int level READ level NOTIFY levelChanged)
+    Q_PROPERTY(QColor trailColor READ trailColor WRITE setTrailColor NOTIFY trailColorChanged)
+
+public:
+    explicit MapItem(QQuickItem *parent = nullptr);
+
+    SlamController* controller() const { return m_controller; }
+    void setController(SlamController *controller);
+
+    qreal paintedX() const { return m_paintedRect.x(); }
+    qreal paintedY() const { return m_paintedRect.y(); }
+    qreal paintedWidth() const { return m_paintedRect.width(); }
+    qreal paintedHeight() const { return m_paintedRect.height(); }
+
+    /// @brief Scale applied to the item by transforms above it (QML pan / zoom); picks the pyramid level
+    qreal zoom() const { return m_zoom; }
+    void setZoom(qreal zoom);
+
+    /// @brief Pyramid level being drawn
+    int level() const { return m_level; }
+
+    QColor trailColor() const { return m_trailColor; }
+    void setTrailColor(const QColor &color);
+
+    /// @brief Item coordinates → world millimetres (map origin at the top-left corner)
+    Q_INVOKABLE QPointF itemToWorld(qreal x, qreal y) const;
+    /// @brief World millimetres → item coordinates
+    Q_INVOKABLE QPointF worldToItem(qreal x_mm, qreal y_mm) const;
+
+signals:
+    void controllerChanged();
+    void paintedGeometryChanged();
+    void zoomChanged();
+    void levelChanged();
+    void trailColorChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private:
+    void updatePaintedRect();
+    void updateLevel();
+    void updateTrailNode(int size);
+
+    static constexpr double TRAIL_WIDTH = 2.0;   // item pixels
+
+    QPointer<SlamController> m_controller;
+    QMetaObject::Connection m_tilesConnection;
+    QMetaObject::Connection m_mapConnection;
+    QMetaObject::Connection m_trailConnection;
+    QRectF m_paintedRect;
+    qreal m_zoom{1.0};
+    int m_level{0};
+    QColor m_trailColor{0, 170, 255};
+
+    // Render thread: nodes and textures are owned by the node tree
+    struct TileNode {
+        QSGImageNode *node{nullptr};
+        MapTileTexture *texture{nullptr};
+        quint64 revision{0};           // SlamController::mapTileRevision() on the GPU
+    };
+    struct LevelNode {
+        QSGOpacityNode *group{nullptr};   // opacity 0 hides the level without dropping its textures
+        std::vector<TileNode> tiles;
+        int columns{0};
+    };
+    std::vector<LevelNode> m_levelNodes;
+    int m_mapSize{0};                  // map size the nodes were built for
+    QSGGeometryNode *m_trailNode{nullptr};
+    quint64 m_trailRevision{0};        // PoseTrail::revision() in m_trailNode
+    double m_trailPixelsPerMm{0.0};
+    double m_trailHalfWidth{0.0};      // in map pixels, for TRAIL_WIDTH on screen
+    bool m_trailDirty{true};           // new node or colour: rebuild regardless of the revision
+};
@@ -0,0 +1,54 @@
+#include "MapStore.h"
+#include <cstring>
+
+namespace Spider2 {
+
+void MapStore::reset(int sizePixels)
+{
+    m_size = sizePixels;
+    m_columns = mapTileColumns(sizePixels);
+    m_chunks.assign(static_cast<size_t>(m_columns) * static_cast<size_t>(m_columns), MapChunkPtr());
+    m_chunkCount = 0;
+}
+
+void MapStore::setChunk(int column, int row, MapChunkPtr chunk)
+{
+    MapChunkPtr &slot = m_chunks[static_cast<size_t>(row) * static_cast<size_t>(m_columns) + static_cast<size_t>(column)];
+    if (slot && !chunk)
+        --m_chunkCount;
+    else if (!slot && chunk)
+        ++m_chunkCount;
+    slot = std::move(chunk);
+}
+
+uint8_t MapStore::cellAt(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_size || y >= m_size)
+        return MAP_UNKNOWN;
+    const MapChunkPtr &stored = chunk(x / MAP_TILE_SIZE, y / MAP_TILE_SIZE);
+    if (!stored)
+        return MAP_UNKNOWN;
+    return stored->cells[static_cast<size_t>(y % MAP_TILE_SIZE) * MAP_TILE_SIZE + static_cast<size_t>(x % MAP_TILE_SIZE)];
+}
+
+size_t MapStore::memoryBytes() const
+{
+    return m_chunkCount * sizeof(MapChunk) + m_chunks.capacity() * sizeof(MapChunkPtr);
+}
+
+bool MapStore::isUnknown(const MapChunk &chunk)
+{
+    return std::memcmp(chunk.cells.data(), unknownChunk().cells.data(), chunk.cells.size()) == 0;
+}
+
+const MapChunk &MapStore::unknownChunk()
+{
+    static const MapChunk unknown = []() {
+        MapChunk chunk;
+        chunk.cells.fill(MAP_UNKNOWN);
+        return chunk;
+    }();
+    return unknown;
+}
+
+} // namespace Spider2
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MapTiles.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Sparse 8-bit occupancy grid, stored in MAP_TILE_SIZE² chunks
+ *
+ * Only tiles with at least one known cell (anything but MAP_UNKNOWN) have a
+ * chunk; the rest cost one null pointer. A building-scale 4096² map that is
+ * mostly unexplored therefore takes a fraction of its 16 MB dense size, and
+ * nothing is ever stored as 32-bit colour.
+ *
+ * Not thread-safe; chunks themselves are immutable and may be shared.
+ */
+class MapStore
+{
+public:
+    /// @brief Drop every chunk and start over as a sizePixels² grid of unknown cells
+    void reset(int sizePixels);
+
+    int size() const { return m_size; }
+    int columns() const { return m_columns; }
+
+    /// @brief nullptr when every cell of the tile is unknown
+    const MapChunkPtr &chunk(int column, int row) const
+    {
+        return m_chunks[static_cast<size_t>(row) * static_cast<size_t>(m_columns) + static_cast<size_t>(column)];
+    }
+    void setChunk(int column, int row, MapChunkPtr chunk);
+
+    /// @brief Cell at (x, y); MAP_UNKNOWN where nothing is stored, and outside the grid
+    uint8_t cellAt(int x, int y) const;
+
+    size_t chunkCount() const { return m_chunkCount; }
+    /// @brief Chunks plus the chunk table; a chunk shared with another store is counted by both
+    size_t memoryBytes() const;
+    /// @brief What the same grid takes as one dense 8-bit buffer
+    size_t denseBytes() const { return static_cast<size_t>(m_size) * static_cast<size_t>(m_size); }
+
+    static bool isUnknown(const MapChunk &chunk);
+    /// @brief A chunk of MAP_UNKNOWN cells, to compare or copy from
+    static const MapChunk &unknownChunk();
+
+private:
+    int m_size{0};
+    int m_columns{0};
+    std::vector<MapChunkPtr> m_chunks;
+    size_t m_chunkCount{0};
+};
+
+} // namespace Spider2
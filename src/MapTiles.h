@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Spider2 {
+
+/// @brief Edge length in map pixels of the squares the SLAM map is diffed, stored and uploaded in
+constexpr int MAP_TILE_SIZE = 256;
+
+/// @brief BreezySLAM's value for cells nothing is known about; never stored
+constexpr uint8_t MAP_UNKNOWN = 127;
+
+/// @brief Tiles per row (and per column) of a sizePixels² map; edge tiles are clipped
+inline int mapTileColumns(int sizePixels)
+{
+    return (sizePixels + MAP_TILE_SIZE - 1) / MAP_TILE_SIZE;
+}
+
+/**
+ * @brief Levels of the map pyramid: level 0 is the map itself, each further
+ * level half the edge length of the one before, down to a single tile
+ */
+inline int mapLevelCount(int sizePixels)
+{
+    int levels = 1;
+    for (; sizePixels > MAP_TILE_SIZE; sizePixels = (sizePixels + 1) / 2)
+        ++levels;
+    return levels;
+}
+
+/// @brief Edge length in cells of pyramid @p level; one cell there covers 2^level map pixels
+inline int mapLevelSize(int sizePixels, int level)
+{
+    for (; level > 0; --level)
+        sizePixels = (sizePixels + 1) / 2;
+    return sizePixels;
+}
+
+/**
+ * @brief The 8-bit cells of one tile, row-major with a stride of MAP_TILE_SIZE
+ *
+ * Cells past the map edge are MAP_UNKNOWN. Chunks are immutable once shared:
+ * a changed tile gets a new chunk, so the colorizer, SlamController and the
+ * render thread can all hold the same one without copying or locking.
+ */
+struct MapChunk {
+    std::array<uint8_t, MAP_TILE_SIZE * MAP_TILE_SIZE> cells;
+};
+using MapChunkPtr = std::shared_ptr<const MapChunk>;
+
+/// @brief One changed tile: pyramid level, column / row in tiles of that level
+struct MapTile {
+    int column{0};
+    int row{0};
+    int level{0};
+    MapChunkPtr chunk;   ///< nullptr = every cell unknown
+};
+
+/**
+ * @brief What changed between two SLAM maps
+ *
+ * Holds the changed tiles of every pyramid level. @c reset means the grid
+ * was (re)started, e.g. because the map size changed: older tiles must be
+ * discarded, and tiles not included are unknown.
+ */
+struct MapTileUpdate {
+    int sizePixels{0};
+    double sizeMeters{0.0};
+    bool reset{false};
+    std::vector<MapTile> tiles;
+};
+
+} // namespace Spider2
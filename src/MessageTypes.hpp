@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 #include "command.pb.h"
 
 namespace Spider2 {
@@ -352,12 +354,14 @@ namespace MessageValidator {
             return false;
         }
         
-        // Validate angle and distance values
+        // Validate angle and distance values (no M_PI: this header is included
+        // ahead of any Qt/cmath header that would define it)
+        constexpr double pi = 3.14159265358979323846;
         for (int i = 0; i < angle_count; i++) {
             float angle = lidar.angles(i);
             float distance = lidar.distances(i);
             
-            if (angle < -M_PI || angle > M_PI) {
+            if (angle < -pi || angle > pi) {
                 return false;
             }
             
@@ -401,6 +405,173 @@ namespace MessageValidator {
     }
 }
 
+/**
+ * @brief Zero-copy views over encoded messages that carry large byte payloads
+ *
+ * Parsing a VideoFrame or SlamMap with the generated classes copies the whole
+ * JPEG / occupancy grid into a std::string. These helpers walk the wire format
+ * instead and return pointers into the caller's buffer, which must outlive the
+ * view.
+ */
+namespace MessageView {
+
+    /**
+     * @brief Iterates the top-level fields of an encoded protobuf message
+     *
+     * Length-delimited fields are not copied: offset()/length() locate them
+     * inside the original buffer. Groups are not supported (none are used
+     * by command.proto).
+     */
+    class WireFieldScanner {
+    public:
+        WireFieldScanner(const char *data, size_t size)
+            : m_input(reinterpret_cast<const uint8_t *>(data), static_cast<int>(size))
+            , m_size(size) {}
+
+        /**
+         * @brief Advance to the next field
+         * @return false at the end of the buffer or on malformed input
+         */
+        bool next() {
+            using google::protobuf::internal::WireFormatLite;
+            m_tag = m_input.ReadTag();
+            if (m_tag == 0) {
+                return false;
+            }
+            switch (WireFormatLite::GetTagWireType(m_tag)) {
+                case WireFormatLite::WIRETYPE_VARINT:
+                    return m_input.ReadVarint64(&m_value);
+                case WireFormatLite::WIRETYPE_FIXED64:
+                    return m_input.ReadLittleEndian64(&m_value);
+                case WireFormatLite::WIRETYPE_FIXED32: {
+                    uint32_t v = 0;
+                    if (!m_input.ReadLittleEndian32(&v)) return false;
+                    m_value = v;
+                    return true;
+                }
+                case WireFormatLite::WIRETYPE_LENGTH_DELIMITED: {
+                    uint32_t length = 0;
+                    if (!m_input.ReadVarint32(&length)) return false;
+                    m_offset = static_cast<size_t>(m_input.CurrentPosition());
+                    m_length = length;
+                    return m_input.Skip(static_cast<int>(length));
+                }
+                default:
+                    return false;
+            }
+        }
+
+        /// @brief True once every byte of the buffer has been consumed
+        bool atEnd() const { return static_cast<size_t>(m_input.CurrentPosition()) == m_size; }
+
+        int fieldNumber() const {
+            return google::protobuf::internal::WireFormatLite::GetTagFieldNumber(m_tag);
+        }
+        uint64_t value() const { return m_value; }
+        double doubleValue() const {
+            return google::protobuf::internal::WireFormatLite::DecodeDouble(m_value);
+        }
+        size_t offset() const { return m_offset; }
+        size_t length() const { return m_length; }
+
+    private:
+        google::protobuf::io::CodedInputStream m_input;
+        size_t m_size{0};
+        uint32_t m_tag{0};
+        uint64_t m_value{0};
+        size_t m_offset{0};
+        size_t m_length{0};
+    };
+
+    /**
+     * @brief Borrowed view of an encoded VideoFrame
+     */
+    struct VideoFrameView {
+        int64_t timestamp{0};
+        int32_t width{0};
+        int32_t height{0};
+        const char *jpeg{nullptr};   ///< Points into the encoded buffer
+        size_t jpegSize{0};
+    };
+
+    /**
+     * @brief Borrowed view of an encoded SlamMap
+     */
+    struct SlamMapView {
+        int64_t timestamp{0};
+        int32_t sizePixels{0};
+        double sizeMeters{0.0};
+        const char *cells{nullptr};  ///< Points into the encoded buffer
+        size_t cellCount{0};
+    };
+
+    /**
+     * @brief Parse a VideoFrame without copying its JPEG payload
+     * @return false if the buffer is malformed or a required field is missing
+     */
+    inline bool parseVideoFrame(const char *data, size_t size, VideoFrameView *out) {
+        WireFieldScanner scanner(data, size);
+        unsigned seen = 0;
+        while (scanner.next()) {
+            switch (scanner.fieldNumber()) {
+                case Command::VideoFrame::kTimestampFieldNumber:
+                    out->timestamp = static_cast<int64_t>(scanner.value());
+                    seen |= 1u;
+                    break;
+                case Command::VideoFrame::kDataFieldNumber:
+                    out->jpeg = data + scanner.offset();
+                    out->jpegSize = scanner.length();
+                    seen |= 2u;
+                    break;
+                case Command::VideoFrame::kWidthFieldNumber:
+                    out->width = static_cast<int32_t>(scanner.value());
+                    seen |= 4u;
+                    break;
+                case Command::VideoFrame::kHeightFieldNumber:
+                    out->height = static_cast<int32_t>(scanner.value());
+                    seen |= 8u;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return scanner.atEnd() && seen == 0xFu;
+    }
+
+    /**
+     * @brief Parse a SlamMap without copying its occupancy grid
+     * @return false if the buffer is malformed or a required field is missing
+     */
+    inline bool parseSlamMap(const char *data, size_t size, SlamMapView *out) {
+        WireFieldScanner scanner(data, size);
+        unsigned seen = 0;
+        while (scanner.next()) {
+            switch (scanner.fieldNumber()) {
+                case Command::SlamMap::kTimestampFieldNumber:
+                    out->timestamp = static_cast<int64_t>(scanner.value());
+                    seen |= 1u;
+                    break;
+                case Command::SlamMap::kSizePixelsFieldNumber:
+                    out->sizePixels = static_cast<int32_t>(scanner.value());
+                    seen |= 2u;
+                    break;
+                case Command::SlamMap::kSizeMetersFieldNumber:
+                    out->sizeMeters = scanner.doubleValue();
+                    seen |= 4u;
+                    break;
+                case Command::SlamMap::kDataFieldNumber:
+                    out->cells = data + scanner.offset();
+                    out->cellCount = scanner.length();
+                    seen |= 8u;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return scanner.atEnd() && seen == 0xFu;
+    }
+}
+
 /**
  * @brief Message utility functions
  */
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace Spider2 {
+
+/**
+ * @brief Unbounded multi-producer / single-consumer queue (Vyukov)
+ *
+ * push() is wait-free apart from the node allocation: one atomic exchange
+ * plus one store. tryPop() may only be called from a single thread. While a
+ * push is half-way through, the consumer can briefly see the queue as empty;
+ * producers therefore signal the consumer only after push() has returned.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+    {
+        Node *stub = new Node;
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+
+    ~MpscQueue()
+    {
+        T discard;
+        while (tryPop(discard)) {}
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /// @brief Any thread
+    void push(T value)
+    {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /// @brief Consumer thread only. Returns false when empty.
+    bool tryPop(T &out)
+    {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        // next becomes the new stub; its value has been handed out
+        out = std::move(next->value);
+        next->value = T();
+        m_tail = next;
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<Node*> m_head{nullptr};   // last pushed, shared by producers
+    alignas(CACHE_LINE) Node *m_tail{nullptr};                // consumer-private
+};
+
+} // namespace Spider2
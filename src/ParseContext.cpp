@@ -0,0 +1,51 @@
+#include "ParseContext.h"
+
+namespace Spider2 {
+
+ParseContext &ParseContext::local()
+{
+    thread_local ParseContext context;
+    return context;
+}
+
+template <typename T>
+const T *ParseContext::parse(T &message, const char *data, size_t size)
+{
+    message.Clear();
+    if (!message.ParseFromArray(data, static_cast<int>(size))) {
+        return nullptr;
+    }
+    return &message;
+}
+
+const Command::TelemetryUpdate *ParseContext::parseTelemetry(const char *data, size_t size)
+{
+    return parse(m_telemetry, data, size);
+}
+
+const Command::LidarData *ParseContext::parseLidar(const char *data, size_t size)
+{
+    return parse(m_lidar, data, size);
+}
+
+const Command::GyroData *ParseContext::parseGyro(const char *data, size_t size)
+{
+    return parse(m_gyro, data, size);
+}
+
+const Command::SlamPose *ParseContext::parseSlamPose(const char *data, size_t size)
+{
+    return parse(m_slamPose, data, size);
+}
+
+const Command::BlobTrackingData *ParseContext::parseBlob(const char *data, size_t size)
+{
+    return parse(m_blob, data, size);
+}
+
+const Command::Heartbeat *ParseContext::parseHeartbeat(const char *data, size_t size)
+{
+    return parse(m_heartbeat, data, size);
+}
+
+} // namespace Spider2
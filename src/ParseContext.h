@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include "command.pb.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Per-thread set of reusable protobuf messages for the receive hot path
+ *
+ * Every inbound message type gets one long-lived instance per thread that is
+ * cleared and re-parsed for each frame. Clear() keeps the capacity of repeated
+ * fields and non-oneof strings, so once the instances have grown to the
+ * stream's steady-state size parsing no longer touches the heap.
+ *
+ * Oneof string values (TelemetryUpdate.svalue) are released by Clear(), so
+ * only values longer than the small-string buffer still allocate. Whether
+ * the ingest threads really stop allocating is measured by
+ * AllocationCounter.
+ *
+ * Returned pointers stay valid until the next parse of the same type on the
+ * same thread.
+ */
+class ParseContext
+{
+public:
+    /// @brief The calling thread's context
+    static ParseContext &local();
+
+    const Command::TelemetryUpdate *parseTelemetry(const char *data, size_t size);
+    const Command::LidarData *parseLidar(const char *data, size_t size);
+    const Command::GyroData *parseGyro(const char *data, size_t size);
+    const Command::SlamPose *parseSlamPose(const char *data, size_t size);
+    const Command::BlobTrackingData *parseBlob(const char *data, size_t size);
+    const Command::Heartbeat *parseHeartbeat(const char *data, size_t size);
+
+private:
+    template <typename T>
+    static const T *parse(T &message, const char *data, size_t size);
+
+    Command::TelemetryUpdate m_telemetry;
+    Command::LidarData m_lidar;
+    Command::GyroData m_gyro;
+    Command::SlamPose m_slamPose;
+    Command::BlobTrackingData m_blob;
+    Command::Heartbeat m_heartbeat;
+};
+
+} // namespace Spider2
@@ -0,0 +1,129 @@
+#include "PoseTrail.h"
+#include <algorithm>
+#include <utility>
+
+namespace Spider2 {
+
+namespace {
+
+float squaredDistanceToSegment(const PoseTrail::Point &p, const PoseTrail::Point &a, const PoseTrail::Point &b)
+{
+    const float dx = b.x_mm - a.x_mm;
+    const float dy = b.y_mm - a.y_mm;
+    const float lengthSquared = dx * dx + dy * dy;
+    float t = 0.0f;
+    if (lengthSquared > 0.0f)
+        t = std::clamp(((p.x_mm - a.x_mm) * dx + (p.y_mm - a.y_mm) * dy) / lengthSquared, 0.0f, 1.0f);
+    const float ex = a.x_mm + t * dx - p.x_mm;
+    const float ey = a.y_mm + t * dy - p.y_mm;
+    return ex * ex + ey * ey;
+}
+
+} // namespace
+
+PoseTrail::PoseTrail(size_t recentCapacity, size_t historyCapacity, float toleranceMm)
+    : m_recentCapacity(std::max(recentCapacity, BLOCK))
+    , m_historyCapacity(historyCapacity)
+    , m_tolerance(toleranceMm)
+    , m_historyTolerance(toleranceMm)
+{
+    m_recent.reserve(m_recentCapacity + BLOCK);
+}
+
+bool PoseTrail::append(float x_mm, float y_mm)
+{
+    if (!m_recent.empty()) {
+        const float dx = x_mm - m_recent.back().x_mm;
+        const float dy = y_mm - m_recent.back().y_mm;
+        if (dx * dx + dy * dy < MIN_STEP_MM * MIN_STEP_MM)
+            return false;
+    }
+    m_recent.push_back(Point{x_mm, y_mm});
+    ++m_revision;
+
+    if (m_recent.size() >= m_recentCapacity + BLOCK) {
+        // The oldest BLOCK poses plus the one after, so the simplified line ends where recent() starts
+        const std::vector<Point> kept = simplify(m_recent.data(), BLOCK + 1, m_historyTolerance);
+        m_history.insert(m_history.end(), kept.begin(), kept.end() - 1);
+        m_recent.erase(m_recent.begin(), m_recent.begin() + static_cast<std::ptrdiff_t>(BLOCK));
+        compactHistory();
+    }
+    return true;
+}
+
+void PoseTrail::restore(const std::vector<Point> &points)
+{
+    clear();
+    if (points.empty())
+        return;
+    // Restored points are old by definition; only the last one starts the recent window
+    m_history.assign(points.begin(), points.end() - 1);
+    m_recent.push_back(points.back());
+    compactHistory();
+    ++m_revision;
+}
+
+void PoseTrail::clear()
+{
+    m_history.clear();
+    m_recent.clear();
+    m_historyTolerance = m_tolerance;
+    ++m_revision;
+}
+
+std::vector<PoseTrail::Point> PoseTrail::points() const
+{
+    std::vector<Point> all;
+    all.reserve(size());
+    all.insert(all.end(), m_history.begin(), m_history.end());
+    all.insert(all.end(), m_recent.begin(), m_recent.end());
+    return all;
+}
+
+void PoseTrail::compactHistory()
+{
+    while (m_history.size() > m_historyCapacity) {
+        m_historyTolerance *= 2.0f;
+        m_history = simplify(m_history.data(), m_history.size(), m_historyTolerance);
+    }
+}
+
+std::vector<PoseTrail::Point> PoseTrail::simplify(const Point *line, size_t count, float tolerance)
+{
+    if (count <= 2)
+        return std::vector<Point>(line, line + count);
+
+    // Iterative Douglas–Peucker: split each span at its farthest point until all are within tolerance
+    std::vector<bool> keep(count, false);
+    keep.front() = true;
+    keep.back() = true;
+    const float toleranceSquared = tolerance * tolerance;
+    std::vector<std::pair<size_t, size_t>> spans{{0, count - 1}};
+    while (!spans.empty()) {
+        const auto [first, last] = spans.back();
+        spans.pop_back();
+        float farthest = toleranceSquared;
+        size_t split = 0;
+        for (size_t i = first + 1; i < last; ++i) {
+            const float distance = squaredDistanceToSegment(line[i], line[first], line[last]);
+            if (distance > farthest) {
+                farthest = distance;
+                split = i;
+            }
+        }
+        if (split) {
+            keep[split] = true;
+            spans.emplace_back(first, split);
+            spans.emplace_back(split, last);
+        }
+    }
+
+    std::vector<Point> kept;
+    for (size_t i = 0; i < count; ++i) {
+        if (keep[i])
+            kept.push_back(line[i]);
+    }
+    return kept;
+}
+
+} // namespace Spider2
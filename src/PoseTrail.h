@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Spider2 {
+
+/**
+ * @brief Where the robot has been, in bounded memory
+ *
+ * The newest poses are kept at full rate. Once more than recentCapacity have
+ * piled up, the oldest BLOCK of them is simplified with Douglas–Peucker
+ * (points closer than the tolerance to the simplified line are dropped) and
+ * moved to the history. Should the history outgrow historyCapacity, the
+ * tolerance doubles and the whole history is simplified again, so older
+ * parts of a long run get coarser while the trail never exceeds
+ * recentCapacity + BLOCK + historyCapacity points.
+ *
+ * Poses closer than MIN_STEP_MM to the previous one are not kept: a robot
+ * standing still does not push its recent path out of the full-rate window.
+ */
+class PoseTrail
+{
+public:
+    struct Point {
+        float x_mm{0.0f};
+        float y_mm{0.0f};
+    };
+
+    explicit PoseTrail(size_t recentCapacity = 512, size_t historyCapacity = 4096, float toleranceMm = 10.0f);
+
+    /// @return false when the pose was too close to the previous one to be kept
+    bool append(float x_mm, float y_mm);
+    /// @brief Replace the trail with @p points (oldest first), e.g. one restored from disk
+    void restore(const std::vector<Point> &points);
+    void clear();
+
+    /// @brief Simplified part, oldest first; recent() continues from its last point
+    const std::vector<Point> &history() const { return m_history; }
+    /// @brief Full-rate part, oldest first
+    const std::vector<Point> &recent() const { return m_recent; }
+    size_t size() const { return m_history.size() + m_recent.size(); }
+    /// @brief Every point, oldest first
+    std::vector<Point> points() const;
+
+    /// @brief Distance the history is currently simplified to
+    float historyToleranceMm() const { return m_historyTolerance; }
+    /// @brief Changes whenever the points do
+    uint64_t revision() const { return m_revision; }
+
+    /// @brief Poses moved to the history at a time
+    static constexpr size_t BLOCK = 64;
+    static constexpr float MIN_STEP_MM = 5.0f;
+
+    /// @brief Douglas–Peucker: the points of @p line (endpoints always) needed to stay within @p tolerance
+    static std::vector<Point> simplify(const Point *line, size_t count, float tolerance);
+
+private:
+    void compactHistory();
+
+    size_t m_recentCapacity;
+    size_t m_historyCapacity;
+    float m_tolerance;
+    float m_historyTolerance;
+    std::vector<Point> m_history;
+    std::vector<Point> m_recent;
+    uint64_t m_revision{0};
+};
+
+} // namespace Spider2
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Spider2 {
+
+/**
+ * @brief One received [type][payload] frame pair that borrows its payload bytes
+ *
+ * The payload is never copied out of the transport buffer. @c owner keeps the
+ * underlying storage (the zmq::message_t on the live link) alive for as long
+ * as this frame, or any QByteArray::fromRawData() view built on top of it,
+ * still references the bytes.
+ */
+struct RawFrame {
+    uint8_t type{0};
+    const char *data{nullptr};
+    size_t size{0};
+    std::shared_ptr<const void> owner;
+    int64_t receivedUs{0};   ///< Local wall clock (µs since epoch) when the transport handed it over
+};
+
+} // namespace Spider2
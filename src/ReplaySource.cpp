@@ -0,0 +1,241 @@
+#include "ReplaySource.h"
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include "ThreadName.h"
+
+namespace Spider2 {
+
+namespace {
+
+int64_t wallClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t steadyUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Longest single sleep, so stop() and speed changes take effect promptly
+constexpr int64_t MAX_SLEEP_US = 2000;
+// Frames due this soon go out now; sleeping for less costs more than it buys
+constexpr int64_t PACING_SLACK_US = 500;
+
+} // namespace
+
+ReplaySource::~ReplaySource()
+{
+    stop();
+}
+
+void ReplaySource::start(IngestPipeline *pipeline, double speed, FinishedCallback onFinished, int64_t fromUs)
+{
+    stop();
+
+    m_pipeline = pipeline;
+    m_fromUs = fromUs;
+    m_onFinished = std::move(onFinished);
+    setSpeed(speed);
+    m_frames.store(0, std::memory_order_relaxed);
+    m_bytes.store(0, std::memory_order_relaxed);
+    m_positionUs.store(std::max(fromUs, m_reader.startUs()), std::memory_order_relaxed);
+    m_startedUs.store(steadyUs(), std::memory_order_relaxed);
+    m_elapsedUs.store(0, std::memory_order_relaxed);
+    m_seekUs.store(0, std::memory_order_relaxed);
+    m_finished.store(false, std::memory_order_relaxed);
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&ReplaySource::run, this);
+}
+
+void ReplaySource::stop()
+{
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ReplaySource::setSpeed(double speed)
+{
+    m_speed.store(std::max(0.0, speed), std::memory_order_relaxed);
+}
+
+ReplaySource::Stats ReplaySource::stats() const
+{
+    Stats s;
+    s.frames = m_frames.load(std::memory_order_relaxed);
+    s.bytes = m_bytes.load(std::memory_order_relaxed);
+    s.positionUs = m_positionUs.load(std::memory_order_relaxed);
+    s.seekUs = m_seekUs.load(std::memory_order_relaxed);
+    s.finished = m_finished.load(std::memory_order_acquire);
+    s.elapsedUs = s.finished ? m_elapsedUs.load(std::memory_order_relaxed)
+                             : steadyUs() - m_startedUs.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool ReplaySource::waitUntil(int64_t dueUs)
+{
+    while (m_running.load(std::memory_order_acquire)) {
+        const int64_t remaining = dueUs - steadyUs();
+        if (remaining <= PACING_SLACK_US)
+            return true;
+        // Parked KEEP_LATEST frames still get their retry while we wait
+        m_pipeline->flush();
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min(remaining, MAX_SLEEP_US)));
+    }
+    return false;
+}
+
+bool ReplaySource::pushLossless(RawFrame &&frame)
+{
+    // One frame at a time for KEEP_LATEST streams, or the queue keeps only the last
+    const bool keepLatest = m_pipeline->policy(IngestPipeline::streamFor(frame.type)) == DropPolicy::KEEP_LATEST;
+    while (keepLatest ? m_pipeline->pendingFrames() > 0 : !m_pipeline->canAccept(frame.type)) {
+        if (!m_running.load(std::memory_order_acquire))
+            return false;
+        m_pipeline->flush();
+        std::this_thread::yield();
+    }
+    frame.receivedUs = wallClockUs();
+    m_pipeline->push(std::move(frame));
+    return true;
+}
+
+size_t ReplaySource::restore(int64_t targetUs)
+{
+    std::vector<RawFrame> frames;
+    int64_t baseUs = std::numeric_limits<int64_t>::min();
+    size_t next = 0;
+
+    const size_t keyframe = m_reader.findKeyframe(targetUs);
+    if (keyframe < m_reader.chunkCount() && m_reader.readChunk(keyframe, frames)) {
+        baseUs = m_reader.chunk(keyframe).lastUs;
+        next = keyframe + 1;
+    }
+
+    // Everything recorded after the keyframe, up to the target
+    for (size_t chunk = next; chunk < m_reader.chunkCount() && m_reader.chunk(chunk).firstUs <= targetUs; ++chunk) {
+        if (m_reader.isKeyframe(chunk))
+            continue;
+        const size_t first = frames.size();
+        m_reader.readChunk(chunk, frames);
+        frames.erase(std::remove_if(frames.begin() + first, frames.end(), [baseUs, targetUs](const RawFrame &f) {
+                         return f.receivedUs <= baseUs || f.receivedUs > targetUs;
+                     }), frames.end());
+    }
+
+    // Only the newest frames of each type make up the state
+    std::vector<bool> keep(frames.size(), true);
+    if (!m_policy.isEmpty()) {
+        std::array<uint32_t, 32> kept{};
+        for (size_t i = frames.size(); i-- > 0;) {
+            const uint8_t type = frames[i].type;
+            const uint32_t depth = m_policy.depthOf(type);
+            if (depth == KeyframePolicy::PER_NAME)
+                continue;   // every metric; coalesced per name when published
+            keep[i] = type < kept.size() && kept[type] < depth;
+            if (keep[i])
+                ++kept[type];
+        }
+    }
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (keep[i] && !pushLossless(std::move(frames[i])))
+            return m_reader.chunkCount();
+    }
+    while (m_pipeline->pendingFrames() > 0 && m_running.load(std::memory_order_acquire)) {
+        m_pipeline->flush();
+        std::this_thread::yield();
+    }
+    return m_reader.findChunk(targetUs);
+}
+
+void ReplaySource::run()
+{
+    setCurrentThreadName("s2-replay");
+    const int64_t startedUs = m_startedUs.load(std::memory_order_relaxed);
+
+    size_t firstChunk = 0;
+    int64_t skipUntilUs = std::numeric_limits<int64_t>::min();
+    if (m_fromUs > m_reader.startUs()) {
+        firstChunk = restore(m_fromUs);
+        skipUntilUs = m_fromUs;
+        m_seekUs.store(steadyUs() - startedUs, std::memory_order_relaxed);
+    }
+
+    // Recorded time ↔ steady time; re-anchored whenever the speed changes
+    int64_t anchorRecordedUs = m_positionUs.load(std::memory_order_relaxed);
+    int64_t anchorSteadyUs = steadyUs();
+    double anchorSpeed = speed();
+
+    std::vector<RawFrame> frames;
+    for (size_t chunk = firstChunk; chunk < m_reader.chunkCount() && m_running.load(std::memory_order_acquire); ++chunk) {
+        // Keyframes repeat earlier frames; they are only for seeking
+        if (m_reader.isKeyframe(chunk))
+            continue;
+
+        frames.clear();
+        if (!m_reader.readChunk(chunk, frames)) {
+            qWarning() << "[REPLAY] Skipping unreadable chunk" << chunk;
+        }
+
+        for (RawFrame &frame : frames) {
+            if (frame.receivedUs <= skipUntilUs)
+                continue;
+
+            const double currentSpeed = speed();
+            if (currentSpeed != anchorSpeed) {
+                anchorRecordedUs = m_positionUs.load(std::memory_order_relaxed);
+                anchorSteadyUs = steadyUs();
+                anchorSpeed = currentSpeed;
+            }
+
+            if (currentSpeed > 0.0) {
+                const auto offsetUs = static_cast<int64_t>((frame.receivedUs - anchorRecordedUs) / currentSpeed);
+                if (!waitUntil(anchorSteadyUs + offsetUs))
+                    break;
+            } else {
+                // Benchmark mode: back-pressure instead of drop policies
+                while (!m_pipeline->canAccept(frame.type)) {
+                    if (!m_running.load(std::memory_order_acquire))
+                        break;
+                    m_pipeline->flush();
+                    std::this_thread::yield();
+                }
+                if (!m_running.load(std::memory_order_acquire))
+                    break;
+            }
+
+            m_positionUs.store(frame.receivedUs, std::memory_order_relaxed);
+            m_frames.fetch_add(1, std::memory_order_relaxed);
+            m_bytes.fetch_add(frame.size, std::memory_order_relaxed);
+
+            frame.receivedUs = wallClockUs();
+            m_pipeline->push(std::move(frame));
+        }
+        m_pipeline->flush();
+    }
+
+    // Let the decode stages catch up, so the elapsed time covers the whole pipeline
+    while (m_running.load(std::memory_order_acquire) && m_pipeline->pendingFrames() > 0) {
+        m_pipeline->flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!m_running.load(std::memory_order_acquire))
+        return;
+
+    m_elapsedUs.store(steadyUs() - startedUs, std::memory_order_relaxed);
+    m_finished.store(true, std::memory_order_release);
+    if (m_onFinished)
+        m_onFinished();
+}
+
+} // namespace Spider2
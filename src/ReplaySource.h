@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include "IngestPipeline.h"
+#include "KeyframePolicy.h"
+#include "SessionReader.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Feeds a recorded session into an IngestPipeline in place of the ZMQ socket
+ *
+ * A replay thread takes the role of the receive thread: it walks the chunks
+ * of a memory-mapped SessionReader and push()es every frame, so recorded
+ * traffic goes through exactly the same decode, dispatch and publish path
+ * as live traffic.
+ *
+ * Pacing follows the recorded receive timestamps divided by the speed
+ * factor (1 = real time, N = N times faster). Speed 0 replays as fast as
+ * possible: instead of dropping, the thread waits for room in the stream's
+ * queue, so every recorded frame is decoded and the elapsed time measures
+ * the throughput of the whole client pipeline on real data.
+ *
+ * Playback can start anywhere: the nearest keyframe at or before the start
+ * time is applied, followed by whatever was recorded between it and the
+ * start time, trimmed to what the KeyframePolicy says makes up the state.
+ * These frames are pushed without pacing and without letting a KEEP_LATEST
+ * queue collapse them, then paced playback continues from the start time.
+ *
+ * Frames are restamped with the local time they are pushed, so parse, apply
+ * and present latencies describe this run. Network and total latencies
+ * compare against the robot clock of the recording and are not meaningful.
+ */
+class ReplaySource
+{
+public:
+    struct Stats {
+        uint64_t frames{0};
+        uint64_t bytes{0};
+        int64_t positionUs{0};      ///< Recorded receive time of the last frame pushed
+        int64_t elapsedUs{0};       ///< Wall time since start(); final once finished
+        int64_t seekUs{0};          ///< Time it took to restore the state at the start position
+        bool finished{false};
+    };
+
+    /// @brief Called on the replay thread after the last frame was taken by the pipeline
+    using FinishedCallback = std::function<void()>;
+
+    ReplaySource() = default;
+    ~ReplaySource();
+
+    ReplaySource(const ReplaySource &) = delete;
+    ReplaySource &operator=(const ReplaySource &) = delete;
+
+    bool open(const QString &path) { return m_reader.open(path); }
+    const SessionReader &reader() const { return m_reader; }
+
+    /// @brief Frames applied when starting mid-session; an empty policy applies every frame
+    void setKeyframePolicy(const KeyframePolicy &policy) { m_policy = policy; }
+
+    /**
+     * @brief Start playing on a thread of its own
+     * @param pipeline Receives the frames; must outlive stop()
+     * @param fromUs Recorded time to start at; at or before reader().startUs() plays from the beginning
+     */
+    void start(IngestPipeline *pipeline, double speed, FinishedCallback onFinished, int64_t fromUs = 0);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /// @brief Any thread; 0 = as fast as possible
+    void setSpeed(double speed);
+    double speed() const { return m_speed.load(std::memory_order_relaxed); }
+
+    Stats stats() const;
+
+private:
+    void run();
+    /// @brief Apply the state at @p targetUs; returns the chunk playback continues with
+    size_t restore(int64_t targetUs);
+    /// @brief Wait for queue room (and, for KEEP_LATEST streams, an empty pipeline), then push
+    bool pushLossless(RawFrame &&frame);
+    /// @brief Sleep until steady time @p dueUs; false when stopped meanwhile
+    bool waitUntil(int64_t dueUs);
+
+    SessionReader m_reader;
+    KeyframePolicy m_policy;
+    IngestPipeline *m_pipeline{nullptr};
+    int64_t m_fromUs{0};
+    FinishedCallback m_onFinished;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<double> m_speed{1.0};
+
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<int64_t> m_positionUs{0};
+    std::atomic<int64_t> m_startedUs{0};
+    std::atomic<int64_t> m_elapsedUs{0};
+    std::atomic<int64_t> m_seekUs{0};
+    std::atomic<bool> m_finished{false};
+};
+
+} // namespace Spider2
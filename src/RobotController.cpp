@@ -4,25 +4,52 @@
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QSettings>
+#include <QStandardPaths>
+#include <QDir>
+#include <QUrl>
+#include <algorithm>
 #include <zmq.hpp>
 #include <zmq_addon.hpp>
 #include "command.pb.h"
+#include "AllocationCounter.h"
+#include "ParseContext.h"
 #include "LidarDataModel.h"
 #include "GyroDataModel.h"
 #include "SlamController.h"
-#include "MapProvider.h"
-#include "VideoProvider.h"
+#include "VideoDecoder.h"
+#include "MapColorizer.h"
+#include "FramePublisher.h"
+#include "ThreadName.h"
+#include "LatencyMonitor.h"
+#include "ClockSync.h"
 
 RobotController::RobotController(QObject *parent)
+    : RobotController(nullptr, parent)
+{
+}
+
+RobotController::RobotController(std::shared_ptr<zmq::context_t> context, QObject *parent)
     : QObject(parent)
-    , m_context(std::make_unique<zmq::context_t>(1))
+    , m_context(context ? context : std::make_shared<zmq::context_t>(1))
+    , m_contextInjected(context != nullptr)
+    , m_recorder(std::make_unique<Spider2::SessionRecorder>())
+    , m_telemetryData(new TelemetryStore(this))
+    , m_latencyMonitor(new LatencyMonitor(this))
+    , m_clockSync(new ClockSync(this))
     , m_lidarController(new LidarController(this))
     , m_gyroController(new GyroController(this))
     , m_slamController(new SlamController(this))
     , m_heartbeatTimer(new QTimer(this))
 {
+    // Keys QML binds to before the robot first reports them
+    m_telemetryData->declare({"battery_voltage", "cpu_temperature", "status", "robot_state",
+                              "gyro_x", "gyro_y", "gyro_timestamp",
+                              "lidar_point_count", "lidar_timestamp",
+                              "bytes_received_per_sec", "messages_received_per_sec"});
+
     m_heartbeatTimer->setInterval(1000); // Send heartbeat every second
     connect(m_heartbeatTimer, &QTimer::timeout, this, &RobotController::sendHeartbeat);
+    connect(m_clockSync, &ClockSync::updated, this, &RobotController::applyClockOffset);
 
     m_streamHealthTimer = new QTimer(this);
     m_streamHealthTimer->setInterval(200);
@@ -35,11 +62,32 @@ RobotController::RobotController(QObject *parent)
     connect(m_statisticsTimer, &QTimer::timeout, this, &RobotController::updateDataStatistics);
     m_statisticsTimer->start();
 
+    // Replay progress for the scrubber; runs only while replaying
+    m_replayPositionTimer = new QTimer(this);
+    m_replayPositionTimer->setInterval(100);
+    connect(m_replayPositionTimer, &QTimer::timeout, this, &RobotController::updateReplayPosition);
+
+    // Results from the receive side are applied once per rendered frame
+    m_publisher = new FramePublisher([this](uint32_t dirty) { publishLatestState(dirty); }, this);
+
     loadRecentServerIps();
+
+    m_mapCache = std::make_unique<Spider2::MapCache>(Spider2::MapCache::defaultDirectory());
+    m_mapCacheTimer = new QTimer(this);
+    m_mapCacheTimer->setInterval(MAP_CACHE_SAVE_INTERVAL_MS);
+    connect(m_mapCacheTimer, &QTimer::timeout, this, &RobotController::saveMapCache);
+
+    // Show the last robot's map while the user connects; deferred so tools can turn remembering off first
+    QTimer::singleShot(0, this, [this]() {
+        if (m_rememberServers && !m_connected && !m_replay && !m_recentServerIps.isEmpty()) {
+            restoreMapCache(m_recentServerIps.first());
+        }
+    });
 }
 
 RobotController::~RobotController()
 {
+    stopReplay();
     disconnectFromRobot();
 }
 
@@ -159,16 +207,21 @@ void RobotController::setBodyRoll(float angle)
     }
 }
 
-void RobotController::setVideoProvider(VideoProvider *provider)
+void RobotController::setVideoDisplaySize(const QSize &size)
 {
-    m_videoProvider = provider;
+    if (m_videoDisplaySize != size) {
+        m_videoDisplaySize = size;
+        if (m_videoDecoder) {
+            m_videoDecoder->setTargetSize(size);
+        }
+        emit videoDisplaySizeChanged();
+    }
 }
 
-void RobotController::setMapProvider(MapProvider *provider)
+void RobotController::setPublishWindow(QQuickWindow *window)
 {
-    m_mapProvider = provider;
-    if (m_slamController)
-        m_slamController->setMapProvider(provider);
+    m_publisher->setWindow(window);
+    m_latencyMonitor->setWindow(window);
 }
 
 void RobotController::connectToRobot()
@@ -178,18 +231,34 @@ void RobotController::connectToRobot()
         return;
     }
 
+    stopReplay();
+
+    // A full endpoint (ipc://..., tcp://host:port) is used as given
+    const QString connectionString = m_serverIp.contains("://") ? m_serverIp : QString("tcp://%1:5555").arg(m_serverIp);
+
+    // inproc:// only reaches sockets of the same context: a robot hosted by whoever injected it
+    const bool inproc = connectionString.startsWith("inproc://");
+    if (inproc && !m_contextInjected) {
+        emit connectionError(QString("%1 is only reachable from inside the process that binds it").arg(connectionString));
+        return;
+    }
+
     try {
         m_socket = std::make_unique<zmq::socket_t>(*m_context, ZMQ_DEALER);
         m_socket->set(zmq::sockopt::linger, 0);
         
-        QString connectionString = QString("tcp://%1:5555").arg(m_serverIp);
         m_socket->connect(connectionString.toStdString());
         
         m_connected = true;
         resetStreamHealth();
+        m_clockSync->reset();
         emit connectedChanged();
         
-        addToRecentServerIps(m_serverIp);
+        if (m_rememberServers && !inproc) {
+            addToRecentServerIps(m_serverIp);
+            restoreMapCache(m_serverIp);
+            m_mapCacheTimer->start();
+        }
         startCommunicationThread();
         m_heartbeatTimer->start();
         
@@ -205,7 +274,12 @@ void RobotController::disconnectFromRobot()
 {
     if (m_connected) {
         m_heartbeatTimer->stop();
+        m_mapCacheTimer->stop();
         stopCommunicationThread();
+
+        // Nothing received before the disconnect may show up afterwards; the cache gets the map on screen
+        discardPendingState();
+        saveMapCache();
         
         if (m_socket) {
             m_socket->close();
@@ -261,13 +335,101 @@ void RobotController::sendStateChange(const QString &state)
 void RobotController::sendHeartbeat()
 {
     if (m_connected) {
-        auto heartbeat = Spider2::MessageFactory::createHeartbeat("spider2-gui");
+        const int64_t sentUs = LatencyMonitor::nowUs();
+        const int64_t timestamp = sentUs / 1000;
+        auto heartbeat = Spider2::MessageFactory::createHeartbeat("spider2-gui", timestamp);
+        m_clockSync->requestSent(timestamp, sentUs);
         sendMessage(Spider2::MessageType::HEARTBEAT, heartbeat);
     }
 }
 
+void RobotController::applyClockOffset()
+{
+    // ClockSync reports robot − local; the latency monitor wants local − robot
+    m_latencyMonitor->setClockOffsetUs(-m_clockSync->offsetUsAt(LatencyMonitor::nowUs()));
+}
+
+void RobotController::startIngest()
+{
+    // Video frames are decoded in parallel; results arrive newest-last on any decoder thread
+    // (delivery is serialized by the decoder, so they are a single writer)
+    m_videoDecoder = std::make_unique<VideoDecoder>([this](const QImage &image, qint64 timestamp, qint64 receivedUs) {
+        const LatencyStamp stamp{timestamp, m_latencyMonitor->parsed(Spider2::IngestStream::VIDEO, timestamp, receivedUs)};
+        m_videoUpdate.publish(VideoUpdate{image, timestamp, stamp});
+        m_publisher->markDirty(PUBLISH_VIDEO);
+    });
+    m_videoDecoder->setTargetSize(m_videoDisplaySize);
+    m_videoDecoder->start();
+
+    // SLAM maps are diffed and colorized per tile off the GUI thread; only changed tiles come back
+    m_mapColorizer = std::make_unique<MapColorizer>([this](Spider2::MapTileUpdate &&tiles, qint64 timestamp, qint64 receivedUs) {
+        const LatencyStamp stamp{timestamp, m_latencyMonitor->parsed(Spider2::IngestStream::SLAM_MAP, timestamp, receivedUs)};
+        m_slamMapUpdates.push(SlamMapUpdate{std::move(tiles), stamp});
+        m_publisher->markDirty(PUBLISH_SLAM_MAP);
+    });
+    // Diff against the map on screen (restored from the cache, or left by the last
+    // connection), so the first SLAM_MAP only brings the tiles that differ
+    m_publisher->publishNow();
+    m_mapColorizer->seed(m_slamController->mapSnapshot());
+    m_mapColorizer->start();
+
+    m_lidarHistory.clear();
+    m_lidarSequence = 0;
+    m_lidarAppliedSequence = 0;
+    m_lidarHistoryDepth = m_lidarController->mergeFrames();
+
+    // Decode stages first, so the receive thread has somewhere to put frames
+    m_pipeline = std::make_unique<Spider2::IngestPipeline>(
+        [this](Spider2::IngestStream stream, const std::vector<Spider2::RawFrame> &frames) {
+            // Everything a decode stage does per batch counts towards ingest_allocations_per_sec
+            const Spider2::AllocationCounter::Scope allocations;
+            if (stream == Spider2::IngestStream::GYRO) {
+                dispatchGyroBatch(frames.data(), frames.size());
+                return;
+            }
+            if (stream == Spider2::IngestStream::TELEMETRY) {
+                dispatchTelemetryBatch(frames.data(), frames.size());
+                return;
+            }
+            for (const auto &frame : frames)
+                dispatchMessage(frame);
+        });
+    for (auto it = m_dropPolicies.cbegin(); it != m_dropPolicies.cend(); ++it)
+        m_pipeline->setPolicy(it.key(), it.value());
+    m_pipeline->start();
+}
+
+void RobotController::stopIngest()
+{
+    if (m_pipeline) {
+        m_pipeline->stop();
+        m_pipeline.reset();
+    }
+    if (m_videoDecoder) {
+        m_videoDecoder->stop();
+        m_videoDecoder.reset();
+    }
+    if (m_mapColorizer) {
+        m_mapColorizer->stop();
+        m_mapColorizer.reset();
+    }
+}
+
 void RobotController::startCommunicationThread()
 {
+    startIngest();
+
+    // Outbound path: commands queue here and the poller is woken to send them
+    m_commandQueue = std::make_unique<Spider2::CommandQueue>();
+    const std::string wakeEndpoint = QString("inproc://spider2-commands-%1")
+        .arg(reinterpret_cast<quintptr>(this), 0, 16).toStdString();
+    m_wakeReceiver = std::make_unique<zmq::socket_t>(*m_context, ZMQ_PAIR);
+    m_wakeReceiver->bind(wakeEndpoint);
+    m_wakeSender = std::make_unique<zmq::socket_t>(*m_context, ZMQ_PAIR);
+    m_wakeSender->set(zmq::sockopt::linger, 0);
+    m_wakeSender->connect(wakeEndpoint);
+    m_wakePending = false;
+
     m_running = true;
     m_communicationThread = std::thread(&RobotController::communicationLoop, this);
 }
@@ -275,40 +437,51 @@ void RobotController::startCommunicationThread()
 void RobotController::stopCommunicationThread()
 {
     m_running = false;
+    wakeCommunicationThread();
     if (m_communicationThread.joinable()) {
         m_communicationThread.join();
     }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeSender.reset();
+    }
+    m_wakeReceiver.reset();
+    m_commandQueue.reset();
+    stopIngest();
 }
 
 void RobotController::communicationLoop()
 {
-    // Stream message types: only the LATEST received matters for display.
-    // When a backlog builds up, we drain all queued messages and throw away
-    // everything except the most recent one of each stream type.
-    auto isStream = [](uint8_t t) -> bool {
-        return t == static_cast<uint8_t>(Spider2::MessageType::LIDAR_DATA)
-            || t == static_cast<uint8_t>(Spider2::MessageType::GYRO_DATA)
-            || t == static_cast<uint8_t>(Spider2::MessageType::VIDEO_FRAME)
-            || t == static_cast<uint8_t>(Spider2::MessageType::TELEMETRY_UPDATE)
-            || t == static_cast<uint8_t>(Spider2::MessageType::SLAM_POSE)
-            || t == static_cast<uint8_t>(Spider2::MessageType::SLAM_MAP)
-            || t == static_cast<uint8_t>(Spider2::MessageType::OBJECT_TRACKING_DATA);
+    // This thread owns m_socket: it receives and demultiplexes, and sends
+    // whatever the other threads queued in m_commandQueue. Parsing and JPEG
+    // decoding happen on the pipeline's workers, and each stream's queue
+    // applies its own drop policy (stream types keep only the newest frame by default).
+    Spider2::setCurrentThreadName("s2-recv");
+    zmq::pollitem_t items[] = {
+        { *m_socket, 0, ZMQ_POLLIN, 0 },
+        { *m_wakeReceiver, 0, ZMQ_POLLIN, 0 }
     };
 
-    zmq::pollitem_t items[] = {{ *m_socket, 0, ZMQ_POLLIN, 0 }};
-
     while (m_running) {
         try {
-            // Block until at least one message arrives (or timeout for heartbeat check)
-            zmq::poll(items, 1, std::chrono::milliseconds(100));
-            if (!(items[0].revents & ZMQ_POLLIN)) continue;
+            // Block until a message arrives, a command is queued, or timeout
+            zmq::poll(items, 2, std::chrono::milliseconds(100));
 
-            // Drain ALL queued messages in one tight non-blocking loop.
-            // Stream messages: overwrite with latest (old frames simply discarded).
-            // Non-stream messages (heartbeat etc.): keep all in order.
-            std::unordered_map<uint8_t, std::string> latest;
-            std::vector<std::pair<uint8_t, std::string>> ordered;
+            if (items[1].revents & ZMQ_POLLIN) {
+                zmq::message_t wake;
+                while (m_wakeReceiver->recv(wake, zmq::recv_flags::dontwait)) {}
+                // Clear before draining: a push racing with the drain wakes us again
+                m_wakePending.store(false, std::memory_order_seq_cst);
+                sendPendingCommands();
+            }
+
+            if (!(items[0].revents & ZMQ_POLLIN)) {
+                m_pipeline->flush();
+                continue;
+            }
 
+            // Drain ALL queued messages in one tight non-blocking loop.
+            // Payloads stay in their zmq::message_t; frames only hold a reference.
             while (true) {
                 zmq::message_t type_msg;
                 if (!m_socket->recv(type_msg, zmq::recv_flags::dontwait)) break;
@@ -317,27 +490,24 @@ void RobotController::communicationLoop()
                 zmq::message_t data_msg;
                 if (!m_socket->recv(data_msg, zmq::recv_flags::dontwait)) break;
 
-                uint8_t t = *static_cast<const uint8_t*>(type_msg.data());
-                std::string d(static_cast<const char*>(data_msg.data()), data_msg.size());
+                auto payload = std::make_shared<zmq::message_t>(std::move(data_msg));
+                Spider2::RawFrame frame;
+                frame.type = *static_cast<const uint8_t*>(type_msg.data());
+                frame.data = static_cast<const char*>(payload->data());
+                frame.size = payload->size();
+                frame.owner = std::move(payload);
+                frame.receivedUs = LatencyMonitor::nowUs();
+                m_recorder->record(frame);
                 
                 // Track bytes and messages received for statistics
-                m_bytesReceivedCounter.fetch_add(d.size(), std::memory_order_relaxed);
+                m_bytesReceivedCounter.fetch_add(frame.size, std::memory_order_relaxed);
                 m_messagesReceivedCounter.fetch_add(1, std::memory_order_relaxed);
 
-                if (isStream(t)) {
-                    latest[t] = std::move(d);      // overwrite: keep only newest
-                } else {
-                    ordered.emplace_back(t, std::move(d));
-                }
+                m_pipeline->push(std::move(frame));
             }
 
-            // Process non-stream messages first (heartbeats, acks …)
-            for (auto &[t, d] : ordered)
-                dispatchMessage(t, d);
-
-            // Process one (the latest) message per stream type
-            for (auto &[t, d] : latest)
-                dispatchMessage(t, d);
+            // Retry anything that did not fit while the workers were busy
+            m_pipeline->flush();
 
         } catch (const zmq::error_t &e) {
             if (e.num() != ETERM)
@@ -345,84 +515,378 @@ void RobotController::communicationLoop()
             break;
         }
     }
+
+    // Last commands queued before disconnect (e.g. torque off)
+    try {
+        sendPendingCommands();
+    } catch (const zmq::error_t &e) {
+        qWarning() << "[ROBOT] Send error:" << e.what();
+    }
 }
 
 void RobotController::sendMessage(Spider2::MessageType type, const google::protobuf::Message &message)
 {
-    if (!m_connected || !m_socket) {
+    if (!m_connected || !m_commandQueue) {
         return;
     }
 
     try {
-        // Serialize protobuf message
+        // Serialize here; the communication thread only moves bytes
         std::string serialized;
         message.SerializeToString(&serialized);
-        
-        // Send message type first (DEALER socket automatically adds identity)
-        uint8_t type_byte = static_cast<uint8_t>(type);
-        zmq::message_t type_msg(&type_byte, 1);
-        m_socket->send(type_msg, zmq::send_flags::sndmore);
-        
-        // Send message data second
-        zmq::message_t data_msg(serialized.data(), serialized.size());
-        m_socket->send(data_msg, zmq::send_flags::dontwait);
-        
-    } catch (const zmq::error_t &e) {
-        qWarning() << "[ROBOT] Send error:" << e.what();
+        m_commandQueue->push(static_cast<uint8_t>(type), std::move(serialized));
+        wakeCommunicationThread();
     } catch (const std::exception &e) {
         qWarning() << "[ROBOT] Serialize error:" << e.what();
     }
 }
 
-void RobotController::dispatchMessage(uint8_t messageType, const std::string &rawData)
+void RobotController::wakeCommunicationThread()
+{
+    // Only the first push after a drain pays for the socket send
+    if (m_wakePending.exchange(true, std::memory_order_seq_cst)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    if (!m_wakeSender) {
+        return;
+    }
+    try {
+        zmq::message_t wake;
+        m_wakeSender->send(wake, zmq::send_flags::dontwait);
+    } catch (const zmq::error_t &e) {
+        qWarning() << "[ROBOT] Wake error:" << e.what();
+    }
+}
+
+void RobotController::sendPendingCommands()
+{
+    Spider2::OutboundCommand command;
+    while (m_commandQueue->tryPop(command)) {
+        // Type first, then data (DEALER socket automatically adds identity).
+        // Multipart messages are atomic, so once the first part is accepted
+        // the second one is too.
+        zmq::message_t type_msg(&command.type, 1);
+        if (!m_socket->send(type_msg, zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
+            m_commandsDroppedCounter.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        zmq::message_t data_msg(command.payload.data(), command.payload.size());
+        m_socket->send(data_msg, zmq::send_flags::dontwait);
+        m_commandsSentCounter.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RobotController::dispatchGyroBatch(const Spider2::RawFrame *frames, size_t count)
+{
+    // Every sample of the drain reaches the GUI, as one model update per frame
+    GyroBatch batch;
+    batch.readings.reserve(static_cast<qsizetype>(count));
+    auto &parser = Spider2::ParseContext::local();
+    for (size_t i = 0; i < count; ++i) {
+        const Spider2::RawFrame &frame = frames[i];
+        if (const Command::GyroData *gyro = parser.parseGyro(frame.data, frame.size)) {
+            qint64 ts = static_cast<qint64>(gyro->timestamp());
+            batch.stamp = LatencyStamp{ts, m_latencyMonitor->parsed(Spider2::IngestStream::GYRO, ts, frame.receivedUs)};
+            if (ts == 0) {
+                ts = QDateTime::currentMSecsSinceEpoch();
+            }
+            // Z-axis is not in the protocol; use 0.0
+            batch.readings.append(GyroReading(gyro->x(), gyro->y(), 0.0f, ts));
+        }
+    }
+    if (batch.readings.isEmpty()) {
+        return;
+    }
+    markGyroReceived();
+    m_gyroUpdates.push(std::move(batch));
+    m_publisher->markDirty(PUBLISH_GYRO);
+}
+
+void RobotController::dispatchTelemetryBatch(const Spider2::RawFrame *frames, size_t count)
+{
+    // Capture only the extracted name/value; the message is reused
+    std::vector<std::pair<QString, QVariant>> updates;
+    updates.reserve(count);
+    auto &parser = Spider2::ParseContext::local();
+    for (size_t i = 0; i < count; ++i) {
+        if (const Command::TelemetryUpdate *telemetry = parser.parseTelemetry(frames[i].data, frames[i].size)) {
+            updates.emplace_back(QString::fromStdString(telemetry->name()), telemetryValue(*telemetry));
+        }
+    }
+    if (updates.empty()) {
+        return;
+    }
+
+    // Newer values replace older ones of the same name until the GUI takes the set
+    uint64_t coalesced = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_telemetryMutex);
+        for (auto &update : updates) {
+            auto it = m_pendingTelemetry.find(update.first);
+            if (it != m_pendingTelemetry.end()) {
+                it.value() = std::move(update.second);
+                ++coalesced;
+            } else if (m_pendingTelemetry.size() < MAX_PENDING_TELEMETRY_NAMES) {
+                m_pendingTelemetry.insert(update.first, std::move(update.second));
+            } else {
+                ++coalesced;
+            }
+        }
+    }
+    if (coalesced) {
+        m_telemetryCoalescedCount.fetch_add(coalesced, std::memory_order_relaxed);
+    }
+    m_publisher->markDirty(PUBLISH_TELEMETRY);
+}
+
+bool RobotController::setStreamDropPolicy(const QString &stream, const QString &policy)
+{
+    Spider2::IngestStream ingestStream;
+    Spider2::DropPolicy dropPolicy;
+    if (!Spider2::IngestPipeline::streamFromName(stream.toStdString(), ingestStream)
+        || !Spider2::IngestPipeline::policyFromName(policy.toStdString(), dropPolicy)) {
+        qWarning() << "[ROBOT] Unknown stream or drop policy:" << stream << policy;
+        return false;
+    }
+
+    // Remembered so the policy survives reconnects
+    m_dropPolicies[ingestStream] = dropPolicy;
+    if (m_pipeline) {
+        m_pipeline->setPolicy(ingestStream, dropPolicy);
+    }
+    qInfo() << "[ROBOT] Drop policy for" << stream << "set to" << policy;
+    return true;
+}
+
+bool RobotController::startRecording(const QString &path, bool compress)
+{
+    QString filePath = path;
+    if (filePath.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/recordings";
+        QDir().mkpath(dir);
+        filePath = QString("%1/session-%2.s2rec").arg(dir, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    } else if (filePath.startsWith("file:")) {
+        filePath = QUrl(filePath).toLocalFile();
+    }
+
+    Spider2::SessionRecorder::Options options;
+    options.compress = compress;
+    options.keyframes = keyframePolicy();
+    const bool started = m_recorder->start(filePath, options);
+    emit recordingChanged();
+    return started;
+}
+
+void RobotController::stopRecording()
+{
+    if (m_recorder->isRecording()) {
+        m_recorder->stop();
+        emit recordingChanged();
+    }
+}
+
+bool RobotController::startReplay(const QString &path, double speed)
+{
+    if (m_connected) {
+        qWarning() << "[REPLAY] Disconnect before replaying a session";
+        return false;
+    }
+    stopReplay();
+
+    const QString filePath = path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+    auto replay = std::make_unique<Spider2::ReplaySource>();
+    if (!replay->open(filePath)) {
+        return false;
+    }
+
+    const Spider2::SessionReader &reader = replay->reader();
+    qInfo() << "[REPLAY]" << filePath << ":" << reader.frameCount() << "frames,"
+            << (reader.endUs() - reader.startUs()) / 1000000.0 << "s at speed" << speed;
+
+    if (reader.keyframeCount() == 0) {
+        qInfo() << "[REPLAY] Session has no keyframes; seeking replays from the start";
+    }
+
+    resetStreamHealth();
+    m_mapCacheServer.clear();   // replayed maps are not the cached robot's
+    // The session starts from nothing, not from what the last robot left on screen
+    m_lidarController->clearData();
+    m_gyroController->clearData();
+    m_slamController->clearData();
+    emit videoReset();
+    startIngest();
+    m_replay = std::move(replay);
+    m_replay->setKeyframePolicy(keyframePolicy());
+    setReplaySpeed(speed);
+    startReplayThread(0);
+    m_replayPositionTimer->start();
+    emit replayingChanged();
+    return true;
+}
+
+void RobotController::startReplayThread(int64_t fromUs)
+{
+    m_replayFramesReported = 0;
+    m_replay->start(m_pipeline.get(), m_replaySpeed, [this]() {
+        QMetaObject::invokeMethod(this, &RobotController::onReplayFinished, Qt::QueuedConnection);
+    }, fromUs);
+    updateReplayPosition();
+}
+
+void RobotController::seekReplay(double positionMs)
+{
+    if (!m_replay) {
+        return;
+    }
+    const Spider2::SessionReader &reader = m_replay->reader();
+    const int64_t targetUs = qBound(reader.startUs(), reader.startUs() + static_cast<int64_t>(positionMs * 1000.0),
+                                    reader.endUs());
+
+    // Drain the workers and apply what they finished, then start from a clean view
+    m_replay->stop();
+    stopIngest();
+    m_publisher->publishNow();
+    m_lidarController->clearData();
+    m_gyroController->clearData();
+    m_slamController->clearData();
+    emit videoReset();
+
+    startIngest();
+    startReplayThread(targetUs);
+    qInfo() << "[REPLAY] Seek to" << (targetUs - reader.startUs()) / 1000000.0 << "s";
+}
+
+void RobotController::updateReplayPosition()
+{
+    const double positionMs = m_replay
+        ? (m_replay->stats().positionUs - m_replay->reader().startUs()) / 1000.0 : 0.0;
+    if (!qFuzzyCompare(m_replayPositionMs + 1.0, positionMs + 1.0)) {
+        m_replayPositionMs = positionMs;
+        emit replayPositionChanged();
+    }
+}
+
+double RobotController::replayDurationMs() const
+{
+    return m_replay ? (m_replay->reader().endUs() - m_replay->reader().startUs()) / 1000.0 : 0.0;
+}
+
+Spider2::KeyframePolicy RobotController::keyframePolicy() const
+{
+    using Spider2::MessageType;
+    Spider2::KeyframePolicy policy;
+    policy.depth[static_cast<uint8_t>(MessageType::SLAM_MAP)] = 1;
+    policy.depth[static_cast<uint8_t>(MessageType::SLAM_POSE)] = 1;
+    policy.depth[static_cast<uint8_t>(MessageType::VIDEO_FRAME)] = 1;
+    policy.depth[static_cast<uint8_t>(MessageType::OBJECT_TRACKING_DATA)] = 1;
+    policy.depth[static_cast<uint8_t>(MessageType::LIDAR_DATA)] = static_cast<uint32_t>(m_lidarController->mergeFrames());
+    policy.depth[static_cast<uint8_t>(MessageType::GYRO_DATA)] = GyroDataModel::MAX_READINGS;
+    policy.depth[static_cast<uint8_t>(MessageType::TELEMETRY_UPDATE)] = Spider2::KeyframePolicy::PER_NAME;
+    return policy;
+}
+
+void RobotController::stopReplay()
+{
+    if (!m_replay) {
+        return;
+    }
+    m_replay->stop();
+    stopIngest();
+    discardPendingState();
+    m_replay.reset();
+    m_replayPositionTimer->stop();
+    updateReplayPosition();
+    resetStreamHealth();
+    emit replayingChanged();
+}
+
+void RobotController::setReplaySpeed(double speed)
+{
+    speed = qMax(0.0, speed);
+    if (m_replay) {
+        m_replay->setSpeed(speed);
+    }
+    if (!qFuzzyCompare(m_replaySpeed + 1.0, speed + 1.0)) {
+        m_replaySpeed = speed;
+        emit replaySpeedChanged();
+    }
+}
+
+void RobotController::onReplayFinished()
 {
-    // Handle VIDEO_FRAME specially (raw JPEG wrapped in protobuf)
+    if (!m_replay) {
+        return;
+    }
+    const Spider2::ReplaySource::Stats stats = m_replay->stats();
+    if (!stats.finished) {
+        return;
+    }
+
+    const double seconds = stats.elapsedUs / 1000000.0;
+    QVariantMap result;
+    result["frames"] = static_cast<qulonglong>(stats.frames);
+    result["bytes"] = static_cast<qulonglong>(stats.bytes);
+    result["seconds"] = seconds;
+    result["frames_per_sec"] = seconds > 0.0 ? stats.frames / seconds : 0.0;
+    result["mb_per_sec"] = seconds > 0.0 ? stats.bytes / seconds / (1024.0 * 1024.0) : 0.0;
+    result["speed"] = m_replaySpeed;
+    result["seek_ms"] = stats.seekUs / 1000.0;
+    qInfo() << "[REPLAY] Finished:" << stats.frames << "frames in" << seconds << "s ("
+            << result["frames_per_sec"].toDouble() << "frames/s," << result["mb_per_sec"].toDouble() << "MB/s)";
+
+    // Workers are joined by stopReplay(); then apply their last results
+    stopReplay();
+    m_publisher->publishNow();
+    emit replayFinished(result);
+}
+
+QString RobotController::streamDropPolicy(const QString &stream) const
+{
+    Spider2::IngestStream ingestStream;
+    if (!Spider2::IngestPipeline::streamFromName(stream.toStdString(), ingestStream)) {
+        return QString();
+    }
+    if (m_pipeline) {
+        return QString::fromLatin1(Spider2::IngestPipeline::policyName(m_pipeline->policy(ingestStream)));
+    }
+    const auto it = m_dropPolicies.constFind(ingestStream);
+    return it != m_dropPolicies.cend() ? QString::fromLatin1(Spider2::IngestPipeline::policyName(it.value()))
+                                       : QString();
+}
+
+void RobotController::dispatchMessage(const Spider2::RawFrame &frame)
+{
+    const uint8_t messageType = frame.type;
+
+    // Handle VIDEO_FRAME specially (raw JPEG wrapped in protobuf): hand the
+    // JPEG bytes to the parallel decoder, which keeps the receive buffer alive
     if (messageType == static_cast<uint8_t>(Spider2::MessageType::VIDEO_FRAME)) {
-        try {
-            Command::VideoFrame videoFrame;
-            const std::string &frameData = rawData;
-            
-            if (videoFrame.ParseFromString(frameData)) {
-                // Create QImage from JPEG data
-                QByteArray jpegData(videoFrame.data().data(), videoFrame.data().size());
-                QImage image = QImage::fromData(jpegData, "JPEG");
-                
-                if (!image.isNull()) {
-                    // Marshal frame update and counter increment to the GUI thread
-                    QMetaObject::invokeMethod(this, [this, image]() {
-                        if (m_videoProvider) {
-                            m_videoProvider->updateVideoFrame(image);
-                        }
-                        m_videoFrameIndex.fetch_add(1, std::memory_order_relaxed);
-                        emit videoFrameIndexChanged();
-                    }, Qt::QueuedConnection);
-                } else {
-                    qWarning() << "[VIDEO] Failed to decode JPEG data (" << jpegData.size() << "bytes)";
-                }
+        Spider2::MessageView::VideoFrameView videoFrame;
+        if (Spider2::MessageView::parseVideoFrame(frame.data, frame.size, &videoFrame)) {
+            if (m_videoDecoder) {
+                m_videoDecoder->submit(frame, videoFrame.jpeg, videoFrame.jpegSize,
+                                       static_cast<qint64>(videoFrame.timestamp));
             }
-            } catch (const std::exception &e) {
-            qWarning() << "[VIDEO] Error processing frame:" << e.what();
+        } else {
+            qWarning() << "[VIDEO] Malformed VideoFrame (" << frame.size << "bytes)";
         }
         return;
     }
     
-    // Process protobuf messages
-    const std::string &protobufData = rawData;
+    // Process protobuf messages (parsed in place from the receive buffer into
+    // this thread's reusable message instances, so parsing does not allocate;
+    // the updates built from them below still do)
+    Spider2::ParseContext &parser = Spider2::ParseContext::local();
     
     switch (static_cast<Spider2::MessageType>(messageType)) {
         case Spider2::MessageType::TELEMETRY_UPDATE: {
-            Command::TelemetryUpdate telemetry;
-            if (telemetry.ParseFromString(protobufData)) {
-                // Copy by value so the lambda captures a self-contained object
-                QMetaObject::invokeMethod(this, [this, telemetry]() {
-                    updateTelemetry(telemetry);
-                }, Qt::QueuedConnection);
-            }
+            dispatchTelemetryBatch(&frame, 1);
             break;
         }
         case Spider2::MessageType::LIDAR_DATA: {
-            Command::LidarData lidar;
-            if (lidar.ParseFromString(protobufData)) {
+            if (const Command::LidarData *lidarMsg = parser.parseLidar(frame.data, frame.size)) {
+                const Command::LidarData &lidar = *lidarMsg;
                 const int nPts = lidar.angles_size();
                 if (nPts >= 1 && nPts == lidar.distances_size()) {
                     // Collect valid points; zero/out-of-range distances mean no return
@@ -435,20 +899,24 @@ void RobotController::dispatchMessage(uint8_t messageType, const std::string &ra
                         }
                     }
 
+                    if (points.isEmpty()) {
+                        qWarning() << "[LIDAR] all" << nPts << "points filtered out";
+                    } else {
+                        markLidarReceived();
+                    }
                     const qint64 ts = static_cast<qint64>(lidar.timestamp());
-                    QMetaObject::invokeMethod(this, [this, points, ts, nPts]() {
-                        if (!points.isEmpty()) {
-                            m_lidarController->updateLidarData(points);
-                            markLidarReceived();
-                        } else {
-                            qWarning() << "[LIDAR] all" << nPts << "points filtered out";
-                        }
-                        QVariantMap lidarData;
-                        lidarData["timestamp"] = ts;
-                        lidarData["point_count"] = points.size();
-                        m_telemetryData["lidar"] = lidarData;
-                        emit telemetryDataChanged();
-                    }, Qt::QueuedConnection);
+                    const LatencyStamp stamp{ts, m_latencyMonitor->parsed(Spider2::IngestStream::LIDAR, ts, frame.receivedUs)};
+                    // The GUI blends the last revolutions; it may take only every few of these
+                    // (a seek restores all of them at once), so each carries the ones before it
+                    LidarUpdate update{std::move(points), ts, stamp, m_lidarSequence, m_lidarHistory};
+                    if (!update.points.isEmpty()) {
+                        update.sequence = ++m_lidarSequence;
+                        m_lidarHistory.append(update.points);
+                        while (m_lidarHistory.size() > m_lidarHistoryDepth - 1)
+                            m_lidarHistory.removeFirst();
+                    }
+                    m_lidarUpdate.publish(std::move(update));
+                    m_publisher->markDirty(PUBLISH_LIDAR);
                 } else {
                     qWarning() << "LIDAR: malformed message — angles:" << nPts
                                << "distances:" << lidar.distances_size();
@@ -459,38 +927,23 @@ void RobotController::dispatchMessage(uint8_t messageType, const std::string &ra
             break;
         }
         case Spider2::MessageType::GYRO_DATA: {
-            Command::GyroData gyro;
-            if (gyro.ParseFromString(protobufData)) {
-                const float gx = gyro.x();
-                const float gy = gyro.y();
-                const qint64 ts = static_cast<qint64>(gyro.timestamp());
-                QMetaObject::invokeMethod(this, [this, gx, gy, ts]() {
-                    // Z-axis is not in the protocol; use 0.0
-                    m_gyroController->updateGyroData(gx, gy, 0.0f, ts);
-                    markGyroReceived();
-                    QVariantMap gyroData;
-                    gyroData["timestamp"] = ts;
-                    gyroData["x"] = gx;
-                    gyroData["y"] = gy;
-                    m_telemetryData["gyro"] = gyroData;
-                    emit telemetryDataChanged();
-                }, Qt::QueuedConnection);
-            }
+            dispatchGyroBatch(&frame, 1);
             break;
         }
         case Spider2::MessageType::HEARTBEAT: {
+            const Command::Heartbeat *heartbeat = parser.parseHeartbeat(frame.data, frame.size);
+            if (heartbeat && heartbeat->timestamp() > 0) {
+                m_clockSync->replyReceived(heartbeat->timestamp(), frame.receivedUs);
+            }
             break;
         }
         case Spider2::MessageType::SLAM_POSE: {
-            Command::SlamPose slamPose;
-            if (slamPose.ParseFromString(protobufData)) {
-                const double x = slamPose.x_mm();
-                const double y = slamPose.y_mm();
-                const double theta = slamPose.theta_deg();
-                QMetaObject::invokeMethod(this, [this, x, y, theta]() {
-                    m_slamController->updatePose(x, y, theta);
-                    markSlamReceived();
-                }, Qt::QueuedConnection);
+            if (const Command::SlamPose *slamPose = parser.parseSlamPose(frame.data, frame.size)) {
+                const int64_t ts = slamPose->timestamp();
+                const LatencyStamp stamp{ts, m_latencyMonitor->parsed(Spider2::IngestStream::SLAM_POSE, ts, frame.receivedUs)};
+                m_slamPoseUpdate.publish(SlamPoseUpdate{slamPose->x_mm(), slamPose->y_mm(), slamPose->theta_deg(), stamp});
+                markSlamReceived();
+                m_publisher->markDirty(PUBLISH_SLAM_POSE);
             }
             break;
         }
@@ -503,31 +956,25 @@ void RobotController::dispatchMessage(uint8_t messageType, const std::string &ra
             break;
         }
         case Spider2::MessageType::SLAM_MAP: {
-            Command::SlamMap slamMap;
-            if (slamMap.ParseFromString(protobufData)) {
-                const int szPx = slamMap.size_pixels();
-                const double szM = slamMap.size_meters();
-                const std::string &raw = slamMap.data();
-                QByteArray data(raw.data(), static_cast<int>(raw.size()));
-                QMetaObject::invokeMethod(this, [this, szPx, szM, data]() {
-                    m_slamController->updateMap(szPx, szM, data);
-                    markSlamReceived();
-                }, Qt::QueuedConnection);
+            Spider2::MessageView::SlamMapView slamMap;
+            if (Spider2::MessageView::parseSlamMap(frame.data, frame.size, &slamMap)) {
+                const size_t cells = static_cast<size_t>(slamMap.sizePixels) * static_cast<size_t>(slamMap.sizePixels);
+                if (slamMap.sizePixels > 0 && slamMap.cellCount >= cells && m_mapColorizer) {
+                    // The colorizer borrows the receive buffer, or copies the cells when nothing owns it
+                    if (!frame.owner)
+                        m_payloadCopyCounter.fetch_add(1, std::memory_order_relaxed);
+                    m_mapColorizer->submit(frame, reinterpret_cast<const uint8_t *>(slamMap.cells),
+                                           slamMap.sizePixels, slamMap.sizeMeters, slamMap.timestamp);
+                }
+                markSlamReceived();
             }
             break;
         }
         case Spider2::MessageType::OBJECT_TRACKING_DATA: {
-            Command::BlobTrackingData blob;
-            if (blob.ParseFromString(protobufData)) {
-                QMetaObject::invokeMethod(this, [this, blob]() {
-                    m_hasBlob = blob.blob_size() > 0.001f;
-                    m_blobX = blob.blob_x();
-                    m_blobY = blob.blob_y();
-                    m_blobSize = blob.blob_size();
-                    m_blobFrameWidth = blob.frame_width();
-                    m_blobFrameHeight = blob.frame_height();
-                    emit blobDataChanged();
-                }, Qt::QueuedConnection);
+            if (const Command::BlobTrackingData *blobMsg = parser.parseBlob(frame.data, frame.size)) {
+                m_blobUpdate.publish(BlobUpdate{blobMsg->blob_x(), blobMsg->blob_y(), blobMsg->blob_size(),
+                                                blobMsg->frame_width(), blobMsg->frame_height()});
+                m_publisher->markDirty(PUBLISH_BLOB);
             }
             break;
         }
@@ -546,25 +993,21 @@ bool RobotController::isVoltageTelemetry(const QString &name)
 void RobotController::markLidarReceived()
 {
     m_lastLidarMs.store(QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed);
-    QMetaObject::invokeMethod(this, &RobotController::updateStreamHealth, Qt::QueuedConnection);
 }
 
 void RobotController::markGyroReceived()
 {
     m_lastGyroMs.store(QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed);
-    QMetaObject::invokeMethod(this, &RobotController::updateStreamHealth, Qt::QueuedConnection);
 }
 
 void RobotController::markSlamReceived()
 {
     m_lastSlamMs.store(QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed);
-    QMetaObject::invokeMethod(this, &RobotController::updateStreamHealth, Qt::QueuedConnection);
 }
 
 void RobotController::markSensorsReceived()
 {
     m_lastSensorsMs.store(QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed);
-    QMetaObject::invokeMethod(this, &RobotController::updateStreamHealth, Qt::QueuedConnection);
 }
 
 void RobotController::resetStreamHealth()
@@ -614,34 +1057,249 @@ void RobotController::updateDataStatistics()
     // Get current counters and reset them for next second
     uint64_t bytesReceived = m_bytesReceivedCounter.exchange(0, std::memory_order_relaxed);
     uint64_t messagesReceived = m_messagesReceivedCounter.exchange(0, std::memory_order_relaxed);
+    uint64_t payloadCopies = m_payloadCopyCounter.exchange(0, std::memory_order_relaxed);
+    uint64_t ingestAllocations = Spider2::AllocationCounter::take();
+
+    QVariantMap outbound;
+    outbound["sent_per_sec"] = static_cast<qulonglong>(m_commandsSentCounter.exchange(0, std::memory_order_relaxed));
+    outbound["dropped_per_sec"] = static_cast<qulonglong>(m_commandsDroppedCounter.exchange(0, std::memory_order_relaxed));
+    outbound["collapsed_per_sec"] = static_cast<qulonglong>(m_commandQueue ? m_commandQueue->takeCollapsedCount() : 0);
     
     // Update telemetry with current per-second statistics
-    QMetaObject::invokeMethod(this, [this, bytesReceived, messagesReceived]() {
-        m_telemetryData["bytes_received_per_sec"] = static_cast<qulonglong>(bytesReceived);
-        m_telemetryData["messages_received_per_sec"] = static_cast<qulonglong>(messagesReceived);
-        emit telemetryDataChanged();
-    }, Qt::QueuedConnection);
+    m_telemetryData->setValue("bytes_received_per_sec", static_cast<qulonglong>(bytesReceived));
+    m_telemetryData->setValue("messages_received_per_sec", static_cast<qulonglong>(messagesReceived));
+    m_telemetryData->setValue("payload_copies_per_sec", static_cast<qulonglong>(payloadCopies));
+    m_telemetryData->setValue("ingest_allocations_per_sec", static_cast<qulonglong>(ingestAllocations));
+    m_telemetryData->setValue("telemetry_coalesced_per_sec",
+                              static_cast<qulonglong>(m_telemetryCoalescedCount.exchange(0, std::memory_order_relaxed)));
+    m_telemetryData->setValue("gui_publishes_per_sec", static_cast<qulonglong>(m_publisher->takePublishCount()));
+    m_telemetryData->setValue("ingest_queues", ingestQueueStatistics());
+    m_telemetryData->setValue("video_decode", videoDecodeStatistics());
+    m_telemetryData->setValue("map_colorize", mapColorizeStatistics());
+    m_telemetryData->setValue("outbound_commands", outbound);
+    m_telemetryData->setValue("clock_sync", m_clockSync->statistics());
+    if (m_recorder->isRecording()) {
+        const Spider2::SessionRecorder::Stats recorded = m_recorder->stats();
+        QVariantMap recording;
+        recording["frames"] = static_cast<qulonglong>(recorded.frames);
+        recording["file_bytes"] = static_cast<qulonglong>(recorded.fileBytes);
+        recording["dropped"] = static_cast<qulonglong>(recorded.dropped);
+        recording["queue_depth"] = static_cast<qulonglong>(recorded.queueDepth);
+        recording["queued_bytes"] = static_cast<qulonglong>(recorded.queuedBytes);
+        recording["keyframes"] = static_cast<qulonglong>(recorded.keyframes);
+        recording["path"] = m_recorder->path();
+        m_telemetryData->setValue("recording", recording);
+    }
+    if (m_replay) {
+        const Spider2::ReplaySource::Stats replayed = m_replay->stats();
+        QVariantMap replay;
+        replay["frames_per_sec"] = static_cast<qulonglong>(replayed.frames - m_replayFramesReported);
+        replay["position_s"] = (replayed.positionUs - m_replay->reader().startUs()) / 1000000.0;
+        replay["duration_s"] = (m_replay->reader().endUs() - m_replay->reader().startUs()) / 1000000.0;
+        replay["speed"] = m_replaySpeed;
+        replay["seek_ms"] = replayed.seekUs / 1000.0;
+        m_telemetryData->setValue("replay", replay);
+        m_replayFramesReported = replayed.frames;
+    }
+
+    // Carry the drift forward between heartbeats
+    applyClockOffset();
 }
 
-void RobotController::updateTelemetry(const Command::TelemetryUpdate &telemetry)
+QVariant RobotController::telemetryValue(const Command::TelemetryUpdate &telemetry)
 {
-    QString name = QString::fromStdString(telemetry.name());
-
-    if (isVoltageTelemetry(name)) {
-        markSensorsReceived();
-    }
-    
     if (telemetry.has_fvalue()) {
-        m_telemetryData[name] = telemetry.fvalue();
+        return telemetry.fvalue();
     } else if (telemetry.has_svalue()) {
-        m_telemetryData[name] = QString::fromStdString(telemetry.svalue());
+        return QString::fromStdString(telemetry.svalue());
     } else if (telemetry.has_bvalue()) {
-        m_telemetryData[name] = telemetry.bvalue();
+        return telemetry.bvalue();
     } else if (telemetry.has_ivalue()) {
-        m_telemetryData[name] = telemetry.ivalue();
+        return telemetry.ivalue();
     }
-    
-    emit telemetryDataChanged();
+    return QVariant();
+}
+
+QVariantMap RobotController::ingestQueueStatistics() const
+{
+    QVariantMap queues;
+    if (!m_pipeline) {
+        return queues;
+    }
+    for (size_t i = 0; i < static_cast<size_t>(Spider2::IngestStream::COUNT); ++i) {
+        const auto stream = static_cast<Spider2::IngestStream>(i);
+        const auto stats = m_pipeline->stats(stream);
+        QVariantMap entry;
+        entry["depth"] = static_cast<qulonglong>(stats.depth);
+        entry["capacity"] = static_cast<qulonglong>(stats.capacity);
+        entry["delivered"] = static_cast<qulonglong>(stats.delivered);
+        entry["dropped"] = static_cast<qulonglong>(stats.dropped);
+        entry["policy"] = QString::fromLatin1(Spider2::IngestPipeline::policyName(stats.policy));
+        queues[QString::fromLatin1(Spider2::IngestPipeline::streamName(stream))] = entry;
+    }
+    return queues;
+}
+
+QVariantMap RobotController::videoDecodeStatistics()
+{
+    QVariantMap stats;
+    if (!m_videoDecoder) {
+        return stats;
+    }
+    const VideoDecoder::Stats s = m_videoDecoder->takeStats();
+    auto ms = [](uint64_t us) { return static_cast<double>(us) / 1000.0; };
+    stats["threads"] = m_videoDecoder->threadCount();
+    stats["decoded_per_sec"] = static_cast<qulonglong>(s.decoded);
+    stats["failed_per_sec"] = static_cast<qulonglong>(s.failed);
+    stats["stale_dropped_per_sec"] = static_cast<qulonglong>(s.staleDropped);
+    stats["overrun_dropped_per_sec"] = static_cast<qulonglong>(s.overrunDropped);
+    stats["decode_p50_ms"] = ms(s.decodeTime.percentile(0.50));
+    stats["decode_p95_ms"] = ms(s.decodeTime.percentile(0.95));
+    stats["decode_p99_ms"] = ms(s.decodeTime.percentile(0.99));
+    stats["decode_max_ms"] = ms(s.decodeTime.max);
+    return stats;
+}
+
+QVariantMap RobotController::mapColorizeStatistics()
+{
+    QVariantMap stats;
+    if (!m_mapColorizer) {
+        return stats;
+    }
+    const MapColorizer::Stats s = m_mapColorizer->takeStats();
+    auto ms = [](uint64_t us) { return static_cast<double>(us) / 1000.0; };
+    stats["threads"] = m_mapColorizer->threadCount();
+    stats["colorized_per_sec"] = static_cast<qulonglong>(s.colorized);
+    stats["overrun_dropped_per_sec"] = static_cast<qulonglong>(s.overrunDropped);
+    stats["tiles_changed_per_sec"] = static_cast<qulonglong>(s.tilesChanged);
+    stats["store_chunks"] = static_cast<qulonglong>(s.storeChunks);
+    stats["store_mb"] = static_cast<double>(s.storeBytes) / (1024.0 * 1024.0);
+    stats["colorize_p50_ms"] = ms(s.colorizeTime.percentile(0.50));
+    stats["colorize_p99_ms"] = ms(s.colorizeTime.percentile(0.99));
+    stats["colorize_max_ms"] = ms(s.colorizeTime.max);
+    return stats;
+}
+
+void RobotController::updateTelemetry(const QVariantMap &values)
+{
+    bool sensorsReceived = false;
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        if (isVoltageTelemetry(it.key())) {
+            sensorsReceived = true;
+        }
+        if (it.value().isValid()) {
+            m_telemetryData->setValue(it.key(), it.value());
+        }
+    }
+    if (sensorsReceived) {
+        markSensorsReceived();
+    }
+}
+
+void RobotController::publishLatestState(uint32_t dirty)
+{
+    // Everything received since the previous frame; each NOTIFY fires at most once
+
+    if (dirty & PUBLISH_TELEMETRY) {
+        QVariantMap values;
+        {
+            std::lock_guard<std::mutex> lock(m_telemetryMutex);
+            values.swap(m_pendingTelemetry);
+        }
+        if (!values.isEmpty()) {
+            updateTelemetry(values);
+        }
+    }
+
+    if (dirty & PUBLISH_GYRO) {
+        QVector<GyroReading> readings;
+        LatencyStamp stamp;
+        GyroBatch batch;
+        while (m_gyroUpdates.tryPop(batch)) {
+            readings += batch.readings;
+            stamp = batch.stamp;
+        }
+        if (!readings.isEmpty()) {
+            m_gyroController->addReadings(readings);
+            m_latencyMonitor->applied(Spider2::IngestStream::GYRO, stamp.robotMs, stamp.parsedUs);
+            const GyroReading &latest = readings.last();
+            m_telemetryData->setValue("gyro_timestamp", latest.timestamp);
+            m_telemetryData->setValue("gyro_x", latest.x);
+            m_telemetryData->setValue("gyro_y", latest.y);
+        }
+    }
+
+    LidarUpdate lidar;
+    if ((dirty & PUBLISH_LIDAR) && m_lidarUpdate.take(lidar)) {
+        if (!lidar.points.isEmpty()) {
+            const qsizetype missed = static_cast<qsizetype>(std::min<uint64_t>(
+                lidar.sequence > m_lidarAppliedSequence ? lidar.sequence - m_lidarAppliedSequence - 1 : 0,
+                static_cast<uint64_t>(lidar.previous.size())));
+            QList<QVector<LidarPoint>> revolutions = lidar.previous.mid(lidar.previous.size() - missed);
+            revolutions.append(lidar.points);
+            m_lidarController->updateLidarFrames(revolutions);
+            m_lidarAppliedSequence = lidar.sequence;
+            m_latencyMonitor->applied(Spider2::IngestStream::LIDAR, lidar.stamp.robotMs, lidar.stamp.parsedUs);
+        }
+        m_telemetryData->setValue("lidar_timestamp", lidar.timestamp);
+        m_telemetryData->setValue("lidar_point_count", lidar.points.size());
+    }
+
+    SlamPoseUpdate pose;
+    if ((dirty & PUBLISH_SLAM_POSE) && m_slamPoseUpdate.take(pose)) {
+        m_slamController->updatePose(pose.x, pose.y, pose.theta);
+        m_latencyMonitor->applied(Spider2::IngestStream::SLAM_POSE, pose.stamp.robotMs, pose.stamp.parsedUs);
+    }
+
+    if (dirty & PUBLISH_SLAM_MAP) {
+        // In order: each update only holds the tiles that differ from the one before
+        SlamMapUpdate map;
+        while (m_slamMapUpdates.tryPop(map)) {
+            m_slamController->updateMap(map.tiles);
+            m_latencyMonitor->applied(Spider2::IngestStream::SLAM_MAP, map.stamp.robotMs, map.stamp.parsedUs);
+        }
+    }
+
+    BlobUpdate blob;
+    if ((dirty & PUBLISH_BLOB) && m_blobUpdate.take(blob)) {
+        m_hasBlob = blob.size > 0.001f;
+        m_blobX = blob.x;
+        m_blobY = blob.y;
+        m_blobSize = blob.size;
+        m_blobFrameWidth = blob.frameWidth;
+        m_blobFrameHeight = blob.frameHeight;
+        emit blobDataChanged();
+    }
+
+    VideoUpdate video;
+    if ((dirty & PUBLISH_VIDEO) && m_videoUpdate.take(video)) {
+        m_videoFrameIndex.fetch_add(1, std::memory_order_relaxed);
+        emit videoFrameReady(video.image, video.timestamp);
+        m_latencyMonitor->applied(Spider2::IngestStream::VIDEO, video.stamp.robotMs, video.stamp.parsedUs);
+        emit videoFrameIndexChanged();
+    }
+
+    updateStreamHealth();
+}
+
+void RobotController::discardPendingState()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_telemetryMutex);
+        m_pendingTelemetry.clear();
+    }
+    GyroBatch gyro;
+    while (m_gyroUpdates.tryPop(gyro)) {}
+    LidarUpdate lidar;
+    m_lidarUpdate.take(lidar);
+    SlamPoseUpdate pose;
+    m_slamPoseUpdate.take(pose);
+    SlamMapUpdate map;
+    while (m_slamMapUpdates.tryPop(map)) {}
+    BlobUpdate blob;
+    m_blobUpdate.take(blob);
+    VideoUpdate video;
+    m_videoUpdate.take(video);
 }
 
 void RobotController::loadRecentServerIps()
@@ -676,6 +1334,62 @@ void RobotController::addToRecentServerIps(const QString &ip)
     emit recentServerIpsChanged();
 }
 
+void RobotController::restoreMapCache(const QString &server)
+{
+    if (server == m_mapCacheServer && m_slamController->mapSizePixels() > 0) {
+        return;   // on screen already, and at least as new as the file
+    }
+    const int64_t startUs = LatencyMonitor::nowUs();
+    Spider2::MapCache::Snapshot snapshot;
+    if (m_mapCache->load(server, snapshot)) {
+        m_slamController->clearData();
+        m_slamController->updateMap(snapshot.map);
+        if (!snapshot.trail.empty()) {
+            std::vector<Spider2::PoseTrail::Point> trail;
+            trail.reserve(snapshot.trail.size());
+            for (const Spider2::MapCache::Pose &pose : snapshot.trail) {
+                trail.push_back(Spider2::PoseTrail::Point{static_cast<float>(pose.x_mm), static_cast<float>(pose.y_mm)});
+            }
+            m_slamController->restoreTrail(trail);
+            const Spider2::MapCache::Pose &pose = snapshot.trail.back();
+            m_slamController->updatePose(pose.x_mm, pose.y_mm, pose.theta_deg);
+        }
+        qInfo() << "[MAP] Restored the map of" << server << ":" << snapshot.map.sizePixels << "px,"
+                << snapshot.map.tiles.size() << "tiles in" << (LatencyMonitor::nowUs() - startUs) / 1000.0 << "ms";
+    } else if (server != m_mapCacheServer) {
+        // Whatever is on screen belongs to another robot (or a replay)
+        m_slamController->clearData();
+    }
+    m_mapCacheServer = server;
+    m_mapCacheSavedFrame = m_slamController->mapFrameIndex();
+    m_mapCacheSavedTrail = m_slamController->trail().revision();
+}
+
+void RobotController::saveMapCache()
+{
+    if (m_mapCacheServer.isEmpty() || m_slamController->mapSizePixels() <= 0
+        || (m_slamController->mapFrameIndex() == m_mapCacheSavedFrame
+            && m_slamController->trail().revision() == m_mapCacheSavedTrail)) {
+        return;
+    }
+    // Chunks are shared, not copied: the snapshot costs a pointer per stored tile
+    Spider2::MapCache::Snapshot snapshot;
+    snapshot.map = m_slamController->mapSnapshot();
+    if (m_slamController->hasData()) {
+        // The trail, then the current pose, which carries the heading
+        const Spider2::PoseTrail &trail = m_slamController->trail();
+        snapshot.trail.reserve(trail.size() + 1);
+        for (const Spider2::PoseTrail::Point &point : trail.points()) {
+            snapshot.trail.push_back(Spider2::MapCache::Pose{point.x_mm, point.y_mm, 0.0});
+        }
+        snapshot.trail.push_back(Spider2::MapCache::Pose{m_slamController->posX(), m_slamController->posY(),
+                                                         m_slamController->posTheta()});
+    }
+    m_mapCache->save(m_mapCacheServer, std::move(snapshot));
+    m_mapCacheSavedFrame = m_slamController->mapFrameIndex();
+    m_mapCacheSavedTrail = m_slamController->trail().revision();
+}
+
 void RobotController::clearRecentServerIps()
 {
     m_recentServerIps.clear();
@@ -2,23 +2,41 @@
 
 #include <QObject>
 #include <QString>
+#include <QImage>
+#include <QSize>
 #include <QVariantMap>
+#include <QMap>
 #include <QTimer>
 #include <memory>
 #include <zmq.hpp>
 #include <thread>
 #include <atomic>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <utility>
 #include "MessageTypes.hpp"
+#include "RawFrame.h"
+#include "IngestPipeline.h"
+#include "CommandQueue.h"
+#include "LatestValue.h"
+#include "MapCache.h"
+#include "MapTiles.h"
+#include "MpscQueue.h"
 #include "LidarController.h"
 #include "GyroController.h"
 #include "SlamController.h"
+#include "TelemetryStore.h"
+#include "LatencyMonitor.h"
+#include "ClockSync.h"
+#include "SessionRecorder.h"
+#include "ReplaySource.h"
 
-class VideoProvider;
-class MapProvider;
+class FramePublisher;
+class QQuickWindow;
+class VideoDecoder;
+class MapColorizer;
 
 class RobotController : public QObject
 {
@@ -36,7 +54,14 @@ class RobotController : public QObject
     Q_PROPERTY(float bodyPitch READ bodyPitch WRITE setBodyPitch NOTIFY bodyPitchChanged)
     Q_PROPERTY(float bodyRoll READ bodyRoll WRITE setBodyRoll NOTIFY bodyRollChanged)
     Q_PROPERTY(QStringList recentServerIps READ recentServerIps NOTIFY recentServerIpsChanged)
-    Q_PROPERTY(QVariantMap telemetryData READ telemetryData NOTIFY telemetryDataChanged)
+    Q_PROPERTY(TelemetryStore* telemetryData READ telemetryData CONSTANT)
+    Q_PROPERTY(LatencyMonitor* latency READ latencyMonitor CONSTANT)
+    Q_PROPERTY(ClockSync* clockSync READ clockSync CONSTANT)
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    Q_PROPERTY(bool replaying READ replaying NOTIFY replayingChanged)
+    Q_PROPERTY(double replaySpeed READ replaySpeed WRITE setReplaySpeed NOTIFY replaySpeedChanged)
+    Q_PROPERTY(double replayPositionMs READ replayPositionMs NOTIFY replayPositionChanged)
+    Q_PROPERTY(double replayDurationMs READ replayDurationMs NOTIFY replayingChanged)
     Q_PROPERTY(LidarController* lidarController READ lidarController NOTIFY lidarControllerChanged)
     Q_PROPERTY(GyroController* gyroController READ gyroController NOTIFY gyroControllerChanged)
     Q_PROPERTY(SlamController* slamController READ slamController NOTIFY slamControllerChanged)
@@ -45,6 +70,7 @@ class RobotController : public QObject
     Q_PROPERTY(bool slamStreamActive READ slamStreamActive NOTIFY streamHealthChanged)
     Q_PROPERTY(bool sensorsStreamActive READ sensorsStreamActive NOTIFY streamHealthChanged)
     Q_PROPERTY(int videoFrameIndex READ videoFrameIndex NOTIFY videoFrameIndexChanged)
+    Q_PROPERTY(QSize videoDisplaySize READ videoDisplaySize WRITE setVideoDisplaySize NOTIFY videoDisplaySizeChanged)
     Q_PROPERTY(bool objectTracking READ objectTracking WRITE setObjectTracking NOTIFY objectTrackingChanged)
     Q_PROPERTY(bool hasBlob READ hasBlob NOTIFY blobDataChanged)
     Q_PROPERTY(float blobX READ blobX NOTIFY blobDataChanged)
@@ -55,6 +81,8 @@ class RobotController : public QObject
 
 public:
     explicit RobotController(QObject *parent = nullptr);
+    /// @brief Use @p context, shared with an in-process robot, instead of a context of its own; inproc:// needs this
+    explicit RobotController(std::shared_ptr<zmq::context_t> context, QObject *parent = nullptr);
     ~RobotController();
 
     // Property getters
@@ -69,7 +97,15 @@ public:
     float bodyPitch() const { return m_bodyPitch; }
     float bodyRoll() const { return m_bodyRoll; }
     QStringList recentServerIps() const { return m_recentServerIps; }
-    QVariantMap telemetryData() const { return m_telemetryData; }
+    TelemetryStore* telemetryData() const { return m_telemetryData; }
+    LatencyMonitor* latencyMonitor() const { return m_latencyMonitor; }
+    ClockSync* clockSync() const { return m_clockSync; }
+    bool recording() const { return m_recorder->isRecording(); }
+    bool replaying() const { return m_replay != nullptr; }
+    double replaySpeed() const { return m_replaySpeed; }
+    /// @brief Milliseconds since the start of the replayed session
+    double replayPositionMs() const { return m_replayPositionMs; }
+    double replayDurationMs() const;
     LidarController* lidarController() const { return m_lidarController; }
     GyroController* gyroController() const { return m_gyroController; }
     SlamController* slamController() const { return m_slamController; }
@@ -78,6 +114,7 @@ public:
     bool slamStreamActive() const { return m_slamStreamActive; }
     bool sensorsStreamActive() const { return m_sensorsStreamActive; }
     int videoFrameIndex() const { return m_videoFrameIndex.load(std::memory_order_relaxed); }
+    QSize videoDisplaySize() const { return m_videoDisplaySize; }
     bool objectTracking() const { return m_objectTracking; }
     bool hasBlob() const { return m_hasBlob; }
     float blobX() const { return m_blobX; }
@@ -85,6 +122,8 @@ public:
     float blobSize() const { return m_blobSize; }
     int blobFrameWidth() const { return m_blobFrameWidth; }
     int blobFrameHeight() const { return m_blobFrameHeight; }
+    /// @brief Whether connectToRobot() adds the server to recentServerIps and caches its map (tools turn this off)
+    void setRememberServers(bool remember) { m_rememberServers = remember; }
 
 public slots:
     void setServerIp(const QString &ip);
@@ -96,8 +135,12 @@ public slots:
     void setTrajectoryType(int type);
     void setBodyPitch(float angle);
     void setBodyRoll(float angle);
-    void setVideoProvider(VideoProvider *provider);
-    void setMapProvider(MapProvider *provider);
+    /// @brief On-screen video size in device pixels; frames are decoded to cover it
+    void setVideoDisplaySize(const QSize &size);
+    /// @brief Align GUI-side publishing (and latency "present" stage) to this window's frames
+    void setPublishWindow(QQuickWindow *window);
+    /// @brief Replay pacing: 1 = real time, N = N times faster, 0 = as fast as possible
+    void setReplaySpeed(double speed);
     void connectToRobot();
     void disconnectFromRobot();
     /// @brief Broadcast servo torque on/off to all servos (id=254)
@@ -112,6 +155,40 @@ public slots:
     Q_INVOKABLE void clearRecentServerIps();
     /// @brief Request IMU gyro zero offset reset on the robot
     Q_INVOKABLE void resetImu();
+    /**
+     * @brief Change how a receive stream copes with a slow consumer
+     * @param stream Stream name as reported in telemetryData.ingest_queues (e.g. "gyro")
+     * @param policy "keep_latest" or "keep_all"
+     * @return false for an unknown stream or policy
+     */
+    Q_INVOKABLE bool setStreamDropPolicy(const QString &stream, const QString &policy);
+    /// @brief Current policy name of @p stream; empty if unknown or not set before connecting
+    Q_INVOKABLE QString streamDropPolicy(const QString &stream) const;
+    /**
+     * @brief Record every received frame to a session file until stopRecording()
+     *
+     * Recording continues across reconnects, so a flaky link ends up in one file.
+     * @param path File path or file:// URL; empty = a timestamped file under the app data directory
+     * @param compress Compress each chunk (worthwhile without video)
+     * @return false if the file cannot be created
+     */
+    Q_INVOKABLE bool startRecording(const QString &path = QString(), bool compress = false);
+    Q_INVOKABLE void stopRecording();
+    /**
+     * @brief Play a recorded session through the normal receive path (only while disconnected)
+     * @param path File path or file:// URL of a .s2rec session
+     * @param speed See replaySpeed; 0 reports pipeline throughput through replayFinished()
+     * @return false when connected or the file is not a session
+     */
+    Q_INVOKABLE bool startReplay(const QString &path, double speed = 1.0);
+    Q_INVOKABLE void stopReplay();
+    /**
+     * @brief Continue the replay at @p positionMs from the start of the session
+     *
+     * The nearest keyframe before the position restores the view, then only
+     * what was recorded between the keyframe and the position is applied.
+     */
+    Q_INVOKABLE void seekReplay(double positionMs);
 
 signals:
     void serverIpChanged();
@@ -125,12 +202,22 @@ signals:
     void bodyPitchChanged();
     void bodyRollChanged();
     void recentServerIpsChanged();
-    void telemetryDataChanged();
+    void recordingChanged();
+    void replayingChanged();
+    void replaySpeedChanged();
+    void replayPositionChanged();
+    /// @brief A replay reached the end: {frames, bytes, seconds, frames_per_sec, mb_per_sec, speed}
+    void replayFinished(const QVariantMap &result);
     void lidarControllerChanged();
     void gyroControllerChanged();
     void slamControllerChanged();
     void streamHealthChanged();
     void videoFrameIndexChanged();
+    /// @brief Emitted on the GUI thread for every decoded frame, newest last
+    void videoFrameReady(const QImage &frame, qint64 timestamp);
+    /// @brief The frame on screen no longer belongs to the stream (replay seek)
+    void videoReset();
+    void videoDisplaySizeChanged();
     void objectTrackingChanged();
     void blobDataChanged();
     void connectionError(const QString &error);
@@ -139,34 +226,94 @@ private slots:
     void sendHeartbeat();
     void updateStreamHealth();
     void updateDataStatistics();
+    void onReplayFinished();
+    void updateReplayPosition();
 
 private:
+    // Drives the receive-side dispatch from the benchmark suite (bench/)
+    friend struct RobotControllerBenchAccess;
+
     void markLidarReceived();
     void markGyroReceived();
     void markSlamReceived();
     void markSensorsReceived();
     void resetStreamHealth();
     static bool isVoltageTelemetry(const QString &name);
+    /// @brief Frames that restore the client state: one per view, the history the controllers keep
+    Spider2::KeyframePolicy keyframePolicy() const;
+    void startReplayThread(int64_t fromUs);
+    void startIngest();
+    void stopIngest();
     void startCommunicationThread();
     void stopCommunicationThread();
     void communicationLoop();
     void sendMessage(Spider2::MessageType type, const google::protobuf::Message &message);
-    void dispatchMessage(uint8_t type, const std::string &data);
-    void updateTelemetry(const Command::TelemetryUpdate &telemetry);
+    void wakeCommunicationThread();
+    void sendPendingCommands();
+    void dispatchMessage(const Spider2::RawFrame &frame);
+    void dispatchGyroBatch(const Spider2::RawFrame *frames, size_t count);
+    void dispatchTelemetryBatch(const Spider2::RawFrame *frames, size_t count);
+    static QVariant telemetryValue(const Command::TelemetryUpdate &telemetry);
+    void updateTelemetry(const QVariantMap &values);
+    void publishLatestState(uint32_t dirty);
+    /// @brief Drop whatever the receive side left for the GUI (after the workers have stopped)
+    void discardPendingState();
+    void applyClockOffset();
+    QVariantMap ingestQueueStatistics() const;
+    QVariantMap videoDecodeStatistics();
+    QVariantMap mapColorizeStatistics();
     void loadRecentServerIps();
     void saveRecentServerIps();
     void addToRecentServerIps(const QString &ip);
+    /// @brief Show the cached map of @p server, unless it is already on screen
+    void restoreMapCache(const QString &server);
+    /// @brief Queue the map on screen to be written for m_mapCacheServer if it changed
+    void saveMapCache();
 
     // ZeroMQ components
-    std::unique_ptr<zmq::context_t> m_context;
-    std::unique_ptr<zmq::socket_t> m_socket;
+    std::shared_ptr<zmq::context_t> m_context;
+    bool m_contextInjected{false};             // m_context came from outside: only then can an inproc:// robot exist
+    std::unique_ptr<zmq::socket_t> m_socket;   // used only by the communication thread once it runs
     std::thread m_communicationThread;
     std::atomic<bool> m_running{false};
 
+    // Outbound commands: any thread pushes, the communication thread sends.
+    // The inproc PAIR wakes its poll; one wake is outstanding at most.
+    std::unique_ptr<Spider2::CommandQueue> m_commandQueue;
+    std::unique_ptr<zmq::socket_t> m_wakeReceiver;
+    std::unique_ptr<zmq::socket_t> m_wakeSender;
+    std::mutex m_wakeMutex;                    // zmq sockets are not thread-safe
+    std::atomic<bool> m_wakePending{false};
+
+    // Raw traffic recorder, fed by the communication thread
+    std::unique_ptr<Spider2::SessionRecorder> m_recorder;
+
+    // Recorded session played into m_pipeline instead of the socket (while disconnected)
+    std::unique_ptr<Spider2::ReplaySource> m_replay;
+    double m_replaySpeed{1.0};
+    uint64_t m_replayFramesReported{0};
+    double m_replayPositionMs{0.0};
+    QTimer *m_replayPositionTimer{nullptr};
+
+    // Receive → decode stages (owned while connected)
+    std::unique_ptr<Spider2::IngestPipeline> m_pipeline;
+    std::unique_ptr<VideoDecoder> m_videoDecoder;
+    std::unique_ptr<MapColorizer> m_mapColorizer;
+    QMap<Spider2::IngestStream, Spider2::DropPolicy> m_dropPolicies;   // runtime overrides
+
     // Connection state
     QString m_serverIp;
     bool m_connected{false};
     QStringList m_recentServerIps;
+    bool m_rememberServers{true};
+
+    // Last map and pose per server, restored on connect and saved while connected
+    std::unique_ptr<Spider2::MapCache> m_mapCache;
+    QString m_mapCacheServer;                  // server the map on screen came from; empty = none / replay
+    int m_mapCacheSavedFrame{-1};              // SlamController::mapFrameIndex() when last saved or restored
+    uint64_t m_mapCacheSavedTrail{0};          // PoseTrail::revision() likewise
+    QTimer *m_mapCacheTimer{nullptr};
+    static constexpr int MAP_CACHE_SAVE_INTERVAL_MS = 30000;
 
     // Robot state
     float m_forwardSpeed{0.0f};
@@ -178,8 +325,78 @@ private:
     float m_bodyPitch{0.0f};  // degrees, range -10.0 to 10.0
     float m_bodyRoll{0.0f};   // degrees, range -10.0 to 10.0
 
-    // Telemetry data
-    QVariantMap m_telemetryData;
+    // Telemetry data (per-key notification to QML)
+    TelemetryStore *m_telemetryData;
+
+    // Per-stream, per-stage latency histograms
+    LatencyMonitor *m_latencyMonitor;
+
+    // Heartbeat RTT and robot clock offset/drift; converts robot stamps for m_latencyMonitor
+    ClockSync *m_clockSync;
+
+    // Latest state written by the receive side and applied by m_publisher
+    // on the GUI thread once per frame. Each bit names a slot with news.
+    enum PublishChannel : uint32_t {
+        PUBLISH_TELEMETRY = 1u << 0,
+        PUBLISH_GYRO      = 1u << 1,
+        PUBLISH_LIDAR     = 1u << 2,
+        PUBLISH_SLAM_POSE = 1u << 3,
+        PUBLISH_SLAM_MAP  = 1u << 4,
+        PUBLISH_BLOB      = 1u << 5,
+        PUBLISH_VIDEO     = 1u << 6
+    };
+    struct LatencyStamp {
+        int64_t robotMs{0};     // message timestamp (robot clock)
+        int64_t parsedUs{0};    // LatencyMonitor::nowUs() when parsing finished
+    };
+    struct LidarUpdate {
+        QVector<LidarPoint> points;
+        qint64 timestamp{0};
+        LatencyStamp stamp;
+        uint64_t sequence{0};                   // revolutions with points since startIngest(), this one included
+        QList<QVector<LidarPoint>> previous;    // the ones before it, oldest first, for a GUI that missed them
+    };
+    struct GyroBatch {
+        QVector<GyroReading> readings;
+        LatencyStamp stamp;     // of the newest reading
+    };
+    struct SlamPoseUpdate {
+        double x{0.0};
+        double y{0.0};
+        double theta{0.0};
+        LatencyStamp stamp;
+    };
+    struct SlamMapUpdate {
+        Spider2::MapTileUpdate tiles;    // only what changed since the previous map
+        LatencyStamp stamp;
+    };
+    struct BlobUpdate {
+        float x{0.0f};
+        float y{0.0f};
+        float size{0.0f};
+        int frameWidth{0};
+        int frameHeight{0};
+    };
+    struct VideoUpdate {
+        QImage image;
+        qint64 timestamp{0};
+        LatencyStamp stamp;
+    };
+    FramePublisher *m_publisher{nullptr};
+    // Telemetry is coalesced per metric name by the workers, so it stays bounded however long the GUI stalls
+    std::mutex m_telemetryMutex;
+    QVariantMap m_pendingTelemetry;                              // guarded by m_telemetryMutex
+    static constexpr int MAX_PENDING_TELEMETRY_NAMES = 1024;     // distinct names beyond this are dropped
+    Spider2::MpscQueue<GyroBatch> m_gyroUpdates;                 // every batch; keep-all
+    Spider2::LatestValue<LidarUpdate> m_lidarUpdate;
+    QList<QVector<LidarPoint>> m_lidarHistory;                   // lidar worker only: last revolutions blended
+    uint64_t m_lidarSequence{0};                                 // lidar worker only
+    int m_lidarHistoryDepth{LidarController::MERGE_FRAMES};      // set before the workers start
+    uint64_t m_lidarAppliedSequence{0};                          // GUI thread
+    Spider2::LatestValue<SlamPoseUpdate> m_slamPoseUpdate;
+    Spider2::MpscQueue<SlamMapUpdate> m_slamMapUpdates;          // every map; tile diffs build on each other
+    Spider2::LatestValue<BlobUpdate> m_blobUpdate;
+    Spider2::LatestValue<VideoUpdate> m_videoUpdate;
 
     // Lidar controller
     LidarController *m_lidarController;
@@ -190,11 +407,6 @@ private:
     // Slam controller
     SlamController *m_slamController;
 
-    // Video provider
-    VideoProvider *m_videoProvider{nullptr};
-
-    // Map provider
-    MapProvider *m_mapProvider{nullptr};
 
     // Heartbeat timer
     QTimer *m_heartbeatTimer;
@@ -211,6 +423,7 @@ private:
     bool m_slamStreamActive{false};
     bool m_sensorsStreamActive{false};
     std::atomic<int> m_videoFrameIndex{0};
+    QSize m_videoDisplaySize;
 
     // Object tracking
     bool m_objectTracking{false};
@@ -225,4 +438,8 @@ private:
     QTimer *m_statisticsTimer{nullptr};
     std::atomic<uint64_t> m_bytesReceivedCounter{0};
     std::atomic<uint64_t> m_messagesReceivedCounter{0};
+    std::atomic<uint64_t> m_payloadCopyCounter{0};  // payloads copied out of receive buffers
+    std::atomic<uint64_t> m_commandsSentCounter{0};
+    std::atomic<uint64_t> m_commandsDroppedCounter{0};
+    std::atomic<uint64_t> m_telemetryCoalescedCount{0};  // values replaced (or dropped) before the GUI saw them
 };
@@ -0,0 +1,531 @@
+#include "RobotSimulator.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QImage>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <zmq_addon.hpp>
+#include "command.pb.h"
+#include "ThreadName.h"
+
+namespace Spider2 {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+int64_t steadyUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t wallClockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+constexpr const char *STREAM_NAMES[] = {"lidar", "gyro", "video", "slam_pose", "slam_map", "telemetry"};
+static_assert(sizeof(STREAM_NAMES) / sizeof(STREAM_NAMES[0]) == static_cast<size_t>(RobotSimulator::Stream::COUNT),
+              "one name per stream");
+
+/// @brief Parsed form of a client message, for the command log
+std::unique_ptr<google::protobuf::Message> commandMessage(MessageType type)
+{
+    switch (type) {
+    case MessageType::MOVE_COMMAND:            return std::make_unique<Command::MoveCommand>();
+    case MessageType::HEIGHT_COMMAND:          return std::make_unique<Command::HeightCommand>();
+    case MessageType::WALKING_STYLE_COMMAND:   return std::make_unique<Command::WalkingStyleCommand>();
+    case MessageType::SERVO_TORQUE_COMMAND:    return std::make_unique<Command::ServoTorqueCommand>();
+    case MessageType::MOVE_TO_POINT_COMMAND:   return std::make_unique<Command::MoveToPointCommand>();
+    case MessageType::ROBOT_STATE_CHANGE:      return std::make_unique<Command::RobotStateChange>();
+    case MessageType::OBJECT_TRACKING_COMMAND: return std::make_unique<Command::BlobTrackingCommand>();
+    case MessageType::TRAJECTORY_COMMAND:      return std::make_unique<Command::TrajectoryCommand>();
+    case MessageType::PITCH_COMMAND:           return std::make_unique<Command::PitchCommand>();
+    case MessageType::ROLL_COMMAND:            return std::make_unique<Command::RollCommand>();
+    case MessageType::RESET_IMU:               return std::make_unique<Command::ResetImu>();
+    default:                                   return nullptr;
+    }
+}
+
+// Robot path for pose, lidar and blob: a slow loop around the middle of the map
+// (map coordinates run from 0 to mapMeters·1000 mm, origin top-left)
+constexpr double PATH_RADIUS_MM = 3000.0;
+constexpr double PATH_PERIOD_S = 60.0;
+
+} // namespace
+
+bool RobotSimulator::Config::setVideoSize(const std::string &text)
+{
+    const size_t separator = text.find_first_of("xX");
+    if (separator == std::string::npos)
+        return false;
+    const char *end = text.data() + text.size();
+    int width = 0;
+    int height = 0;
+    const auto [widthEnd, widthError] = std::from_chars(text.data(), text.data() + separator, width);
+    const auto [heightEnd, heightError] = std::from_chars(text.data() + separator + 1, end, height);
+    if (widthError != std::errc() || widthEnd != text.data() + separator
+        || heightError != std::errc() || heightEnd != end || width <= 0 || height <= 0)
+        return false;
+    videoWidth = width;
+    videoHeight = height;
+    return true;
+}
+
+RobotSimulator::RobotSimulator()
+{
+    const Config defaults;
+    for (size_t i = 0; i < m_rates.size(); ++i)
+        m_rates[i].store(defaults.rates[i], std::memory_order_relaxed);
+}
+
+RobotSimulator::~RobotSimulator()
+{
+    stop();
+}
+
+bool RobotSimulator::start(zmq::context_t &context, const Config &config)
+{
+    stop();
+
+    try {
+        m_socket = std::make_unique<zmq::socket_t>(context, ZMQ_ROUTER);
+        m_socket->set(zmq::sockopt::linger, 0);
+        // EHOSTUNREACH for departed clients, EAGAIN (= dropped) for full queues
+        m_socket->set(zmq::sockopt::router_mandatory, 1);
+        m_socket->bind(config.endpoint);
+    } catch (const zmq::error_t &e) {
+        qWarning() << "[SIM] Cannot bind" << QString::fromStdString(config.endpoint) << ":" << e.what();
+        m_socket.reset();
+        return false;
+    }
+
+    m_config = config;
+    for (size_t i = 0; i < m_rates.size(); ++i)
+        m_rates[i].store(std::max(0.0, config.rates[i]), std::memory_order_relaxed);
+    for (StreamCounters &counters : m_counters) {
+        counters.sent.store(0, std::memory_order_relaxed);
+        counters.dropped.store(0, std::memory_order_relaxed);
+        counters.bytes.store(0, std::memory_order_relaxed);
+    }
+    m_heartbeats.store(0, std::memory_order_relaxed);
+    m_commands.store(0, std::memory_order_relaxed);
+    m_clientCount.store(0, std::memory_order_relaxed);
+    m_clients.clear();
+    m_blobTracking = false;
+    m_lidarSweep = 0;
+    m_videoIndex = 0;
+
+    // Payloads are prepared up front so the send loop measures the client, not the encoder
+    encodeVideoFrames();
+    buildMap();
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&RobotSimulator::run, this);
+
+    qInfo() << "[SIM] Listening on" << QString::fromStdString(config.endpoint);
+    return true;
+}
+
+void RobotSimulator::stop()
+{
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_socket) {
+        m_socket->close();
+        m_socket.reset();
+    }
+}
+
+void RobotSimulator::setRate(Stream stream, double messagesPerSecond)
+{
+    m_rates[static_cast<size_t>(stream)].store(std::max(0.0, messagesPerSecond), std::memory_order_relaxed);
+}
+
+double RobotSimulator::rate(Stream stream) const
+{
+    return m_rates[static_cast<size_t>(stream)].load(std::memory_order_relaxed);
+}
+
+RobotSimulator::Stats RobotSimulator::stats() const
+{
+    Stats s;
+    for (size_t i = 0; i < m_counters.size(); ++i) {
+        s.streams[i].sent = m_counters[i].sent.load(std::memory_order_relaxed);
+        s.streams[i].dropped = m_counters[i].dropped.load(std::memory_order_relaxed);
+        s.streams[i].bytes = m_counters[i].bytes.load(std::memory_order_relaxed);
+    }
+    s.heartbeats = m_heartbeats.load(std::memory_order_relaxed);
+    s.commands = m_commands.load(std::memory_order_relaxed);
+    s.clients = m_clientCount.load(std::memory_order_relaxed);
+    return s;
+}
+
+const char *RobotSimulator::streamName(Stream stream)
+{
+    const auto index = static_cast<size_t>(stream);
+    return index < static_cast<size_t>(Stream::COUNT) ? STREAM_NAMES[index] : "unknown";
+}
+
+bool RobotSimulator::streamFromName(const std::string &name, Stream &stream)
+{
+    for (size_t i = 0; i < static_cast<size_t>(Stream::COUNT); ++i) {
+        if (name == STREAM_NAMES[i]) {
+            stream = static_cast<Stream>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t RobotSimulator::robotTimeMs() const
+{
+    return wallClockMs() + m_config.clockOffsetMs;
+}
+
+void RobotSimulator::run()
+{
+    setCurrentThreadName("s2-sim");
+    m_startUs = steadyUs();
+    m_dueUs.fill(m_startUs);
+    m_heartbeatDueUs = m_startUs + HEARTBEAT_INTERVAL_US;
+
+    while (m_running.load(std::memory_order_acquire)) {
+        int64_t nowUs = steadyUs();
+        int64_t nextDueUs = nowUs + 100'000;   // wake up for stop() and rate changes at least this often
+
+        for (size_t i = 0; i < m_dueUs.size(); ++i) {
+            const double rate = m_rates[i].load(std::memory_order_relaxed);
+            if (rate <= 0.0) {
+                m_dueUs[i] = nowUs;        // resumes immediately once enabled
+                continue;
+            }
+            const auto periodUs = std::max<int64_t>(1, static_cast<int64_t>(1e6 / rate));
+            int burst = 0;
+            while (m_dueUs[i] <= nowUs && burst++ < MAX_BURST) {
+                produce(static_cast<Stream>(i), nowUs);
+                m_dueUs[i] += periodUs;
+            }
+            // Too far behind to catch up: keep the rate from here on instead
+            if (m_dueUs[i] < nowUs - 1'000'000)
+                m_dueUs[i] = nowUs;
+            nextDueUs = std::min(nextDueUs, m_dueUs[i]);
+        }
+
+        if (nowUs >= m_heartbeatDueUs) {
+            const std::string heartbeat = MessageFactory::createHeartbeat("spider2-sim", robotTimeMs()).SerializeAsString();
+            broadcast(MessageType::HEARTBEAT, heartbeat, nullptr);
+            expireClients(nowUs);
+            m_heartbeatDueUs = nowUs + HEARTBEAT_INTERVAL_US;
+        }
+        nextDueUs = std::min(nextDueUs, m_heartbeatDueUs);
+
+        // Wait for client messages until the next send is due; zmq polls in whole milliseconds
+        nowUs = steadyUs();
+        const int64_t waitUs = nextDueUs - nowUs;
+        zmq::pollitem_t item{m_socket->handle(), 0, ZMQ_POLLIN, 0};
+        try {
+            zmq::poll(&item, 1, std::chrono::milliseconds(waitUs >= 1000 ? waitUs / 1000 : 0));
+        } catch (const zmq::error_t &e) {
+            if (e.num() != EINTR)
+                qWarning() << "[SIM] Poll failed:" << e.what();
+        }
+        if (item.revents & ZMQ_POLLIN) {
+            receive();
+        } else if (waitUs > 0 && waitUs < 1000) {
+            std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+        }
+    }
+}
+
+void RobotSimulator::receive()
+{
+    // ROUTER prepends the identity: [identity][type][payload]
+    std::vector<zmq::message_t> parts;
+    while (true) {
+        parts.clear();
+        try {
+            if (!zmq::recv_multipart(*m_socket, std::back_inserter(parts), zmq::recv_flags::dontwait))
+                return;
+        } catch (const zmq::error_t &e) {
+            qWarning() << "[SIM] Receive failed:" << e.what();
+            return;
+        }
+        if (parts.size() != 3 || parts[1].size() != 1) {
+            qWarning() << "[SIM] Ignoring malformed message with" << parts.size() << "frames";
+            continue;
+        }
+
+        const std::string client = parts[0].to_string();
+        if (m_clients.emplace(client, 0).second) {
+            qInfo() << "[SIM] Client connected," << m_clients.size() << "total";
+            m_clientCount.store(m_clients.size(), std::memory_order_relaxed);
+        }
+        m_clients[client] = steadyUs();
+
+        handleMessage(client, static_cast<MessageType>(*parts[1].data<uint8_t>()), parts[2]);
+    }
+}
+
+void RobotSimulator::handleMessage(const std::string &client, MessageType type, const zmq::message_t &payload)
+{
+    if (type == MessageType::HEARTBEAT) {
+        m_heartbeats.fetch_add(1, std::memory_order_relaxed);
+        // Stamped with the robot clock, so the client can estimate the offset
+        sendTo(client, MessageType::HEARTBEAT,
+               MessageFactory::createHeartbeat("spider2-sim", robotTimeMs()).SerializeAsString(), nullptr);
+        return;
+    }
+
+    m_commands.fetch_add(1, std::memory_order_relaxed);
+    std::unique_ptr<google::protobuf::Message> command = commandMessage(type);
+    if (!command) {
+        qWarning() << "[SIM] Unknown message type" << static_cast<int>(type);
+        return;
+    }
+    if (!command->ParseFromArray(payload.data(), static_cast<int>(payload.size()))) {
+        qWarning() << "[SIM] Cannot parse" << QString::fromStdString(command->GetTypeName());
+        return;
+    }
+
+    if (type == MessageType::OBJECT_TRACKING_COMMAND) {
+        m_blobTracking = static_cast<const Command::BlobTrackingCommand &>(*command).enabled();
+    }
+    if (m_config.logCommands) {
+        qInfo().noquote() << "[SIM]" << QString::fromStdString(command->GetTypeName())
+                          << QString::fromStdString(command->ShortDebugString());
+    }
+}
+
+void RobotSimulator::produce(Stream stream, int64_t nowUs)
+{
+    switch (stream) {
+    case Stream::LIDAR:     sendLidar(nowUs); break;
+    case Stream::GYRO:      sendGyro(nowUs); break;
+    case Stream::VIDEO:     sendVideo(); sendBlob(nowUs); break;
+    case Stream::SLAM_POSE: sendPose(nowUs); break;
+    case Stream::SLAM_MAP:  sendMap(); break;
+    case Stream::TELEMETRY: sendTelemetry(nowUs); break;
+    case Stream::COUNT:     break;
+    }
+}
+
+void RobotSimulator::broadcast(MessageType type, const std::string &payload, StreamCounters *counters)
+{
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+        const std::string &client = (it++)->first;   // sendTo() may erase it
+        sendTo(client, type, payload, counters);
+    }
+}
+
+void RobotSimulator::sendTo(const std::string &client, MessageType type, const std::string &payload,
+                            StreamCounters *counters)
+{
+    const auto typeByte = static_cast<uint8_t>(type);
+    try {
+        // A multipart message is queued whole or not at all, so only the first part can fail
+        if (!m_socket->send(zmq::buffer(client), zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
+            if (counters)
+                counters->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_socket->send(zmq::buffer(&typeByte, 1), zmq::send_flags::sndmore);
+        m_socket->send(zmq::buffer(payload), zmq::send_flags::none);
+    } catch (const zmq::error_t &e) {
+        if (e.num() == EHOSTUNREACH) {
+            const std::string gone = client;   // may refer to the map's own key
+            m_clients.erase(gone);
+            qInfo() << "[SIM] Client disconnected," << m_clients.size() << "left";
+            m_clientCount.store(m_clients.size(), std::memory_order_relaxed);
+        } else {
+            qWarning() << "[SIM] Send failed:" << e.what();
+        }
+        return;
+    }
+    if (counters) {
+        counters->sent.fetch_add(1, std::memory_order_relaxed);
+        counters->bytes.fetch_add(payload.size(), std::memory_order_relaxed);
+    }
+}
+
+void RobotSimulator::expireClients(int64_t nowUs)
+{
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+        if (nowUs - it->second > CLIENT_TIMEOUT_US) {
+            qInfo() << "[SIM] Client timed out";
+            it = m_clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_clientCount.store(m_clients.size(), std::memory_order_relaxed);
+}
+
+void RobotSimulator::encodeVideoFrames()
+{
+    m_videoFrames.clear();
+    const int width = std::max(16, m_config.videoWidth);
+    const int height = std::max(16, m_config.videoHeight);
+    const int frames = std::max(1, m_config.videoFrames);
+
+    // Gradient, moving bar and noise: compresses about like a camera image
+    uint32_t noise = 0x12345678u;
+    for (int f = 0; f < frames; ++f) {
+        QImage image(width, height, QImage::Format_RGB32);
+        const int barX = f * width / frames;
+        for (int y = 0; y < height; ++y) {
+            auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < width; ++x) {
+                noise = noise * 1664525u + 1013904223u;
+                const int n = static_cast<int>(noise >> 28);
+                const bool bar = std::abs(x - barX) < width / 16;
+                const int r = (x * 255 / width + n) & 0xFF;
+                const int g = (y * 255 / height + n) & 0xFF;
+                const int b = bar ? 255 : (((x ^ y) >> 3) & 1) * 64 + n;
+                line[x] = qRgb(r, g, b);
+            }
+        }
+
+        QByteArray jpeg;
+        QBuffer buffer(&jpeg);
+        buffer.open(QIODevice::WriteOnly);
+        if (!image.save(&buffer, "JPG", m_config.videoQuality)) {
+            qWarning() << "[SIM] JPEG encoding unavailable; video disabled";
+            m_videoFrames.clear();
+            setRate(Stream::VIDEO, 0.0);
+            return;
+        }
+        m_videoFrames.push_back(std::move(jpeg));
+    }
+
+    m_videoMessage.set_width(width);
+    m_videoMessage.set_height(height);
+    qInfo() << "[SIM]" << frames << "video frames of" << width << "x" << height << ","
+            << m_videoFrames.front().size() / 1024 << "KB each";
+}
+
+void RobotSimulator::buildMap()
+{
+    const int size = std::max(8, m_config.mapPixels);
+    std::string cells(static_cast<size_t>(size) * size, '\0');
+
+    // A walled room with a few pillars; 0 = free, 255 = obstacle
+    const int wall = std::max(1, size / 100);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const bool border = x < wall || y < wall || x >= size - wall || y >= size - wall;
+            const bool pillar = (x / (size / 8)) % 3 == 1 && (y / (size / 8)) % 3 == 1
+                                && x % (size / 8) < size / 32 && y % (size / 8) < size / 32;
+            if (border || pillar)
+                cells[static_cast<size_t>(y) * size + x] = static_cast<char>(255);
+        }
+    }
+
+    m_map.set_size_pixels(size);
+    m_map.set_size_meters(m_config.mapMeters);
+    m_map.set_data(std::move(cells));
+}
+
+void RobotSimulator::sendLidar(int64_t nowUs)
+{
+    const int points = std::max(1, m_config.lidarPoints);
+    const double t = (nowUs - m_startUs) / 1e6;
+
+    Command::LidarData lidar;
+    lidar.set_timestamp(robotTimeMs());
+    lidar.mutable_angles()->Reserve(points);
+    lidar.mutable_distances()->Reserve(points);
+    // Each revolution starts a little further round, so consecutive scans do not overlap exactly
+    const double start = (m_lidarSweep++ % 16) * (2.0 * PI / points / 16.0);
+    for (int i = 0; i < points; ++i) {
+        const double angle = std::remainder(start + 2.0 * PI * i / points, 2.0 * PI);
+        lidar.add_angles(static_cast<float>(angle));
+        lidar.add_distances(static_cast<float>(2.0 + std::sin(angle * 3.0 + t) * 0.8 + std::cos(angle * 7.0) * 0.3));
+    }
+    lidar.SerializeToString(&m_payload);
+    broadcast(MessageType::LIDAR_DATA, m_payload, &m_counters[static_cast<size_t>(Stream::LIDAR)]);
+}
+
+void RobotSimulator::sendGyro(int64_t nowUs)
+{
+    const double t = (nowUs - m_startUs) / 1e6;
+    MessageFactory::createGyroData(static_cast<float>(std::sin(t * 0.7) * 10.0),
+                                   static_cast<float>(std::cos(t * 0.5) * 5.0), robotTimeMs())
+        .SerializeToString(&m_payload);
+    broadcast(MessageType::GYRO_DATA, m_payload, &m_counters[static_cast<size_t>(Stream::GYRO)]);
+}
+
+void RobotSimulator::sendVideo()
+{
+    if (m_videoFrames.empty())
+        return;
+    const QByteArray &jpeg = m_videoFrames[m_videoIndex++ % m_videoFrames.size()];
+    m_videoMessage.set_timestamp(robotTimeMs());
+    m_videoMessage.set_data(jpeg.constData(), static_cast<size_t>(jpeg.size()));
+    m_videoMessage.SerializeToString(&m_payload);
+    broadcast(MessageType::VIDEO_FRAME, m_payload, &m_counters[static_cast<size_t>(Stream::VIDEO)]);
+}
+
+void RobotSimulator::sendBlob(int64_t nowUs)
+{
+    if (!m_blobTracking)
+        return;
+    const double t = (nowUs - m_startUs) / 1e6;
+    Command::BlobTrackingData blob;
+    blob.set_timestamp(robotTimeMs());
+    blob.set_blob_x(static_cast<float>(std::sin(t * 0.9) * 0.6));
+    blob.set_blob_y(static_cast<float>(std::cos(t * 0.6) * 0.4));
+    blob.set_blob_size(0.05f);
+    blob.set_frame_width(m_videoMessage.width());
+    blob.set_frame_height(m_videoMessage.height());
+    blob.SerializeToString(&m_payload);
+    broadcast(MessageType::OBJECT_TRACKING_DATA, m_payload, nullptr);
+}
+
+void RobotSimulator::sendPose(int64_t nowUs)
+{
+    const double phase = 2.0 * PI * (nowUs - m_startUs) / 1e6 / PATH_PERIOD_S;
+    const double heading = std::remainder(phase + PI / 2.0, 2.0 * PI) * 180.0 / PI;
+    const double centerMm = m_config.mapMeters * 500.0;
+    MessageFactory::createSlamPose(centerMm + std::cos(phase) * PATH_RADIUS_MM,
+                                   centerMm + std::sin(phase) * PATH_RADIUS_MM, heading, robotTimeMs())
+        .SerializeToString(&m_payload);
+    broadcast(MessageType::SLAM_POSE, m_payload, &m_counters[static_cast<size_t>(Stream::SLAM_POSE)]);
+}
+
+void RobotSimulator::sendMap()
+{
+    m_map.set_timestamp(robotTimeMs());
+    m_map.SerializeToString(&m_payload);
+    broadcast(MessageType::SLAM_MAP, m_payload, &m_counters[static_cast<size_t>(Stream::SLAM_MAP)]);
+}
+
+void RobotSimulator::sendTelemetry(int64_t nowUs)
+{
+    StreamCounters *counters = &m_counters[static_cast<size_t>(Stream::TELEMETRY)];
+    const double t = (nowUs - m_startUs) / 1e6;
+    const int metrics = std::max(0, m_config.telemetryMetrics);
+
+    for (int i = 0; i < metrics; ++i) {
+        Command::TelemetryUpdate telemetry;
+        switch (i) {
+        case 0: telemetry = MessageFactory::createTelemetryUpdate("battery_voltage", static_cast<float>(12.6 - t / 3600.0)); break;
+        case 1: telemetry = MessageFactory::createTelemetryUpdate("cpu_temperature", static_cast<float>(45.0 + std::sin(t / 10.0) * 3.0)); break;
+        case 2: telemetry = MessageFactory::createTelemetryUpdate("status", std::string("running")); break;
+        case 3: telemetry = MessageFactory::createTelemetryUpdate("robot_state", std::string(MessageConstants::STATE_MANUAL_CONTROL)); break;
+        default:
+            telemetry = MessageFactory::createTelemetryUpdate("sim_metric_" + std::to_string(i - 4), static_cast<int32_t>(t));
+            break;
+        }
+        telemetry.SerializeToString(&m_payload);
+        broadcast(MessageType::TELEMETRY_UPDATE, m_payload, counters);
+    }
+}
+
+} // namespace Spider2
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <QByteArray>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+#include "MessageTypes.hpp"
+
+namespace Spider2 {
+
+/**
+ * @brief Stand-in for the robot: a ROUTER socket producing synthetic traffic
+ *
+ * Speaks the protocol of from_server/PROTOCOL.md to any number of DEALER
+ * clients: answers heartbeats (stamped with the simulated robot clock),
+ * logs the commands it receives, and pushes lidar, gyro, video, SLAM and
+ * telemetry messages to every client seen within the last 30 s, each at its
+ * own rate. Rates can go far beyond the real robot's and can be changed
+ * while running, so a client can be driven up to its limit.
+ *
+ * Everything runs on one thread that owns the socket. Streams are scheduled
+ * against absolute due times, so a late wake-up is caught up (in bursts of
+ * at most MAX_BURST) instead of lowering the rate. Sends never block: when
+ * a client's send queue is full the message is counted as dropped, which is
+ * what the robot's non-blocking ROUTER would do.
+ *
+ * The endpoint can be any ZeroMQ transport. tcp:// measures the full network
+ * path, ipc:// removes the TCP stack, and inproc:// (with the client's
+ * context) leaves only the client's own cost.
+ */
+class RobotSimulator
+{
+public:
+    enum class Stream : uint8_t {
+        LIDAR = 0,
+        GYRO,
+        VIDEO,
+        SLAM_POSE,
+        SLAM_MAP,
+        TELEMETRY,
+        COUNT
+    };
+
+    struct Config {
+        std::string endpoint{"tcp://*:5555"};
+        /// @brief Messages per second, indexed by Stream; 0 = off
+        std::array<double, static_cast<size_t>(Stream::COUNT)> rates{10.0, 10.0, 30.0, 8.0, 0.5, 1.0};
+        int lidarPoints{16};                 ///< Samples per LIDAR_DATA message (one revolution)
+        int videoWidth{640};
+        int videoHeight{480};
+        int videoQuality{80};                ///< JPEG quality, 0..100
+        int videoFrames{30};                 ///< Distinct pre-encoded frames, sent in a loop
+        int mapPixels{400};                  ///< SLAM_MAP edge length
+        double mapMeters{20.0};
+        int telemetryMetrics{4};             ///< Metrics per telemetry burst; beyond the standard four they are "sim_metric_N"
+        int64_t clockOffsetMs{0};            ///< Robot clock − local clock, to exercise ClockSync
+        bool logCommands{true};
+
+        /// @brief Set videoWidth and videoHeight from "WIDTHxHEIGHT"; false (size unchanged) if malformed
+        bool setVideoSize(const std::string &text);
+    };
+
+    struct StreamStats {
+        uint64_t sent{0};                    ///< Messages handed to ZeroMQ (per client)
+        uint64_t dropped{0};                 ///< Messages a full client queue refused
+        uint64_t bytes{0};
+    };
+
+    struct Stats {
+        std::array<StreamStats, static_cast<size_t>(Stream::COUNT)> streams;
+        uint64_t heartbeats{0};              ///< Heartbeats received
+        uint64_t commands{0};                ///< Other messages received
+        size_t clients{0};
+    };
+
+    RobotSimulator();
+    ~RobotSimulator();
+
+    RobotSimulator(const RobotSimulator &) = delete;
+    RobotSimulator &operator=(const RobotSimulator &) = delete;
+
+    /**
+     * @brief Bind and start producing traffic
+     * @param context Must outlive stop(); pass the client's context for inproc://
+     * @return false (with a warning) if the endpoint cannot be bound
+     */
+    bool start(zmq::context_t &context, const Config &config);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /// @brief Any thread; takes effect with the stream's next message
+    void setRate(Stream stream, double messagesPerSecond);
+    double rate(Stream stream) const;
+
+    /// @brief Cumulative since start()
+    Stats stats() const;
+
+    static const char *streamName(Stream stream);
+    /// @brief Inverse of streamName(); false for unknown names
+    static bool streamFromName(const std::string &name, Stream &stream);
+
+    static constexpr int MAX_BURST = 64;                     ///< Catch-up sends per stream and wake-up
+    static constexpr int64_t CLIENT_TIMEOUT_US = 30'000'000; ///< PROTOCOL.md: no message for 30 s = gone
+    static constexpr int64_t HEARTBEAT_INTERVAL_US = 5'000'000;
+
+private:
+    struct StreamCounters {
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    void run();
+    void receive();
+    void handleMessage(const std::string &client, MessageType type, const zmq::message_t &payload);
+    void produce(Stream stream, int64_t nowUs);
+    void broadcast(MessageType type, const std::string &payload, StreamCounters *counters);
+    void sendTo(const std::string &client, MessageType type, const std::string &payload, StreamCounters *counters);
+    void expireClients(int64_t nowUs);
+    int64_t robotTimeMs() const;
+
+    void encodeVideoFrames();
+    void buildMap();
+    void sendLidar(int64_t nowUs);
+    void sendGyro(int64_t nowUs);
+    void sendVideo();
+    void sendPose(int64_t nowUs);
+    void sendMap();
+    void sendTelemetry(int64_t nowUs);
+    void sendBlob(int64_t nowUs);
+
+    Config m_config;
+    std::unique_ptr<zmq::socket_t> m_socket;  // used only by the simulator thread once it runs
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::array<std::atomic<double>, static_cast<size_t>(Stream::COUNT)> m_rates{};
+
+    // Simulator-thread state
+    std::map<std::string, int64_t> m_clients;   // identity → last message, steady µs
+    std::array<int64_t, static_cast<size_t>(Stream::COUNT)> m_dueUs{};
+    int64_t m_heartbeatDueUs{0};
+    int64_t m_startUs{0};
+    std::vector<QByteArray> m_videoFrames;      // pre-encoded JPEGs
+    size_t m_videoIndex{0};
+    Command::SlamMap m_map;
+    Command::VideoFrame m_videoMessage;
+    std::string m_payload;                      // reused serialization buffer
+    bool m_blobTracking{false};
+    uint32_t m_lidarSweep{0};
+
+    std::array<StreamCounters, static_cast<size_t>(Stream::COUNT)> m_counters;
+    std::atomic<uint64_t> m_heartbeats{0};
+    std::atomic<uint64_t> m_commands{0};
+    std::atomic<size_t> m_clientCount{0};
+};
+
+} // namespace Spider2
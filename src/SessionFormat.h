@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Spider2 {
+
+/**
+ * @brief On-disk layout of a recorded session (.s2rec)
+ *
+ *   FileHeader
+ *   { ChunkHeader, chunk bytes }*          chunk bytes: { RecordHeader, payload }*,
+ *                                          qCompress()ed when CHUNK_COMPRESSED is set
+ *   IndexEntry[chunkCount]                 written on a clean close
+ *   Trailer
+ *
+ * Every chunk header carries the time range and the set of message types of
+ * its records, so the index is just the chunk headers collected at the end:
+ * a reader finds the chunk for any time with a binary search and never has
+ * to touch payload bytes it does not need. A file without a trailer (the
+ * recorder was killed) is indexed by hopping from chunk header to chunk
+ * header instead.
+ *
+ * Keyframe chunks (CHUNK_KEYFRAME, version 2) repeat the frames that make up
+ * the client state at their timestamp (see KeyframePolicy). They are skipped
+ * by normal playback; a seek applies the nearest one and replays only what
+ * was recorded after it.
+ *
+ * All fields are little-endian, the native order of every platform we run on;
+ * structs are written as-is.
+ */
+namespace SessionFormat {
+
+constexpr char FILE_MAGIC[8] = {'S', 'P', '2', 'R', 'E', 'C', '\0', '\0'};
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;   // "CHNK"
+constexpr uint32_t TRAILER_MAGIC = 0x58444E49; // "INDX"
+
+/// @brief ChunkHeader::flags
+constexpr uint32_t CHUNK_COMPRESSED = 1u << 0;
+constexpr uint32_t CHUNK_KEYFRAME = 1u << 1;    ///< State snapshot; firstUs == lastUs == snapshot time
+
+/// @brief ChunkHeader::typeMask bit for a message type; types ≥ 31 share the last bit
+constexpr uint32_t typeBit(uint8_t type)
+{
+    return 1u << (type < 31 ? type : 31);
+}
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    int64_t createdUs;      ///< Local wall clock, µs since the epoch
+    uint64_t reserved;
+};
+
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t flags;
+    int64_t firstUs;        ///< receivedUs of the first record
+    int64_t lastUs;         ///< receivedUs of the last record
+    uint32_t frameCount;
+    uint32_t typeMask;      ///< typeBit() of every record type in the chunk
+    uint32_t rawSize;       ///< Record bytes after decompression
+    uint32_t storedSize;    ///< Bytes following this header
+};
+
+struct RecordHeader {
+    int64_t receivedUs;     ///< RawFrame::receivedUs; never decreases within a file
+    uint32_t size;          ///< Payload bytes following this header
+    uint8_t type;           ///< Spider2::MessageType
+    uint8_t reserved[3];
+};
+
+struct IndexEntry {
+    uint64_t offset;        ///< File offset of the ChunkHeader
+    int64_t firstUs;
+    int64_t lastUs;
+    uint32_t frameCount;
+    uint32_t typeMask;
+    uint32_t flags;         ///< ChunkHeader::flags
+    uint32_t reserved;
+};
+
+/// @brief Index entry of version 1 files (no keyframes)
+struct IndexEntryV1 {
+    uint64_t offset;
+    int64_t firstUs;
+    int64_t lastUs;
+    uint32_t frameCount;
+    uint32_t typeMask;
+};
+
+struct Trailer {
+    uint64_t indexOffset;
+    uint32_t chunkCount;
+    uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout");
+static_assert(sizeof(ChunkHeader) == 40, "ChunkHeader layout");
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader layout");
+static_assert(sizeof(IndexEntry) == 40, "IndexEntry layout");
+static_assert(sizeof(IndexEntryV1) == 32, "IndexEntryV1 layout");
+static_assert(sizeof(Trailer) == 16, "Trailer layout");
+
+} // namespace SessionFormat
+
+} // namespace Spider2
@@ -0,0 +1,226 @@
+#include "SessionReader.h"
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+
+namespace Spider2 {
+
+struct SessionReader::Mapping {
+    QFile file;
+    uchar *data{nullptr};
+
+    ~Mapping()
+    {
+        if (data)
+            file.unmap(data);
+    }
+};
+
+namespace {
+
+template <typename T>
+T readAt(const uchar *base, uint64_t offset)
+{
+    T value;
+    std::memcpy(&value, base + offset, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+SessionReader::~SessionReader()
+{
+    close();
+}
+
+bool SessionReader::open(const QString &path)
+{
+    close();
+
+    auto mapping = std::make_shared<Mapping>();
+    mapping->file.setFileName(path);
+    if (!mapping->file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[SESSION] Cannot open" << path << ":" << mapping->file.errorString();
+        return false;
+    }
+
+    const qint64 size = mapping->file.size();
+    if (size < static_cast<qint64>(sizeof(SessionFormat::FileHeader))) {
+        qWarning() << "[SESSION]" << path << "is not a recorded session";
+        return false;
+    }
+    mapping->data = mapping->file.map(0, size);
+    if (!mapping->data) {
+        qWarning() << "[SESSION] Cannot map" << path << ":" << mapping->file.errorString();
+        return false;
+    }
+
+    const auto header = readAt<SessionFormat::FileHeader>(mapping->data, 0);
+    // Version 1 differs only in its index entries
+    if (std::memcmp(header.magic, SessionFormat::FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version < 1 || header.version > SessionFormat::VERSION) {
+        qWarning() << "[SESSION]" << path << "is not a supported session (version" << header.version << ")";
+        return false;
+    }
+
+    m_path = path;
+    m_mapping = std::move(mapping);
+    m_data = m_mapping->data;
+    m_size = static_cast<uint64_t>(size);
+    m_version = header.version;
+
+    if (!loadIndex()) {
+        rebuildIndex();
+        m_recovered = true;
+        qWarning() << "[SESSION]" << path << "was not closed cleanly; recovered" << m_index.size() << "chunks";
+    }
+
+    m_frameCount = 0;
+    for (size_t i = 0; i < m_index.size(); ++i) {
+        if (isKeyframe(i))
+            m_keyframes.push_back(i);
+        else
+            m_frameCount += m_index[i].frameCount;
+    }
+    return true;
+}
+
+void SessionReader::close()
+{
+    m_mapping.reset();
+    m_data = nullptr;
+    m_size = 0;
+    m_index.clear();
+    m_keyframes.clear();
+    m_version = 0;
+    m_frameCount = 0;
+    m_recovered = false;
+    m_path.clear();
+}
+
+bool SessionReader::loadIndex()
+{
+    using namespace SessionFormat;
+
+    if (m_size < sizeof(FileHeader) + sizeof(Trailer))
+        return false;
+    const auto trailer = readAt<Trailer>(m_data, m_size - sizeof(Trailer));
+    if (trailer.magic != TRAILER_MAGIC)
+        return false;
+    const size_t entrySize = m_version == 1 ? sizeof(IndexEntryV1) : sizeof(IndexEntry);
+    const uint64_t indexBytes = static_cast<uint64_t>(trailer.chunkCount) * entrySize;
+    if (trailer.indexOffset < sizeof(FileHeader) || trailer.indexOffset + indexBytes + sizeof(Trailer) != m_size)
+        return false;
+
+    m_index.resize(trailer.chunkCount);
+    if (m_version == 1) {
+        for (uint32_t i = 0; i < trailer.chunkCount; ++i) {
+            const auto v1 = readAt<IndexEntryV1>(m_data, trailer.indexOffset + i * entrySize);
+            m_index[i] = IndexEntry{v1.offset, v1.firstUs, v1.lastUs, v1.frameCount, v1.typeMask, 0, 0};
+        }
+    } else if (indexBytes > 0) {
+        std::memcpy(m_index.data(), m_data + trailer.indexOffset, indexBytes);
+    }
+    return true;
+}
+
+void SessionReader::rebuildIndex()
+{
+    using namespace SessionFormat;
+
+    m_index.clear();
+    uint64_t offset = sizeof(FileHeader);
+    while (offset + sizeof(ChunkHeader) <= m_size) {
+        const auto header = readAt<ChunkHeader>(m_data, offset);
+        const uint64_t end = offset + sizeof(ChunkHeader) + header.storedSize;
+        // The last chunk may have been cut off mid-write
+        if (header.magic != CHUNK_MAGIC || end > m_size)
+            break;
+        m_index.push_back(IndexEntry{offset, header.firstUs, header.lastUs, header.frameCount, header.typeMask,
+                                     header.flags, 0});
+        offset = end;
+    }
+}
+
+int64_t SessionReader::startUs() const
+{
+    return m_index.empty() ? 0 : m_index.front().firstUs;
+}
+
+int64_t SessionReader::endUs() const
+{
+    return m_index.empty() ? 0 : m_index.back().lastUs;
+}
+
+size_t SessionReader::findChunk(int64_t us) const
+{
+    const auto it = std::lower_bound(m_index.begin(), m_index.end(), us,
+                                     [](const SessionFormat::IndexEntry &entry, int64_t t) { return entry.lastUs < t; });
+    return static_cast<size_t>(it - m_index.begin());
+}
+
+size_t SessionReader::findKeyframe(int64_t us) const
+{
+    const auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), us,
+                                     [this](int64_t t, size_t index) { return t < m_index[index].lastUs; });
+    return it == m_keyframes.begin() ? m_index.size() : *(it - 1);
+}
+
+bool SessionReader::readChunk(size_t index, std::vector<RawFrame> &frames) const
+{
+    using namespace SessionFormat;
+
+    if (index >= m_index.size())
+        return false;
+
+    const uint64_t offset = m_index[index].offset;
+    if (offset + sizeof(ChunkHeader) > m_size)
+        return false;
+    const auto header = readAt<ChunkHeader>(m_data, offset);
+    if (header.magic != CHUNK_MAGIC || offset + sizeof(ChunkHeader) + header.storedSize > m_size) {
+        qWarning() << "[SESSION] Corrupt chunk" << index << "in" << m_path;
+        return false;
+    }
+
+    const char *records = reinterpret_cast<const char *>(m_data + offset + sizeof(ChunkHeader));
+    std::shared_ptr<const void> owner = m_mapping;
+    if (header.flags & CHUNK_COMPRESSED) {
+        auto unpacked = std::make_shared<QByteArray>(
+            qUncompress(reinterpret_cast<const uchar *>(records), static_cast<qsizetype>(header.storedSize)));
+        if (static_cast<uint64_t>(unpacked->size()) != header.rawSize) {
+            qWarning() << "[SESSION] Cannot decompress chunk" << index << "in" << m_path;
+            return false;
+        }
+        records = unpacked->constData();
+        owner = std::move(unpacked);
+    } else if (header.storedSize != header.rawSize) {
+        qWarning() << "[SESSION] Corrupt chunk" << index << "in" << m_path;
+        return false;
+    }
+
+    frames.reserve(frames.size() + header.frameCount);
+    uint64_t pos = 0;
+    for (uint32_t i = 0; i < header.frameCount; ++i) {
+        if (pos + sizeof(RecordHeader) > header.rawSize)
+            return false;
+        RecordHeader record;
+        std::memcpy(&record, records + pos, sizeof(record));
+        pos += sizeof(RecordHeader);
+        if (pos + record.size > header.rawSize)
+            return false;
+
+        RawFrame frame;
+        frame.type = record.type;
+        frame.data = records + pos;
+        frame.size = record.size;
+        frame.owner = owner;
+        frame.receivedUs = record.receivedUs;
+        frames.push_back(std::move(frame));
+        pos += record.size;
+    }
+    return true;
+}
+
+} // namespace Spider2
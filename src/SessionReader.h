@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "RawFrame.h"
+#include "SessionFormat.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Random access to a recorded session through a memory mapping
+ *
+ * open() maps the whole file and loads the chunk index from the trailer (or
+ * rebuilds it from the chunk headers when the recording was cut short), so
+ * opening is independent of the file size. Payload pages are only faulted in
+ * when a chunk is read.
+ *
+ * Frames returned by readChunk() point straight into the mapping, or into
+ * the chunk's decompressed copy, and keep it alive through RawFrame::owner
+ * after the reader is closed or destroyed.
+ */
+class SessionReader
+{
+public:
+    SessionReader() = default;
+    ~SessionReader();
+
+    SessionReader(const SessionReader &) = delete;
+    SessionReader &operator=(const SessionReader &) = delete;
+
+    /// @brief False (with a warning) if the file is missing or not a session
+    bool open(const QString &path);
+    void close();
+
+    bool isOpen() const { return m_mapping != nullptr; }
+    QString path() const { return m_path; }
+    /// @brief True when the index had to be rebuilt because the trailer is missing
+    bool recovered() const { return m_recovered; }
+
+    size_t chunkCount() const { return m_index.size(); }
+    const SessionFormat::IndexEntry &chunk(size_t index) const { return m_index[index]; }
+    uint64_t frameCount() const { return m_frameCount; }
+    /// @brief receivedUs of the first / last frame; 0 when empty
+    int64_t startUs() const;
+    int64_t endUs() const;
+
+    /// @brief First chunk that ends at or after @p us; chunkCount() when there is none
+    size_t findChunk(int64_t us) const;
+
+    bool isKeyframe(size_t index) const { return m_index[index].flags & SessionFormat::CHUNK_KEYFRAME; }
+    size_t keyframeCount() const { return m_keyframes.size(); }
+    /// @brief Newest keyframe chunk taken at or before @p us; chunkCount() when there is none
+    size_t findKeyframe(int64_t us) const;
+
+    /// @brief Append the frames of chunk @p index to @p frames, in recording order
+    bool readChunk(size_t index, std::vector<RawFrame> &frames) const;
+
+private:
+    struct Mapping;
+
+    bool loadIndex();
+    void rebuildIndex();
+
+    QString m_path;
+    std::shared_ptr<Mapping> m_mapping;
+    const uchar *m_data{nullptr};
+    uint64_t m_size{0};
+    std::vector<SessionFormat::IndexEntry> m_index;
+    std::vector<size_t> m_keyframes;        // chunk indices, in time order
+    uint32_t m_version{0};
+    uint64_t m_frameCount{0};
+    bool m_recovered{false};
+};
+
+} // namespace Spider2
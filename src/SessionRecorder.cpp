@@ -0,0 +1,361 @@
+#include "SessionRecorder.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include "MessageTypes.hpp"
+#include "ParseContext.h"
+#include "ThreadName.h"
+
+namespace Spider2 {
+
+namespace {
+
+int64_t wallClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t steadyUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void appendBytes(std::vector<char> &buffer, const T &value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+} // namespace
+
+SessionRecorder::SessionRecorder(size_t queueCapacity, size_t queueBytes)
+    : m_queue(queueCapacity)
+    , m_queueBytesLimit(queueBytes)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+bool SessionRecorder::start(const QString &path, const Options &options)
+{
+    stop();
+
+    // Frames a straggling record() pushed after the previous writer exited
+    RawFrame stale;
+    while (m_queue.tryPop(stale)) {}
+    m_queuedBytes.store(0, std::memory_order_relaxed);
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        qWarning() << "[RECORDER] Cannot create" << path << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_options = options;
+    m_path = path;
+    m_chunk.clear();
+    m_chunk.reserve(sizeof(SessionFormat::ChunkHeader) + m_options.chunkBytes);
+    m_chunkHeader = SessionFormat::ChunkHeader();
+    m_index.clear();
+    m_lastRecordedUs = 0;
+    m_clockStepUs = 0;
+    m_failed = false;
+    for (auto &frames : m_stateFrames)
+        frames.clear();
+    m_stateByName.clear();
+    m_lastKeyframeUs = 0;
+    m_frames.store(0, std::memory_order_relaxed);
+    m_bytes.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_fileBytes.store(0, std::memory_order_relaxed);
+    m_keyframes.store(0, std::memory_order_relaxed);
+
+    SessionFormat::FileHeader header{};
+    std::memcpy(header.magic, SessionFormat::FILE_MAGIC, sizeof(header.magic));
+    header.version = SessionFormat::VERSION;
+    header.createdUs = wallClockUs();
+    if (!write(&header, sizeof(header))) {
+        m_file.close();
+        return false;
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_writer = std::thread(&SessionRecorder::writerLoop, this);
+    m_active.store(true, std::memory_order_release);
+
+    qInfo() << "[RECORDER] Recording to" << path << (m_options.compress ? "(compressed)" : "");
+    return true;
+}
+
+void SessionRecorder::stop()
+{
+    if (!m_writer.joinable())
+        return;
+
+    m_active.store(false, std::memory_order_release);
+    m_running.store(false, std::memory_order_release);
+    m_writer.join();
+
+    const Stats s = stats();
+    qInfo() << "[RECORDER] Stopped:" << s.frames << "frames," << s.fileBytes << "bytes written,"
+            << s.dropped << "dropped";
+}
+
+void SessionRecorder::record(const RawFrame &frame)
+{
+    if (!m_active.load(std::memory_order_acquire))
+        return;
+
+    // The writer only ever lowers the count, so checking before adding cannot overshoot
+    if (m_queuedBytes.load(std::memory_order_relaxed) + frame.size > m_queueBytesLimit) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Shares the receive buffer; the writer copies it into its chunk
+    RawFrame queued = frame;
+    m_queuedBytes.fetch_add(frame.size, std::memory_order_relaxed);
+    if (!m_queue.tryPush(std::move(queued))) {
+        m_queuedBytes.fetch_sub(frame.size, std::memory_order_relaxed);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SessionRecorder::Stats SessionRecorder::stats() const
+{
+    Stats s;
+    s.frames = m_frames.load(std::memory_order_relaxed);
+    s.bytes = m_bytes.load(std::memory_order_relaxed);
+    s.dropped = m_dropped.load(std::memory_order_relaxed);
+    s.fileBytes = m_fileBytes.load(std::memory_order_relaxed);
+    s.keyframes = m_keyframes.load(std::memory_order_relaxed);
+    s.queueDepth = m_queue.sizeApprox();
+    s.queuedBytes = m_queuedBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+void SessionRecorder::writerLoop()
+{
+    setCurrentThreadName("s2-record");
+    RawFrame frame;
+    while (true) {
+        // Read before draining: everything queued before stop() is written below
+        const bool running = m_running.load(std::memory_order_acquire);
+
+        size_t drained = 0;
+        while (m_queue.tryPop(frame)) {
+            m_queuedBytes.fetch_sub(frame.size, std::memory_order_relaxed);
+            frame.receivedUs = monotonicUs(frame.receivedUs);
+            append(frame);
+            frame = RawFrame();
+            ++drained;
+        }
+        if (!running)
+            break;
+
+        if (m_chunkHeader.frameCount > 0 && steadyUs() - m_chunkStartedUs >= FLUSH_INTERVAL_US) {
+            writeChunk();
+        }
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    writeChunk();
+    writeIndex();
+    m_file.close();
+
+    // Release the receive buffers the state snapshot still references
+    for (auto &frames : m_stateFrames)
+        frames.clear();
+    m_stateByName.clear();
+}
+
+int64_t SessionRecorder::monotonicUs(int64_t receivedUs)
+{
+    const int64_t us = receivedUs + m_clockStepUs;
+    if (us < m_lastRecordedUs) {
+        const int64_t stepUs = m_lastRecordedUs - us;
+        if (stepUs >= 1000) {
+            qWarning() << "[RECORDER] Clock stepped back by" << stepUs / 1000 << "ms, shifting later frames";
+        }
+        m_clockStepUs += stepUs;
+        return m_lastRecordedUs;
+    }
+    m_lastRecordedUs = us;
+    return us;
+}
+
+void SessionRecorder::append(const RawFrame &frame)
+{
+    const size_t recordBytes = sizeof(SessionFormat::RecordHeader) + frame.size;
+    if (m_failed || recordBytes > std::numeric_limits<uint32_t>::max() - sizeof(SessionFormat::ChunkHeader)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (m_chunkHeader.frameCount > 0
+        && m_chunk.size() - sizeof(SessionFormat::ChunkHeader) + recordBytes > m_options.chunkBytes) {
+        writeChunk();
+    }
+
+    appendRecord(frame);
+    track(frame);
+
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    m_bytes.fetch_add(frame.size, std::memory_order_relaxed);
+}
+
+void SessionRecorder::appendRecord(const RawFrame &frame)
+{
+    if (m_chunkHeader.frameCount == 0) {
+        // Header placeholder, filled in by writeChunk() so a chunk goes out in one write
+        m_chunk.assign(sizeof(SessionFormat::ChunkHeader), '\0');
+        m_chunkHeader.firstUs = frame.receivedUs;
+        m_chunkStartedUs = steadyUs();
+    }
+
+    SessionFormat::RecordHeader record{};
+    record.receivedUs = frame.receivedUs;
+    record.size = static_cast<uint32_t>(frame.size);
+    record.type = frame.type;
+    appendBytes(m_chunk, record);
+    if (frame.size > 0) {
+        m_chunk.insert(m_chunk.end(), frame.data, frame.data + frame.size);
+    }
+
+    m_chunkHeader.lastUs = frame.receivedUs;
+    m_chunkHeader.frameCount += 1;
+    m_chunkHeader.typeMask |= SessionFormat::typeBit(frame.type);
+}
+
+void SessionRecorder::track(const RawFrame &frame)
+{
+    const uint32_t depth = m_options.keyframes.depthOf(frame.type);
+    if (depth == 0)
+        return;
+
+    if (depth == KeyframePolicy::PER_NAME) {
+        if (frame.type != static_cast<uint8_t>(MessageType::TELEMETRY_UPDATE))
+            return;
+        if (const Command::TelemetryUpdate *telemetry = ParseContext::local().parseTelemetry(frame.data, frame.size))
+            m_stateByName[telemetry->name()] = frame;
+        return;
+    }
+
+    std::deque<RawFrame> &frames = m_stateFrames[frame.type];
+    frames.push_back(frame);
+    while (frames.size() > depth)
+        frames.pop_front();
+}
+
+void SessionRecorder::writeKeyframe()
+{
+    std::vector<const RawFrame *> state;
+    for (const auto &frames : m_stateFrames) {
+        for (const RawFrame &frame : frames)
+            state.push_back(&frame);
+    }
+    for (const auto &entry : m_stateByName)
+        state.push_back(&entry.second);
+    if (state.empty())
+        return;
+
+    // Applied in arrival order on seek, like the original traffic
+    std::stable_sort(state.begin(), state.end(),
+                     [](const RawFrame *a, const RawFrame *b) { return a->receivedUs < b->receivedUs; });
+    for (const RawFrame *frame : state)
+        appendRecord(*frame);
+
+    m_chunkHeader.firstUs = m_lastKeyframeUs;
+    m_chunkHeader.lastUs = m_lastKeyframeUs;
+    writeChunk(SessionFormat::CHUNK_KEYFRAME);
+    m_keyframes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SessionRecorder::writeChunk(uint32_t flags)
+{
+    if (m_chunkHeader.frameCount == 0)
+        return;
+
+    SessionFormat::ChunkHeader header = m_chunkHeader;
+    header.magic = SessionFormat::CHUNK_MAGIC;
+    header.flags = flags;
+    header.rawSize = static_cast<uint32_t>(m_chunk.size() - sizeof(SessionFormat::ChunkHeader));
+    header.storedSize = header.rawSize;
+
+    SessionFormat::IndexEntry entry{};
+    entry.offset = m_fileBytes.load(std::memory_order_relaxed);
+    entry.firstUs = header.firstUs;
+    entry.lastUs = header.lastUs;
+    entry.frameCount = header.frameCount;
+    entry.typeMask = header.typeMask;
+    bool written = false;
+
+    if (m_options.compress) {
+        // Fastest zlib level: the writer has to keep up with the link
+        const QByteArray packed = qCompress(reinterpret_cast<const uchar *>(m_chunk.data()) + sizeof(header),
+                                            static_cast<qsizetype>(header.rawSize), 1);
+        if (!packed.isEmpty() && static_cast<size_t>(packed.size()) < header.rawSize) {
+            header.flags |= SessionFormat::CHUNK_COMPRESSED;
+            header.storedSize = static_cast<uint32_t>(packed.size());
+            written = write(&header, sizeof(header)) && write(packed.constData(), packed.size());
+        }
+    }
+    if (!(header.flags & SessionFormat::CHUNK_COMPRESSED)) {
+        std::memcpy(m_chunk.data(), &header, sizeof(header));
+        written = write(m_chunk.data(), m_chunk.size());
+    }
+
+    if (written) {
+        entry.flags = header.flags;
+        m_index.push_back(entry);
+    }
+    m_chunk.clear();
+    m_chunkHeader = SessionFormat::ChunkHeader();
+
+    // A keyframe follows the data chunk that completes its state
+    if (!(flags & SessionFormat::CHUNK_KEYFRAME) && !m_options.keyframes.isEmpty()
+        && header.lastUs - m_lastKeyframeUs >= m_options.keyframeIntervalUs) {
+        m_lastKeyframeUs = header.lastUs;
+        writeKeyframe();
+    }
+}
+
+void SessionRecorder::writeIndex()
+{
+    SessionFormat::Trailer trailer{};
+    trailer.indexOffset = m_fileBytes.load(std::memory_order_relaxed);
+    trailer.chunkCount = static_cast<uint32_t>(m_index.size());
+    trailer.magic = SessionFormat::TRAILER_MAGIC;
+
+    if (!m_index.empty()) {
+        write(m_index.data(), m_index.size() * sizeof(SessionFormat::IndexEntry));
+    }
+    write(&trailer, sizeof(trailer));
+}
+
+bool SessionRecorder::write(const void *data, size_t size)
+{
+    if (m_failed)
+        return false;
+
+    const qint64 written = m_file.write(static_cast<const char *>(data), static_cast<qint64>(size));
+    if (written != static_cast<qint64>(size)) {
+        qWarning() << "[RECORDER] Write to" << m_path << "failed:" << m_file.errorString();
+        m_failed = true;
+        return false;
+    }
+    m_fileBytes.fetch_add(size, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace Spider2
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "KeyframePolicy.h"
+#include "RawFrame.h"
+#include "SessionFormat.h"
+#include "SpscQueue.h"
+
+namespace Spider2 {
+
+/**
+ * @brief Append-only recorder of raw robot traffic (see SessionFormat.h)
+ *
+ * record() runs on the receive thread and only hands the frame, which still
+ * references its receive buffer, to an SpscQueue; it never copies, allocates
+ * or touches the file. A dedicated writer thread packs the frames into a
+ * preallocated chunk buffer, optionally compresses each full chunk and
+ * writes it, header included, with a single unbuffered write. Chunks are
+ * also cut every FLUSH_INTERVAL_US, so a crash loses at most that much.
+ *
+ * With a KeyframePolicy set, the writer also keeps the frames that make up
+ * the current client state and, every keyframeIntervalUs of recorded time,
+ * writes them as a keyframe chunk right after a data chunk.
+ *
+ * Every queued frame pins its receive buffer, so the queue is bounded by the
+ * payload bytes in flight as well as by frame count. Should the disk fall
+ * behind further than that, frames are dropped and counted rather than
+ * stalling the link or piling up memory.
+ *
+ * Record timestamps never go backwards within a file, even if the wall clock
+ * they come from is stepped back (NTP): the writer shifts later frames by the
+ * step, so the chunk time ranges stay sorted for SessionReader's search.
+ */
+class SessionRecorder
+{
+public:
+    struct Options {
+        bool compress{false};               ///< qCompress() every chunk (pays off for telemetry-heavy runs, not JPEG)
+        size_t chunkBytes{4 * 1024 * 1024}; ///< Record bytes per chunk; a larger frame gets a chunk of its own
+        KeyframePolicy keyframes;           ///< Empty = no keyframes
+        int64_t keyframeIntervalUs{5'000'000};
+    };
+
+    struct Stats {
+        uint64_t frames{0};
+        uint64_t bytes{0};                  ///< Payload bytes recorded
+        uint64_t dropped{0};
+        uint64_t fileBytes{0};
+        uint64_t keyframes{0};
+        size_t queueDepth{0};
+        size_t queuedBytes{0};              ///< Payload bytes waiting for the writer
+    };
+
+    /// @brief Up to @p queueCapacity frames holding up to @p queueBytes of payload may be in flight to the writer
+    explicit SessionRecorder(size_t queueCapacity = 16384, size_t queueBytes = 64 * 1024 * 1024);
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder &) = delete;
+    SessionRecorder &operator=(const SessionRecorder &) = delete;
+
+    /// @brief Create @p path and start the writer. False (with a warning) if the file cannot be created.
+    bool start(const QString &path, const Options &options);
+    bool start(const QString &path) { return start(path, Options()); }
+    /// @brief Write what is queued, the index and the trailer, then close the file
+    void stop();
+
+    bool isRecording() const { return m_active.load(std::memory_order_acquire); }
+    QString path() const { return m_path; }
+
+    /// @brief Receive thread only. Never blocks.
+    void record(const RawFrame &frame);
+
+    /// @brief Cumulative since start()
+    Stats stats() const;
+
+    static constexpr int64_t FLUSH_INTERVAL_US = 1'000'000;
+
+private:
+    void writerLoop();
+    int64_t monotonicUs(int64_t receivedUs);
+    void append(const RawFrame &frame);
+    void appendRecord(const RawFrame &frame);
+    void track(const RawFrame &frame);
+    void writeChunk(uint32_t flags = 0);
+    void writeKeyframe();
+    void writeIndex();
+    bool write(const void *data, size_t size);
+
+    Options m_options;
+    QString m_path;
+    QFile m_file;
+    SpscQueue<RawFrame> m_queue;              // receive thread → writer; lives as long as the recorder
+    const size_t m_queueBytesLimit;
+    std::atomic<size_t> m_queuedBytes{0};     // payload bytes pinned by m_queue
+    std::thread m_writer;
+    std::atomic<bool> m_active{false};
+    std::atomic<bool> m_running{false};
+
+    // Writer-thread state
+    std::vector<char> m_chunk;                // ChunkHeader placeholder + records
+    SessionFormat::ChunkHeader m_chunkHeader{};
+    int64_t m_chunkStartedUs{0};
+    int64_t m_lastRecordedUs{0};              // newest timestamp written
+    int64_t m_clockStepUs{0};                 // added to receivedUs to undo backward clock steps
+    std::vector<SessionFormat::IndexEntry> m_index;
+    bool m_failed{false};
+
+    // Writer-thread state: frames of the current client state, per KeyframePolicy
+    std::array<std::deque<RawFrame>, 32> m_stateFrames;
+    std::unordered_map<std::string, RawFrame> m_stateByName;
+    int64_t m_lastKeyframeUs{0};
+
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_fileBytes{0};
+    std::atomic<uint64_t> m_keyframes{0};
+};
+
+} // namespace Spider2
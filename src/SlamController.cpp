@@ -1,77 +1,122 @@
 #include "SlamController.h"
-#include "MapProvider.h"
+#include <cmath>
 
 SlamController::SlamController(QObject *parent)
     : QObject(parent)
 {
 }
 
-void SlamController::setMapProvider(MapProvider *provider)
-{
-    m_mapProvider = provider;
-}
-
 void SlamController::updatePose(double x_mm, double y_mm, double theta_deg)
 {
     m_posX = x_mm;
     m_posY = y_mm;
     m_posTheta = theta_deg;
     m_hasData = true;
+    const bool moved = m_trail.append(static_cast<float>(x_mm), static_cast<float>(y_mm));
 
     emit posXChanged();
     emit posYChanged();
     emit posThetaChanged();
     emit hasDataChanged();
+    if (moved)
+        emit trailChanged();
 }
 
-void SlamController::updateMap(int sizePixels, double sizeMeters, const QByteArray &data)
+void SlamController::restoreTrail(const std::vector<Spider2::PoseTrail::Point> &points)
 {
-    m_mapSizePixels = sizePixels;
-    m_mapSizeMeters = sizeMeters;
+    m_trail.restore(points);
+    emit trailChanged();
+}
 
-    if (sizePixels > 0 && data.size() >= sizePixels * sizePixels) {
-        QImage image(sizePixels, sizePixels, QImage::Format_ARGB32_Premultiplied);
-        for (int y = 0; y < sizePixels; ++y) {
-            const uint8_t *src = reinterpret_cast<const uint8_t *>(data.constData()) + y * sizePixels;
-            QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
-            for (int x = 0; x < sizePixels; ++x) {
-                // Invert: BreezySLAM byte 0 = OBSTACLE (occupied), 255 = FREE
-                uint8_t v = 255 - src[x];
-                // 0 = free (green) → 127 = unknown (yellow) → 255 = occupied (red)
-                int r, g, b;
-                if (v < 128) {
-                    r = (255 * v) / 127;
-                    g = 255;
-                    b = 0;
-                } else {
-                    r = 255;
-                    g = (255 * (255 - v)) / 127;
-                    b = 0;
-                }
-                line[x] = qRgb(r, g, b);
-            }
+void SlamController::updateMap(const Spider2::MapTileUpdate &update)
+{
+    ++m_mapRevision;
+    if (update.reset || update.sizePixels != m_mapSizePixels) {
+        // Every tile is in this update; stale ones must not survive a size change
+        m_mapLevels.resize(static_cast<size_t>(Spider2::mapLevelCount(update.sizePixels)));
+        for (size_t level = 0; level < m_mapLevels.size(); ++level) {
+            MapLevel &stored = m_mapLevels[level];
+            stored.store.reset(Spider2::mapLevelSize(update.sizePixels, static_cast<int>(level)));
+            stored.revisions.assign(static_cast<size_t>(stored.store.columns()) * static_cast<size_t>(stored.store.columns()),
+                                    m_mapRevision);
         }
-        if (m_mapProvider)
-            m_mapProvider->updateMapImage(image);
     }
+    for (const Spider2::MapTile &tile : update.tiles) {
+        if (tile.level >= mapLevelCount())
+            continue;
+        MapLevel &level = m_mapLevels[static_cast<size_t>(tile.level)];
+        const int columns = level.store.columns();
+        if (tile.column >= columns || tile.row >= columns)
+            continue;
+        // Shares the colorizer's chunk; nothing is copied
+        level.store.setChunk(tile.column, tile.row, tile.chunk);
+        level.revisions[static_cast<size_t>(tile.row) * static_cast<size_t>(columns) + static_cast<size_t>(tile.column)] =
+            m_mapRevision;
+    }
+
+    m_mapSizePixels = update.sizePixels;
+    m_mapSizeMeters = update.sizeMeters;
 
     ++m_mapFrameIndex;
     emit mapChanged();
     emit mapFrameIndexChanged();
 }
 
+Spider2::MapTileUpdate SlamController::mapSnapshot() const
+{
+    Spider2::MapTileUpdate snapshot;
+    snapshot.sizePixels = m_mapSizePixels;
+    snapshot.sizeMeters = m_mapSizeMeters;
+    snapshot.reset = true;
+    for (int level = 0; level < mapLevelCount(); ++level) {
+        const Spider2::MapStore &store = mapLevel(level);
+        for (int row = 0; row < store.columns(); ++row) {
+            for (int column = 0; column < store.columns(); ++column) {
+                if (const Spider2::MapChunkPtr &chunk = store.chunk(column, row))
+                    snapshot.tiles.push_back(Spider2::MapTile{column, row, level, chunk});
+            }
+        }
+    }
+    return snapshot;
+}
+
+qulonglong SlamController::mapMemoryBytes() const
+{
+    qulonglong bytes = 0;
+    for (const MapLevel &level : m_mapLevels)
+        bytes += level.store.memoryBytes() + level.revisions.capacity() * sizeof(quint64);
+    return bytes;
+}
+
+int SlamController::mapCellAt(double x_mm, double y_mm) const
+{
+    if (m_mapLevels.empty() || m_mapSizeMeters <= 0.0)
+        return -1;
+    const double cellsPerMm = m_mapSizePixels / (m_mapSizeMeters * 1000.0);
+    const double x = std::floor(x_mm * cellsPerMm);
+    const double y = std::floor(y_mm * cellsPerMm);
+    if (x < 0.0 || y < 0.0 || x >= m_mapSizePixels || y >= m_mapSizePixels)
+        return -1;
+    return m_mapLevels.front().store.cellAt(static_cast<int>(x), static_cast<int>(y));
+}
+
 void SlamController::clearData()
 {
     m_posX = 0.0;
     m_posY = 0.0;
     m_posTheta = 0.0;
     m_hasData = false;
+    m_trail.clear();
     m_mapSizePixels = 0;
     m_mapSizeMeters = 0.0;
+    m_mapLevels.clear();
+    ++m_mapFrameIndex;
 
     emit posXChanged();
     emit posYChanged();
     emit posThetaChanged();
     emit hasDataChanged();
     emit mapChanged();
+    emit mapFrameIndexChanged();
+    emit trailChanged();
 }
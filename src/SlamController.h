@@ -1,11 +1,25 @@
 #pragma once
 
 #include <QObject>
-#include <QByteArray>
-#include <QImage>
-
-class MapProvider;
+#include <vector>
+#include "MapStore.h"
+#include "MapTiles.h"
+#include "PoseTrail.h"
 
+/**
+ * @brief Robot pose and map metadata for QML
+ *
+ * The map is kept as a pyramid of sparse 8-bit grids (Spider2::MapStore):
+ * level 0 at full resolution, each further level at half the one before (see
+ * Spider2::mapLevelCount()). Every tile carries the revision it last changed
+ * in. MapColorizer produces only the tiles that changed, off the GUI thread,
+ * and shares their chunks with this store; MapItem shows the level that suits
+ * its zoom and re-uploads a tile only when its revision moved past the one it
+ * has on the GPU.
+ *
+ * Every pose also goes into a bounded Spider2::PoseTrail, which MapItem
+ * draws as one line over the map.
+ */
 class SlamController : public QObject
 {
     Q_OBJECT
@@ -16,6 +30,8 @@ class SlamController : public QObject
     Q_PROPERTY(int mapSizePixels READ mapSizePixels NOTIFY mapChanged)
     Q_PROPERTY(double mapSizeMeters READ mapSizeMeters NOTIFY mapChanged)
     Q_PROPERTY(int mapFrameIndex READ mapFrameIndex NOTIFY mapFrameIndexChanged)
+    Q_PROPERTY(qulonglong mapMemoryBytes READ mapMemoryBytes NOTIFY mapFrameIndexChanged)
+    Q_PROPERTY(int trailPointCount READ trailPointCount NOTIFY trailChanged)
 
 public:
     explicit SlamController(QObject *parent = nullptr);
@@ -28,11 +44,37 @@ public:
     double mapSizeMeters() const { return m_mapSizeMeters; }
     int mapFrameIndex() const { return m_mapFrameIndex; }
 
-    void setMapProvider(MapProvider *provider);
+    /// @brief Chunk memory of every level (Spider2::MapStore::memoryBytes())
+    qulonglong mapMemoryBytes() const;
+
+    int mapLevelCount() const { return static_cast<int>(m_mapLevels.size()); }
+    const Spider2::MapStore &mapLevel(int level) const { return m_mapLevels[static_cast<size_t>(level)].store; }
+    /// @brief Revision the tile last changed in; revisions only grow, also across map resets
+    quint64 mapTileRevision(int level, int column, int row) const
+    {
+        const MapLevel &stored = m_mapLevels[static_cast<size_t>(level)];
+        return stored.revisions[static_cast<size_t>(row) * static_cast<size_t>(stored.store.columns())
+                                + static_cast<size_t>(column)];
+    }
+
+    const Spider2::PoseTrail &trail() const { return m_trail; }
+    int trailPointCount() const { return static_cast<int>(m_trail.size()); }
+    /// @brief Replace the trail, e.g. with one restored from disk; the current pose is not touched
+    void restoreTrail(const std::vector<Spider2::PoseTrail::Point> &points);
+
+    /// @brief The whole map as a reset update: every stored tile of every level, chunks shared
+    Spider2::MapTileUpdate mapSnapshot() const;
+
+    /**
+     * @brief Map cell under a world position, for hit-testing
+     * @return 0 (occupied) … 255 (free), 127 unknown; -1 outside the map or without one
+     */
+    Q_INVOKABLE int mapCellAt(double x_mm, double y_mm) const;
 
 public slots:
     void updatePose(double x_mm, double y_mm, double theta_deg);
-    void updateMap(int sizePixels, double sizeMeters, const QByteArray &data);
+    /// @brief Apply the tiles that changed in a new map
+    void updateMap(const Spider2::MapTileUpdate &update);
     void clearData();
 
 signals:
@@ -42,15 +84,23 @@ signals:
     void hasDataChanged();
     void mapChanged();
     void mapFrameIndexChanged();
+    void trailChanged();
 
 private:
     double m_posX{0.0};
     double m_posY{0.0};
     double m_posTheta{0.0};
     bool m_hasData{false};
+    Spider2::PoseTrail m_trail;
 
     int m_mapSizePixels{0};
     double m_mapSizeMeters{0.0};
     int m_mapFrameIndex{0};
-    MapProvider *m_mapProvider{nullptr};
+
+    struct MapLevel {
+        Spider2::MapStore store;
+        std::vector<quint64> revisions;   // per tile, row-major
+    };
+    std::vector<MapLevel> m_mapLevels;
+    quint64 m_mapRevision{0};
 };
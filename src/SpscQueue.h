@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Spider2 {
+
+/**
+ * @brief Bounded lock-free single-producer / single-consumer ring buffer
+ *
+ * Exactly one thread may call tryPush() and exactly one (other) thread may
+ * call tryPop(). Capacity is rounded up to a power of two. Slots are
+ * default-constructed up front and reused, so push/pop never allocate.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+        : m_slots(roundUpPow2(capacity < 2 ? 2 : capacity))
+        , m_mask(m_slots.size() - 1)
+    {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /// @brief Producer side. Returns false (and leaves @p value untouched) when full.
+    bool tryPush(T &&value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == m_slots.size()) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == m_slots.size()) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Consumer side. Returns false when empty.
+    bool tryPop(T &out)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) {
+                return false;
+            }
+        }
+        T &slot = m_slots[head & m_mask];
+        out = std::move(slot);
+        slot = T();  // release whatever the slot still references
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Approximate number of queued items (exact when called from either endpoint)
+    size_t sizeApprox() const
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : 0;
+    }
+
+    bool emptyApprox() const { return sizeApprox() == 0; }
+
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    static size_t roundUpPow2(size_t n)
+    {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> m_slots;
+    const size_t m_mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_head{0};  // written by consumer
+    size_t m_tailCache{0};                              // consumer-private
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail{0};  // written by producer
+    size_t m_headCache{0};                              // producer-private
+};
+
+} // namespace Spider2
@@ -0,0 +1,33 @@
+#include "TelemetryStore.h"
+
+TelemetryStore::TelemetryStore(QObject *parent)
+    : QQmlPropertyMap(this, parent)
+{
+}
+
+void TelemetryStore::declare(const QStringList &keys)
+{
+    for (const QString &key : keys) {
+        if (!contains(key)) {
+            insert(key, QVariant());
+        }
+    }
+}
+
+void TelemetryStore::setValue(const QString &key, const QVariant &value)
+{
+    if (!value.isValid()) {
+        return;
+    }
+    if (contains(key) && this->value(key) == value) {
+        return;
+    }
+    insert(key, value);
+}
+
+QVariant TelemetryStore::updateValue(const QString &key, const QVariant &input)
+{
+    Q_UNUSED(input)
+    // Telemetry comes from the robot only; keep the current value
+    return value(key);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QQmlPropertyMap>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+/**
+ * @brief Key/value telemetry exposed to QML with per-key change notification
+ *
+ * Each key is a property of its own, so a binding such as
+ * telemetryData["battery_voltage"] re-evaluates only when that key changes,
+ * not whenever any telemetry arrives. Writing an unchanged value notifies
+ * nobody. Values are flat (e.g. "gyro_x" rather than a nested "gyro" map), so
+ * updating a reading never allocates a container.
+ *
+ * Keys that bindings read before the robot has sent them must be declared up
+ * front: a binding can only subscribe to a key that already exists.
+ * The store is read-only from QML.
+ */
+class TelemetryStore : public QQmlPropertyMap
+{
+    Q_OBJECT
+
+public:
+    explicit TelemetryStore(QObject *parent = nullptr);
+
+    /// @brief Create slots (initially undefined) for keys QML binds to
+    void declare(const QStringList &keys);
+
+    /// @brief Set one key; invalid or unchanged values are ignored
+    void setValue(const QString &key, const QVariant &value);
+
+protected:
+    QVariant updateValue(const QString &key, const QVariant &input) override;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace Spider2 {
+
+/**
+ * @brief Name the calling thread as shown by debuggers, top -H and the load test
+ *
+ * Linux keeps at most 15 characters. A no-op on platforms without pthreads.
+ */
+inline void setCurrentThreadName(const std::string &name)
+{
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(name.c_str());
+#else
+    (void)name;
+#endif
+}
+
+} // namespace Spider2
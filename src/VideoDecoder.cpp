@@ -0,0 +1,191 @@
+#include "VideoDecoder.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QImageReader>
+#include <algorithm>
+#include <chrono>
+#include "ThreadName.h"
+
+VideoDecoder::VideoDecoder(FrameCallback callback, unsigned threadCount)
+    : m_callback(std::move(callback))
+{
+    if (threadCount == 0) {
+        // Half the cores, but enough to overlap a couple of 30 fps frames
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::clamp(cores / 2, 1u, 4u);
+    }
+    m_threadCount = threadCount;
+}
+
+VideoDecoder::~VideoDecoder()
+{
+    stop();
+}
+
+void VideoDecoder::start()
+{
+    if (m_running.exchange(true)) return;
+    for (unsigned i = 0; i < m_threadCount; ++i) {
+        m_threads.emplace_back([this, i]() {
+            Spider2::setCurrentThreadName("s2-decode-" + std::to_string(i));
+            decodeLoop();
+        });
+    }
+}
+
+void VideoDecoder::stop()
+{
+    if (!m_running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_jobs.clear();
+    }
+    m_jobAvailable.notify_all();
+    for (auto &t : m_threads) {
+        if (t.joinable()) t.join();
+    }
+    m_threads.clear();
+
+    std::lock_guard<std::mutex> lock(m_deliverMutex);
+    m_hasDelivered = false;
+    m_lastTimestamp = 0;
+    m_lastSequence = 0;
+}
+
+void VideoDecoder::submit(const Spider2::RawFrame &frame, const char *jpeg, size_t jpegSize, qint64 timestamp)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_jobs.size() >= m_threadCount) {
+            // All decoders busy: the oldest waiting frame is no longer worth decoding
+            m_jobs.pop_front();
+            m_overrunDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        Job job;
+        job.frame = frame;
+        job.jpeg = jpeg;
+        job.jpegSize = jpegSize;
+        job.timestamp = timestamp;
+        job.receivedUs = frame.receivedUs;
+        job.sequence = ++m_nextSequence;
+        m_jobs.push_back(std::move(job));
+    }
+    m_jobAvailable.notify_one();
+}
+
+bool VideoDecoder::isStale(const Job &job) const
+{
+    if (!m_hasDelivered) return false;
+    if (job.timestamp != m_lastTimestamp) return job.timestamp < m_lastTimestamp;
+    return job.sequence <= m_lastSequence;
+}
+
+QImage VideoDecoder::decode(const char *jpeg, size_t jpegSize, const QSize &target)
+{
+    QByteArray bytes = QByteArray::fromRawData(jpeg, static_cast<qsizetype>(jpegSize));
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "JPEG");
+    if (target.isValid()) {
+        // size() only parses the JPEG header
+        const QSize scaled = dctScaledSize(reader.size(), target);
+        if (scaled != reader.size())
+            reader.setScaledSize(scaled);
+    }
+    return reader.read();
+}
+
+void VideoDecoder::decodeLoop()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobAvailable.wait(lock, [this]() { return !m_jobs.empty() || !m_running; });
+            if (!m_running) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        {
+            // A newer frame was delivered while this one waited: skip the decode
+            std::lock_guard<std::mutex> lock(m_deliverMutex);
+            if (isStale(job)) {
+                m_staleDropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        QImage image = decode(job.jpeg, job.jpegSize, targetSize());
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        m_decodeTime.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+
+        // Release the receive buffer before handing the image on
+        job.frame = Spider2::RawFrame();
+
+        if (image.isNull()) {
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+            qWarning() << "[VIDEO] Failed to decode JPEG data (" << job.jpegSize << "bytes)";
+            continue;
+        }
+        m_decoded.fetch_add(1, std::memory_order_relaxed);
+
+        // Deliver under the lock so callbacks are issued in timestamp order
+        std::lock_guard<std::mutex> lock(m_deliverMutex);
+        if (isStale(job)) {
+            m_staleDropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        m_hasDelivered = true;
+        m_lastTimestamp = job.timestamp;
+        m_lastSequence = job.sequence;
+        m_callback(image, job.timestamp, job.receivedUs);
+    }
+}
+
+void VideoDecoder::setTargetSize(const QSize &size)
+{
+    m_targetWidth.store(size.isValid() ? size.width() : 0, std::memory_order_relaxed);
+    m_targetHeight.store(size.isValid() ? size.height() : 0, std::memory_order_relaxed);
+}
+
+QSize VideoDecoder::targetSize() const
+{
+    const int w = m_targetWidth.load(std::memory_order_relaxed);
+    const int h = m_targetHeight.load(std::memory_order_relaxed);
+    return (w > 0 && h > 0) ? QSize(w, h) : QSize();
+}
+
+QSize VideoDecoder::dctScaledSize(const QSize &source, const QSize &target)
+{
+    if (!source.isValid() || !target.isValid())
+        return source;
+
+    // Largest 1/denom reduction that still covers the target in both
+    // dimensions. libjpeg rounds the output up, and Qt's JPEG handler picks
+    // denom = min(width / scaledWidth, height / scaledHeight), so this size
+    // decodes without any extra resampling pass.
+    for (int denom = 8; denom > 1; denom /= 2) {
+        const QSize scaled((source.width() + denom - 1) / denom,
+                           (source.height() + denom - 1) / denom);
+        if (scaled.width() >= target.width() && scaled.height() >= target.height()
+            && source.width() / scaled.width() >= denom
+            && source.height() / scaled.height() >= denom) {
+            return scaled;
+        }
+    }
+    return source;
+}
+
+VideoDecoder::Stats VideoDecoder::takeStats()
+{
+    Stats s;
+    s.decoded = m_decoded.exchange(0, std::memory_order_relaxed);
+    s.failed = m_failed.exchange(0, std::memory_order_relaxed);
+    s.staleDropped = m_staleDropped.exchange(0, std::memory_order_relaxed);
+    s.overrunDropped = m_overrunDropped.exchange(0, std::memory_order_relaxed);
+    s.decodeTime = m_decodeTime.snapshot(true);
+    return s;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "RawFrame.h"
+
+/**
+ * @brief Multi-threaded JPEG decoder for VIDEO_FRAME payloads
+ *
+ * Up to threadCount() frames are decoded in parallel on separate cores.
+ * Results are ordered by VideoFrame.timestamp (arrival order breaks ties):
+ * a frame that finishes after a newer one has already been delivered is
+ * discarded, so the callback only ever sees monotonically newer frames.
+ * When every decoder is busy the oldest pending frame is dropped in favour
+ * of the newest.
+ *
+ * With a target size set, frames are decoded straight to (at least) that size
+ * using libjpeg's DCT-domain 1/2, 1/4 and 1/8 scaling, so pixels that would be
+ * thrown away on screen are never produced. Only power-of-two factors are
+ * used: the final fit to the item is left to the scene graph.
+ */
+class VideoDecoder
+{
+public:
+    /**
+     * @brief Invoked on a decoder thread, in timestamp order
+     * @param receivedUs RawFrame::receivedUs of the frame the image was decoded from
+     */
+    using FrameCallback = std::function<void(const QImage &image, qint64 timestamp, qint64 receivedUs)>;
+
+    struct Stats {
+        uint64_t decoded{0};
+        uint64_t failed{0};
+        uint64_t staleDropped{0};    ///< Finished (or queued) behind a newer frame
+        uint64_t overrunDropped{0};  ///< Replaced while waiting for a free decoder
+        Spider2::LatencyHistogram::Snapshot decodeTime;
+    };
+
+    explicit VideoDecoder(FrameCallback callback, unsigned threadCount = 0);
+    ~VideoDecoder();
+
+    void start();
+    void stop();
+
+    /**
+     * @brief Queue a frame for decoding. Never blocks.
+     * @param frame Keeps the receive buffer behind @p jpeg alive
+     * @param jpeg JPEG bytes inside @p frame
+     * @param jpegSize Number of JPEG bytes
+     * @param timestamp VideoFrame.timestamp (robot clock, ms)
+     */
+    void submit(const Spider2::RawFrame &frame, const char *jpeg, size_t jpegSize, qint64 timestamp);
+
+    unsigned threadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+    /// @brief On-screen size (device pixels) frames are shown at; invalid = full resolution
+    void setTargetSize(const QSize &size);
+    QSize targetSize() const;
+
+    /**
+     * @brief Smallest DCT-scaled size of @p source that still covers @p target
+     * @return @p source itself when no 1/2, 1/4 or 1/8 reduction fits
+     */
+    static QSize dctScaledSize(const QSize &source, const QSize &target);
+
+    /// @brief Decode one JPEG, DCT-scaled towards @p target when valid; null on failure
+    static QImage decode(const char *jpeg, size_t jpegSize, const QSize &target);
+
+    /// @brief Counters and decode-time histogram since the previous call
+    Stats takeStats();
+
+private:
+    struct Job {
+        Spider2::RawFrame frame;
+        const char *jpeg{nullptr};
+        size_t jpegSize{0};
+        qint64 timestamp{0};
+        qint64 receivedUs{0};
+        uint64_t sequence{0};
+    };
+
+    void decodeLoop();
+    bool isStale(const Job &job) const;   // m_deliverMutex must be held
+
+    FrameCallback m_callback;
+    unsigned m_threadCount{1};
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_running{false};
+
+    // Pending jobs (at most one per decoder thread)
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobAvailable;
+    std::deque<Job> m_jobs;
+    uint64_t m_nextSequence{0};
+
+    // Ordering of delivered frames
+    std::mutex m_deliverMutex;
+    qint64 m_lastTimestamp{0};
+    uint64_t m_lastSequence{0};
+    bool m_hasDelivered{false};
+
+    std::atomic<int> m_targetWidth{0};
+    std::atomic<int> m_targetHeight{0};
+
+    std::atomic<uint64_t> m_decoded{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<uint64_t> m_staleDropped{0};
+    std::atomic<uint64_t> m_overrunDropped{0};
+    Spider2::LatencyHistogram m_decodeTime;
+};
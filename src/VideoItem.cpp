@@ -0,0 +1,133 @@
+#include "VideoItem.h"
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <cmath>
+#include "ImageTexture.h"
+
+VideoItem::VideoItem(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void VideoItem::setController(RobotController *controller)
+{
+    if (m_controller == controller)
+        return;
+
+    if (m_frameConnection)
+        disconnect(m_frameConnection);
+    if (m_resetConnection)
+        disconnect(m_resetConnection);
+
+    m_controller = controller;
+    if (m_controller) {
+        m_frameConnection = connect(m_controller, &RobotController::videoFrameReady,
+                                    this, &VideoItem::setFrame);
+        m_resetConnection = connect(m_controller, &RobotController::videoReset,
+                                    this, &VideoItem::clearFrame);
+        reportDisplaySize();
+    }
+    emit controllerChanged();
+}
+
+void VideoItem::setFrame(const QImage &frame, qint64 timestamp)
+{
+    Q_UNUSED(timestamp)
+    if (frame.isNull())
+        return;
+
+    // Latest wins until the render loop picks it up
+    m_pendingFrame = frame;
+    if (m_frameSize != frame.size()) {
+        m_frameSize = frame.size();
+        emit frameSizeChanged();
+    }
+    update();
+}
+
+void VideoItem::clearFrame()
+{
+    m_pendingFrame = QImage();
+    if (m_frameSize.isValid()) {
+        // An invalid size makes updatePaintNode drop the node and its texture
+        m_frameSize = QSize();
+        emit frameSizeChanged();
+    }
+    update();
+}
+
+QRectF VideoItem::fittedRect() const
+{
+    if (!m_frameSize.isValid() || width() <= 0 || height() <= 0)
+        return QRectF();
+
+    // Image.PreserveAspectFit equivalent
+    const QSizeF fitted = QSizeF(m_frameSize).scaled(size(), Qt::KeepAspectRatio);
+    return QRectF((width() - fitted.width()) / 2.0, (height() - fitted.height()) / 2.0,
+                  fitted.width(), fitted.height());
+}
+
+QSGNode *VideoItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    QQuickWindow *win = window();
+    auto *node = static_cast<QSGImageNode *>(oldNode);
+
+    if (!m_frameSize.isValid() || !win) {
+        delete node;
+        m_texture = nullptr;
+        return nullptr;
+    }
+
+    if (!node) {
+        node = win->createImageNode();
+        node->setOwnsTexture(true);
+        node->setFiltering(QSGTexture::Linear);
+        m_texture = nullptr;
+    }
+
+    if (!m_pendingFrame.isNull()) {
+        if (win->rhi()) {
+            if (!m_texture) {
+                m_texture = new ImageTexture;
+                node->setTexture(m_texture);
+            }
+            m_texture->setImage(m_pendingFrame);
+        } else {
+            // Software backend: textures are plain image wrappers
+            node->setTexture(win->createTextureFromImage(m_pendingFrame));
+        }
+        m_pendingFrame = QImage();
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    node->setRect(fittedRect());
+    node->setSourceRect(QRectF(QPointF(0, 0), QSizeF(m_frameSize)));
+    return node;
+}
+
+void VideoItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        reportDisplaySize();
+        update();
+    }
+}
+
+void VideoItem::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+    if (change == ItemSceneChange || change == ItemDevicePixelRatioHasChanged)
+        reportDisplaySize();
+}
+
+void VideoItem::reportDisplaySize()
+{
+    if (!m_controller)
+        return;
+    const qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    m_controller->setVideoDisplaySize(QSize(static_cast<int>(std::ceil(width() * dpr)),
+                                            static_cast<int>(std::ceil(height() * dpr))));
+}
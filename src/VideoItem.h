@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QImage>
+#include <QPointer>
+#include <QQuickItem>
+#include <QSize>
+#include "RobotController.h"
+
+class ImageTexture;
+
+/**
+ * @brief Scene-graph item that shows decoded video frames directly
+ *
+ * Replaces the "image://video" round-trip (URL parse, provider mutex, copy
+ * and a fresh texture per frame). Frames arrive through
+ * RobotController::videoFrameReady and are uploaded in updatePaintNode into
+ * one texture that is reused for as long as the frame size stays the same.
+ * Frames that arrive between two render-loop syncs simply replace each other,
+ * so uploads are paced to the render loop.
+ *
+ * With the software scene-graph backend (no QRhi) each frame is wrapped with
+ * QQuickWindow::createTextureFromImage(), which there is a plain image holder.
+ *
+ * The item reports its size in device pixels back to the controller so the
+ * decoder can produce frames at display resolution.
+ */
+class VideoItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(RobotController* controller READ controller WRITE setController NOTIFY controllerChanged)
+    Q_PROPERTY(QSize frameSize READ frameSize NOTIFY frameSizeChanged)
+    Q_PROPERTY(bool hasFrame READ hasFrame NOTIFY frameSizeChanged)
+
+public:
+    explicit VideoItem(QQuickItem *parent = nullptr);
+
+    RobotController* controller() const { return m_controller; }
+    void setController(RobotController *controller);
+
+    QSize frameSize() const { return m_frameSize; }
+    bool hasFrame() const { return m_frameSize.isValid(); }
+
+public slots:
+    void setFrame(const QImage &frame, qint64 timestamp = 0);
+    /// @brief Drop the frame on screen until the next one arrives
+    void clearFrame();
+
+signals:
+    void controllerChanged();
+    void frameSizeChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private:
+    void reportDisplaySize();
+    QRectF fittedRect() const;
+
+    QPointer<RobotController> m_controller;
+    QMetaObject::Connection m_frameConnection;
+    QMetaObject::Connection m_resetConnection;
+
+    // GUI thread; read by updatePaintNode while the GUI thread is blocked
+    QImage m_pendingFrame;
+    QSize m_frameSize;
+
+    // Render thread: owned by the image node
+    ImageTexture *m_texture{nullptr};
+};
@@ -0,0 +1,117 @@
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include "LoadTest.h"
+#include "RobotController.h"
+
+using Spider2::RobotSimulator;
+
+int main(int argc, char *argv[])
+{
+    // The full client without a window: QImage-based decoding and map tiles still need a QGuiApplication
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("spider2-loadtest");
+
+    LoadTest::Config config;
+    config.simulator.endpoint = "tcp://127.0.0.1:5599";
+    config.simulator.logCommands = false;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ramps each robot stream until spider2-gui's receive path falls behind, "
+                                     "then reports the sustainable rate, CPU per thread and peak memory");
+    parser.addHelpOption();
+    const QCommandLineOption endpointOption("endpoint",
+        "Endpoint of the built-in simulator: tcp://127.0.0.1:5599, ipc:///tmp/spider2-load, inproc://load, ...",
+        "endpoint",
+        QString::fromStdString(config.simulator.endpoint));
+    const QCommandLineOption streamsOption("streams",
+        "Streams to ramp, in order: lidar,gyro,video,slam_pose,slam_map,telemetry (default all).", "list");
+    const QCommandLineOption isolateOption("isolate", "Turn the other streams off while one is ramped.");
+    const QCommandLineOption factorOption("factor", "Rate multiplier per step.", "x", QString::number(config.factor));
+    const QCommandLineOption stepOption("step-seconds", "Measurement time per step.", "s",
+        QString::number(config.stepSeconds));
+    const QCommandLineOption settleOption("settle-seconds", "Time before measuring a new rate.", "s",
+        QString::number(config.settleSeconds));
+    const QCommandLineOption maxRateOption("max-rate", "Stop ramping at this many messages per second.", "hz",
+        QString::number(config.maxRate));
+    const QCommandLineOption maxDropOption("max-drop", "Dropped fraction that fails a step.", "ratio",
+        QString::number(config.maxDropRatio));
+    const QCommandLineOption maxLagOption("max-lag-ms", "Receive-to-apply p99 that fails a step.", "ms",
+        QString::number(config.maxLagMs));
+    const QCommandLineOption lidarPointsOption("lidar-points", "Samples per LIDAR_DATA message.", "n",
+        QString::number(config.simulator.lidarPoints));
+    const QCommandLineOption videoSizeOption("video-size", "Video frame size.", "WxH",
+        QString("%1x%2").arg(config.simulator.videoWidth).arg(config.simulator.videoHeight));
+    const QCommandLineOption videoQualityOption("video-quality", "JPEG quality (0-100).", "q",
+        QString::number(config.simulator.videoQuality));
+    const QCommandLineOption mapSizeOption("map-size", "SLAM_MAP edge length in pixels.", "pixels",
+        QString::number(config.simulator.mapPixels));
+    const QCommandLineOption telemetryMetricsOption("telemetry-metrics", "TELEMETRY_UPDATE messages per burst.", "n",
+        QString::number(config.simulator.telemetryMetrics));
+    const QCommandLineOption jsonOption("json", "Also write the full report, every step included, to this file.", "path");
+    parser.addOptions({endpointOption, streamsOption, isolateOption, factorOption, stepOption, settleOption,
+                       maxRateOption, maxDropOption, maxLagOption, lidarPointsOption, videoSizeOption,
+                       videoQualityOption, mapSizeOption, telemetryMetricsOption, jsonOption});
+    parser.process(app);
+
+    if (parser.isSet(streamsOption)) {
+        for (const QString &name : parser.value(streamsOption).split(',', Qt::SkipEmptyParts)) {
+            RobotSimulator::Stream stream;
+            if (!RobotSimulator::streamFromName(name.trimmed().toStdString(), stream)) {
+                qCritical() << "[LOAD] Unknown stream" << name;
+                return 1;
+            }
+            config.streams.push_back(stream);
+        }
+    }
+    config.simulator.endpoint = parser.value(endpointOption).toStdString();
+    config.isolate = parser.isSet(isolateOption);
+    config.factor = parser.value(factorOption).toDouble();
+    config.stepSeconds = parser.value(stepOption).toInt();
+    config.settleSeconds = parser.value(settleOption).toInt();
+    config.maxRate = parser.value(maxRateOption).toDouble();
+    config.maxDropRatio = parser.value(maxDropOption).toDouble();
+    config.maxLagMs = parser.value(maxLagOption).toDouble();
+    config.simulator.lidarPoints = parser.value(lidarPointsOption).toInt();
+    if (!config.simulator.setVideoSize(parser.value(videoSizeOption).toStdString())) {
+        qCritical() << "[LOAD] Invalid --video-size" << parser.value(videoSizeOption);
+        return 1;
+    }
+    config.simulator.videoQuality = parser.value(videoQualityOption).toInt();
+    config.simulator.mapPixels = parser.value(mapSizeOption).toInt();
+    config.simulator.telemetryMetrics = parser.value(telemetryMetricsOption).toInt();
+
+    // inproc:// needs the simulator and the client in one context; anything else keeps them apart
+    if (parser.value(endpointOption).startsWith("inproc://"))
+        config.context = std::make_shared<zmq::context_t>(1);
+
+    // Wired like main.cpp minus QML: no window, so publishing runs on FramePublisher's fallback timer
+    RobotController controller(config.context);
+
+    LoadTest loadTest(&controller, config);
+    QObject::connect(&loadTest, &LoadTest::finished, &app, [&](int exitCode) {
+        for (const QString &line : loadTest.summary())
+            qInfo().noquote() << "[LOAD]" << line;
+        if (parser.isSet(jsonOption)) {
+            QFile file(parser.value(jsonOption));
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                file.write(QJsonDocument(loadTest.report()).toJson());
+                qInfo().noquote() << "[LOAD] Report written to" << file.fileName();
+            } else {
+                qWarning() << "[LOAD] Cannot write" << file.fileName();
+                exitCode = exitCode ? exitCode : 1;
+            }
+        }
+        QCoreApplication::exit(exitCode);
+    });
+    if (!loadTest.start()) {
+        qCritical() << "[LOAD] Cannot start the simulator or connect to" << parser.value(endpointOption);
+        return 1;
+    }
+
+    return app.exec();
+}
@@ -1,11 +1,13 @@
+#include <QCommandLineParser>
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlComponent>
 #include <QQmlError>
 #include <QQmlContext>
+#include <QQuickWindow>
 #include "RobotController.h"
-#include "VideoProvider.h"
-#include "MapProvider.h"
+#include "VideoItem.h"
+#include "MapItem.h"
 #include "LidarController.h"
 #include "GyroController.h"
 #include "SlamController.h"
@@ -14,22 +16,33 @@ int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Spider2 robot control client");
+    parser.addHelpOption();
+    const QCommandLineOption recordOption("record",
+        "Record every received frame to this session file (.s2rec); '-' for a timestamped file "
+        "under the app data directory.", "path");
+    const QCommandLineOption compressOption("record-compressed", "Compress the recorded chunks (worthwhile without video).");
+    const QCommandLineOption replayOption("replay", "Play this recorded session (.s2rec) instead of connecting.", "path");
+    const QCommandLineOption replaySpeedOption("replay-speed", "Replay speed; 0 = as fast as the client can apply it.",
+        "x", "1");
+    parser.addOptions({recordOption, compressOption, replayOption, replaySpeedOption});
+    parser.process(app);
+
     // Register QML types
     qmlRegisterType<RobotController>("Spider2", 1, 0, "RobotController");
+    qmlRegisterType<VideoItem>("Spider2", 1, 0, "VideoItem");
+    qmlRegisterType<MapItem>("Spider2", 1, 0, "MapItem");
     qmlRegisterType<LidarController>("Spider2", 1, 0, "LidarController");
     qmlRegisterType<GyroController>("Spider2", 1, 0, "GyroController");
     qmlRegisterType<SlamController>("Spider2", 1, 0, "SlamController");
-    
-    // Create and register providers
-    VideoProvider *videoProvider = new VideoProvider(&app);
-    MapProvider *mapProvider = new MapProvider(&app);
+    qmlRegisterUncreatableType<LatencyMonitor>("Spider2", 1, 0, "LatencyMonitor",
+                                               "LatencyMonitor is owned by RobotController");
+    qmlRegisterUncreatableType<ClockSync>("Spider2", 1, 0, "ClockSync",
+                                          "ClockSync is owned by RobotController");
     
     QQmlApplicationEngine engine;
     
-    // Register image providers
-    engine.addImageProvider("video", videoProvider);
-    engine.addImageProvider("map", mapProvider);
-    
     // Handle QML loading errors
     QObject::connect(
         &engine,
@@ -58,13 +71,27 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    // Set up the video provider on the root object
+    // Publish received state in step with the window's frames
     if (rootObject) {
         RobotController *robotController = rootObject->findChild<RobotController*>("robotController");
         if (robotController) {
-            robotController->setVideoProvider(videoProvider);
-            robotController->setMapProvider(mapProvider);
-            qInfo() << "Video + Map providers connected to RobotController";
+            robotController->setPublishWindow(qobject_cast<QQuickWindow*>(rootObject));
+
+            if (parser.isSet(recordOption)) {
+                const QString path = parser.value(recordOption);
+                if (!robotController->startRecording(path == "-" ? QString() : path, parser.isSet(compressOption)))
+                    return -1;
+            }
+            if (parser.isSet(replayOption)) {
+                bool ok = false;
+                const double speed = parser.value(replaySpeedOption).toDouble(&ok);
+                if (!ok || speed < 0.0) {
+                    qCritical() << "Invalid --replay-speed" << parser.value(replaySpeedOption);
+                    return -1;
+                }
+                if (!robotController->startReplay(parser.value(replayOption), speed))
+                    return -1;
+            }
         } else {
             qWarning() << "Failed to find RobotController in QML";
         }
@@ -0,0 +1,109 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTimer>
+#include <zmq.hpp>
+#include "RobotSimulator.h"
+
+using Spider2::RobotSimulator;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("spider2-sim");
+
+    RobotSimulator::Config config;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic Spider2 robot for load-testing spider2-gui");
+    parser.addHelpOption();
+    const QCommandLineOption endpointOption("endpoint",
+        "ZeroMQ endpoint to bind: tcp://*:5555, ipc:///tmp/spider2-sim, ...", "endpoint",
+        QString::fromStdString(config.endpoint));
+    const QCommandLineOption lidarOption("lidar-hz", "LIDAR_DATA messages per second.", "hz");
+    const QCommandLineOption lidarPointsOption("lidar-points", "Samples per LIDAR_DATA message.", "n",
+        QString::number(config.lidarPoints));
+    const QCommandLineOption gyroOption("gyro-hz", "GYRO_DATA messages per second.", "hz");
+    const QCommandLineOption videoOption("video-fps", "VIDEO_FRAME messages per second.", "fps");
+    const QCommandLineOption videoSizeOption("video-size", "Video frame size.", "WxH",
+        QString("%1x%2").arg(config.videoWidth).arg(config.videoHeight));
+    const QCommandLineOption videoQualityOption("video-quality", "JPEG quality (0-100).", "q",
+        QString::number(config.videoQuality));
+    const QCommandLineOption poseOption("pose-hz", "SLAM_POSE messages per second.", "hz");
+    const QCommandLineOption mapOption("map-hz", "SLAM_MAP messages per second.", "hz");
+    const QCommandLineOption mapSizeOption("map-size", "SLAM_MAP edge length in pixels.", "pixels",
+        QString::number(config.mapPixels));
+    const QCommandLineOption telemetryOption("telemetry-hz", "Telemetry bursts per second.", "hz");
+    const QCommandLineOption telemetryMetricsOption("telemetry-metrics", "TELEMETRY_UPDATE messages per burst.", "n",
+        QString::number(config.telemetryMetrics));
+    const QCommandLineOption clockOffsetOption("clock-offset-ms", "Robot clock minus local clock.", "ms", "0");
+    const QCommandLineOption durationOption("duration", "Exit after this many seconds (0 = run until killed).", "s", "0");
+    const QCommandLineOption quietOption("quiet", "Do not log received commands.");
+    parser.addOptions({endpointOption, lidarOption, lidarPointsOption, gyroOption, videoOption, videoSizeOption,
+                       videoQualityOption, poseOption, mapOption, mapSizeOption, telemetryOption,
+                       telemetryMetricsOption, clockOffsetOption, durationOption, quietOption});
+    parser.process(app);
+
+    const std::pair<const QCommandLineOption *, RobotSimulator::Stream> rateOptions[] = {
+        {&lidarOption, RobotSimulator::Stream::LIDAR},
+        {&gyroOption, RobotSimulator::Stream::GYRO},
+        {&videoOption, RobotSimulator::Stream::VIDEO},
+        {&poseOption, RobotSimulator::Stream::SLAM_POSE},
+        {&mapOption, RobotSimulator::Stream::SLAM_MAP},
+        {&telemetryOption, RobotSimulator::Stream::TELEMETRY},
+    };
+    for (const auto &[option, stream] : rateOptions) {
+        if (parser.isSet(*option))
+            config.rates[static_cast<size_t>(stream)] = parser.value(*option).toDouble();
+    }
+
+    config.endpoint = parser.value(endpointOption).toStdString();
+    config.lidarPoints = parser.value(lidarPointsOption).toInt();
+    if (!config.setVideoSize(parser.value(videoSizeOption).toStdString())) {
+        qCritical() << "[SIM] Invalid --video-size" << parser.value(videoSizeOption);
+        return 1;
+    }
+    config.videoQuality = parser.value(videoQualityOption).toInt();
+    config.mapPixels = parser.value(mapSizeOption).toInt();
+    config.telemetryMetrics = parser.value(telemetryMetricsOption).toInt();
+    config.clockOffsetMs = parser.value(clockOffsetOption).toLongLong();
+    config.logCommands = !parser.isSet(quietOption);
+
+    zmq::context_t context(1);
+    RobotSimulator simulator;
+    if (!simulator.start(context, config)) {
+        return 1;
+    }
+
+    // Once a second: what each stream actually got out, per client
+    RobotSimulator::Stats last = simulator.stats();
+    QTimer statsTimer;
+    QObject::connect(&statsTimer, &QTimer::timeout, [&]() {
+        const RobotSimulator::Stats now = simulator.stats();
+        QStringList line;
+        for (size_t i = 0; i < now.streams.size(); ++i) {
+            const uint64_t sent = now.streams[i].sent - last.streams[i].sent;
+            const uint64_t dropped = now.streams[i].dropped - last.streams[i].dropped;
+            const double mb = (now.streams[i].bytes - last.streams[i].bytes) / (1024.0 * 1024.0);
+            if (sent == 0 && dropped == 0)
+                continue;
+            QString entry = QString("%1 %2/s %3 MB/s").arg(RobotSimulator::streamName(static_cast<RobotSimulator::Stream>(i)))
+                                .arg(sent).arg(mb, 0, 'f', 2);
+            if (dropped > 0)
+                entry += QString(" (%1 dropped)").arg(dropped);
+            line << entry;
+        }
+        qInfo().noquote() << "[SIM]" << now.clients << "client(s):" << (line.isEmpty() ? "idle" : line.join(", "));
+        last = now;
+    });
+    statsTimer.start(1000);
+
+    const double duration = parser.value(durationOption).toDouble();
+    if (duration > 0.0) {
+        QTimer::singleShot(static_cast<int>(duration * 1000.0), &app, &QCoreApplication::quit);
+    }
+
+    const int result = app.exec();
+    simulator.stop();
+    return result;
+}
@@ -0,0 +1,169 @@
+#include <QtTest>
+#include <cmath>
+#include <cstdint>
+#include "ClockSync.h"
+
+namespace {
+
+constexpr int64_t START_US = 1'700'000'000'000'000;
+constexpr int64_t PERIOD_US = 1'000'000;        // the client's heartbeat period
+
+/// @brief Robot clock: @p offsetUs ahead of ours at START_US, running @p driftPpm fast
+struct RobotClock {
+    int64_t offsetUs{0};
+    double driftPpm{0.0};
+
+    int64_t stampMs(int64_t localUs) const
+    {
+        const double elapsed = static_cast<double>(localUs - START_US);
+        return (localUs + offsetUs + std::llround(elapsed * driftPpm * 1e-6)) / 1000;
+    }
+    int64_t offsetUsAt(int64_t localUs) const
+    {
+        return offsetUs + std::llround(static_cast<double>(localUs - START_US) * driftPpm * 1e-6);
+    }
+};
+
+/// @brief replyReceived() is posted to the object's thread; deliver it now
+void receive(ClockSync &sync, int64_t timestampMs, int64_t receivedUs)
+{
+    sync.replyReceived(timestampMs, receivedUs);
+    QCoreApplication::sendPostedEvents(&sync);
+}
+
+/// @brief One heartbeat exchange that the robot answers with its own clock, half way through @p rttUs
+void exchange(ClockSync &sync, const RobotClock &robot, int64_t sentUs, int64_t rttUs)
+{
+    sync.requestSent(sentUs / 1000, sentUs);
+    receive(sync, robot.stampMs(sentUs + rttUs / 2), sentUs + rttUs);
+}
+
+/// @brief Varies between 20 and 49 ms so the clock filter has a winner to pick
+int64_t rttOf(int i)
+{
+    return 20'000 + (i * 7919 % 30) * 1000;
+}
+
+} // namespace
+
+/**
+ * @brief Heartbeat filtering, offset, clock filter and drift of ClockSync
+ * against a simulated robot clock
+ */
+class TestClockSync : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void offsetFromReplies();
+    void echoesOnlyMeasureRtt();
+    void unsolicitedHeartbeatsAreIgnored();
+    void driftIsEstimated();
+    void clockStepResynchronizes();
+};
+
+void TestClockSync::offsetFromReplies()
+{
+    ClockSync sync;
+    const RobotClock robot{3'000'000, 0.0};
+    exchange(sync, robot, START_US, 40'000);
+    // Only taken once the next request shows no second heartbeat came in
+    QVERIFY(!sync.synchronized());
+    sync.requestSent((START_US + PERIOD_US) / 1000, START_US + PERIOD_US);
+    QVERIFY(sync.synchronized());
+    QCOMPARE(sync.rttMs(), 40.0);
+    QVERIFY(std::llabs(sync.offsetUsAt(START_US) - robot.offsetUs) <= 1000);
+}
+
+void TestClockSync::echoesOnlyMeasureRtt()
+{
+    ClockSync sync;
+    for (int i = 0; i < 10; ++i) {
+        const int64_t sentUs = START_US + i * PERIOD_US;
+        sync.requestSent(sentUs / 1000, sentUs);
+        receive(sync, sentUs / 1000, sentUs + 30'000);
+    }
+    QCOMPARE(sync.rttMs(), 30.0);
+    QVERIFY(!sync.synchronized());
+}
+
+void TestClockSync::unsolicitedHeartbeatsAreIgnored()
+{
+    ClockSync sync;
+    const RobotClock robot{-2'000'000, 0.0};
+
+    // Before any request there is nothing to answer
+    receive(sync, robot.stampMs(START_US), START_US);
+    QVERIFY(!sync.synchronized());
+
+    bool lost = false;
+    for (int i = 0; i < 60; ++i) {
+        const int64_t sentUs = START_US + (i + 1) * PERIOD_US;
+        sync.requestSent(sentUs / 1000, sentUs);
+        if (lost) {
+            // The only heartbeat after a request that went unanswered may be that request's late reply
+            receive(sync, robot.stampMs(sentUs - 100'000), sentUs + 20'000);
+            lost = false;
+            continue;
+        }
+        if (i % 7 == 3) {
+            lost = true;
+            continue;
+        }
+        if (i % 5 == 0) {
+            // The robot's own heartbeat, stamped before our request, arrives inside the reply window:
+            // together with the real reply that makes two candidates, and both are dropped
+            receive(sync, robot.stampMs(sentUs - 300'000), sentUs + 5'000);
+        }
+        receive(sync, robot.stampMs(sentUs + 20'000), sentUs + 40'000);
+        if (i % 3 == 1) {
+            // Outside the reply window
+            receive(sync, robot.stampMs(sentUs + 600'000), sentUs + 700'000);
+        }
+        QVERIFY(!sync.synchronized() || std::llabs(sync.offsetUsAt(sentUs) - robot.offsetUs) <= 1000);
+    }
+    QVERIFY(sync.synchronized());
+    QVERIFY(std::llabs(sync.offsetUsAt(START_US) - robot.offsetUs) <= 1000);
+}
+
+void TestClockSync::driftIsEstimated()
+{
+    ClockSync sync;
+    const RobotClock robot{500'000, 100.0};
+    int64_t sentUs = START_US;
+    for (int i = 0; i < 300; ++i) {
+        sentUs = START_US + i * PERIOD_US;
+        exchange(sync, robot, sentUs, rttOf(i));
+    }
+    sync.requestSent((sentUs + PERIOD_US) / 1000, sentUs + PERIOD_US);
+
+    QVERIFY(sync.synchronized());
+    QVERIFY2(std::abs(sync.driftPpm() - robot.driftPpm) < 10.0, qPrintable(QString::number(sync.driftPpm())));
+    // Extrapolated a minute past the last exchange, still within a millisecond or two
+    const int64_t laterUs = sentUs + 60 * PERIOD_US;
+    QVERIFY(std::llabs(sync.offsetUsAt(laterUs) - robot.offsetUsAt(laterUs)) <= 2000);
+}
+
+void TestClockSync::clockStepResynchronizes()
+{
+    ClockSync sync;
+    RobotClock robot{1'000'000, 0.0};
+    int i = 0;
+    for (; i < 20; ++i)
+        exchange(sync, robot, START_US + i * PERIOD_US, rttOf(i));
+    QVERIFY(std::llabs(sync.offsetUsAt(START_US) - robot.offsetUs) <= 1000);
+
+    // Set by hand on the robot: far beyond STEP_THRESHOLD_US
+    robot.offsetUs += 2'000'000;
+    for (; i < 40; ++i)
+        exchange(sync, robot, START_US + i * PERIOD_US, rttOf(i));
+    QVERIFY(sync.synchronized());
+    QVERIFY(std::llabs(sync.offsetUsAt(START_US + i * PERIOD_US) - robot.offsetUs) <= 1000);
+    QVERIFY(std::abs(sync.driftPpm()) < 1.0);
+
+    sync.reset();
+    QVERIFY(!sync.synchronized());
+}
+
+QTEST_GUILESS_MAIN(TestClockSync)
+#include "tst_clocksync.moc"
@@ -0,0 +1,238 @@
+#include <QtTest>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "MapColorizer.h"
+#include "MapStore.h"
+#include "MapTiles.h"
+
+using Spider2::MAP_TILE_SIZE;
+using Spider2::MAP_UNKNOWN;
+using Spider2::MapStore;
+using Spider2::MapTileUpdate;
+
+namespace {
+
+using Grid = std::vector<uint8_t>;
+
+/// @brief What a consumer of the updates (SlamController, the render thread) ends up holding
+struct Mirror {
+    std::vector<MapStore> levels;
+
+    void apply(const MapTileUpdate &update)
+    {
+        if (update.reset) {
+            levels.resize(static_cast<size_t>(Spider2::mapLevelCount(update.sizePixels)));
+            for (size_t level = 0; level < levels.size(); ++level)
+                levels[level].reset(Spider2::mapLevelSize(update.sizePixels, static_cast<int>(level)));
+        }
+        for (const Spider2::MapTile &tile : update.tiles)
+            levels[static_cast<size_t>(tile.level)].setChunk(tile.column, tile.row, tile.chunk);
+    }
+};
+
+/// @brief The next pyramid level computed the slow way: minimum of each 2×2 block, edges clamped
+Grid downsample(const Grid &cells, int size)
+{
+    const int half = (size + 1) / 2;
+    Grid coarser(static_cast<size_t>(half) * half);
+    for (int y = 0; y < half; ++y) {
+        for (int x = 0; x < half; ++x) {
+            const int x1 = std::min(2 * x + 1, size - 1);
+            const int y1 = std::min(2 * y + 1, size - 1);
+            const auto at = [&](int cx, int cy) { return cells[static_cast<size_t>(cy) * size + cx]; };
+            coarser[static_cast<size_t>(y) * half + x] =
+                std::min({at(2 * x, 2 * y), at(x1, 2 * y), at(2 * x, y1), at(x1, y1)});
+        }
+    }
+    return coarser;
+}
+
+/// @brief Every level of @p mirror matches @p cells and its slow pyramid
+bool matches(const Mirror &mirror, Grid cells, int size)
+{
+    if (mirror.levels.size() != static_cast<size_t>(Spider2::mapLevelCount(size)))
+        return false;
+    for (const MapStore &level : mirror.levels) {
+        if (level.size() != size)
+            return false;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                if (level.cellAt(x, y) != cells[static_cast<size_t>(y) * size + x])
+                    return false;
+            }
+        }
+        cells = downsample(cells, size);
+        size = (size + 1) / 2;
+    }
+    return true;
+}
+
+/// @brief Free space with a few walls, like a partly explored floor
+void explore(Grid &cells, int size, std::mt19937 &random, int rooms)
+{
+    std::uniform_int_distribution<int> position(0, size - 1);
+    std::uniform_int_distribution<int> extent(10, 120);
+    for (int room = 0; room < rooms; ++room) {
+        const int left = position(random);
+        const int top = position(random);
+        const int right = std::min(size, left + extent(random));
+        const int bottom = std::min(size, top + extent(random));
+        for (int y = top; y < bottom; ++y) {
+            for (int x = left; x < right; ++x) {
+                const bool wall = y == top || y == bottom - 1 || x == left || x == right - 1;
+                cells[static_cast<size_t>(y) * size + x] = wall ? 0 : 255;
+            }
+        }
+    }
+}
+
+/// @brief Level-0 tiles an update must contain: those where @p before and @p after differ
+std::set<std::pair<int, int>> changedTiles(const Grid &before, const Grid &after, int size)
+{
+    std::set<std::pair<int, int>> tiles;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const size_t i = static_cast<size_t>(y) * size + x;
+            if (before[i] != after[i])
+                tiles.emplace(x / MAP_TILE_SIZE, y / MAP_TILE_SIZE);
+        }
+    }
+    return tiles;
+}
+
+std::set<std::pair<int, int>> levelZeroTiles(const MapTileUpdate &update)
+{
+    std::set<std::pair<int, int>> tiles;
+    for (const Spider2::MapTile &tile : update.tiles) {
+        if (tile.level == 0)
+            tiles.emplace(tile.column, tile.row);
+    }
+    return tiles;
+}
+
+} // namespace
+
+/**
+ * @brief Tile diffing and the pyramid of MapColorizer, checked against a
+ * dense grid and a brute-force downsample, with and without helper threads
+ */
+class TestMapColorizer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void diffMap_data();
+    void diffMap();
+    void sizeChangeResets();
+    void seedSkipsUnchangedTiles();
+    void colorizeRowMatchesTable();
+};
+
+void TestMapColorizer::diffMap_data()
+{
+    QTest::addColumn<int>("helpers");
+    QTest::newRow("single thread") << 0;
+    QTest::newRow("helpers") << 3;
+}
+
+void TestMapColorizer::diffMap()
+{
+    QFETCH(int, helpers);
+    // Not a multiple of the tile size, large enough to be shared with the helpers
+    const int size = 1000;
+    QVERIFY(size * size >= MapColorizer::PARALLEL_MIN_CELLS);
+
+    MapColorizer colorizer([](MapTileUpdate &&, qint64, qint64) {}, helpers);
+    colorizer.start();
+    std::mt19937 random(42);
+    Mirror mirror;
+    Grid previous(static_cast<size_t>(size) * size, MAP_UNKNOWN);
+    Grid cells = previous;
+    explore(cells, size, random, 40);
+
+    for (int map = 0; map < 12; ++map) {
+        const MapTileUpdate update = colorizer.diffMap(cells.data(), size, 20.0);
+        QCOMPARE(update.reset, map == 0);
+        QCOMPARE(update.sizePixels, size);
+        QVERIFY(levelZeroTiles(update) == changedTiles(previous, cells, size));
+        for (const Spider2::MapTile &tile : update.tiles)
+            QVERIFY(!tile.chunk || !MapStore::isUnknown(*tile.chunk));
+        mirror.apply(update);
+        QVERIFY(matches(mirror, cells, size));
+
+        // The next scan changes a few rooms, on the last round nothing at all
+        previous = cells;
+        if (map < 10)
+            explore(cells, size, random, 2);
+        if (map == 5)
+            std::fill(cells.begin(), cells.begin() + size * 300, MAP_UNKNOWN);   // tiles going back to unknown
+    }
+    colorizer.stop();
+}
+
+void TestMapColorizer::sizeChangeResets()
+{
+    MapColorizer colorizer([](MapTileUpdate &&, qint64, qint64) {}, 0);
+    std::mt19937 random(1);
+    Grid small(300 * 300, MAP_UNKNOWN);
+    explore(small, 300, random, 5);
+    colorizer.diffMap(small.data(), 300, 6.0);
+
+    Grid large(600 * 600, MAP_UNKNOWN);
+    explore(large, 600, random, 10);
+    const MapTileUpdate update = colorizer.diffMap(large.data(), 600, 12.0);
+    QVERIFY(update.reset);
+    Mirror mirror;
+    mirror.apply(update);
+    QVERIFY(matches(mirror, large, 600));
+}
+
+void TestMapColorizer::seedSkipsUnchangedTiles()
+{
+    const int size = 700;
+    std::mt19937 random(7);
+    Grid cells(static_cast<size_t>(size) * size, MAP_UNKNOWN);
+    explore(cells, size, random, 20);
+
+    // What a restored cache would hold: every stored tile of every level
+    MapColorizer first([](MapTileUpdate &&, qint64, qint64) {}, 0);
+    MapTileUpdate restored = first.diffMap(cells.data(), size, 14.0);
+
+    MapColorizer colorizer([](MapTileUpdate &&, qint64, qint64) {}, 0);
+    colorizer.seed(restored);
+    QVERIFY(colorizer.diffMap(cells.data(), size, 14.0).tiles.empty());
+
+    const Grid before = cells;
+    uint8_t &cell = cells[static_cast<size_t>(size) * 650 + 10];
+    cell = cell == 0 ? 255 : 0;
+    const MapTileUpdate update = colorizer.diffMap(cells.data(), size, 14.0);
+    QVERIFY(!update.reset);
+    QVERIFY(levelZeroTiles(update) == changedTiles(before, cells, size));
+}
+
+void TestMapColorizer::colorizeRowMatchesTable()
+{
+    // Every cell value, at every alignment and tail length the vector paths can hit
+    std::vector<uint8_t> cells(256 + 64);
+    for (size_t i = 0; i < cells.size(); ++i)
+        cells[i] = static_cast<uint8_t>(i * 131 + 7);
+    for (int value = 0; value < 256; ++value)
+        cells[static_cast<size_t>(value)] = static_cast<uint8_t>(value);
+
+    std::vector<QRgb> pixels(cells.size() + 1);
+    for (int offset = 0; offset < 33; ++offset) {
+        const int count = static_cast<int>(cells.size()) - offset - offset % 5;
+        std::fill(pixels.begin(), pixels.end(), 0u);
+        MapColorizer::colorizeRow(cells.data() + offset, pixels.data(), count);
+        for (int i = 0; i < count; ++i)
+            QCOMPARE(pixels[static_cast<size_t>(i)], MapColorizer::colorOf(cells[static_cast<size_t>(offset + i)]));
+        QCOMPARE(pixels[static_cast<size_t>(count)], 0u);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestMapColorizer)
+#include "tst_mapcolorizer.moc"
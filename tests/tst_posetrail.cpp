@@ -0,0 +1,176 @@
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+#include "PoseTrail.h"
+
+using Spider2::PoseTrail;
+using Point = PoseTrail::Point;
+
+namespace {
+
+float distanceToSegment(const Point &p, const Point &a, const Point &b)
+{
+    const float dx = b.x_mm - a.x_mm;
+    const float dy = b.y_mm - a.y_mm;
+    const float lengthSquared = dx * dx + dy * dy;
+    const float t = lengthSquared > 0.0f
+        ? std::clamp(((p.x_mm - a.x_mm) * dx + (p.y_mm - a.y_mm) * dy) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    return std::hypot(a.x_mm + t * dx - p.x_mm, a.y_mm + t * dy - p.y_mm);
+}
+
+bool samePoint(const Point &a, const Point &b)
+{
+    return a.x_mm == b.x_mm && a.y_mm == b.y_mm;
+}
+
+/// @brief Largest distance of a point of @p line from the part of @p simplified that spans it
+float maxDeviation(const std::vector<Point> &line, const std::vector<Point> &simplified)
+{
+    float deviation = 0.0f;
+    size_t segment = 0;
+    for (const Point &p : line) {
+        if (segment + 1 < simplified.size() && samePoint(p, simplified[segment + 1]))
+            ++segment;
+        if (segment + 1 < simplified.size())
+            deviation = std::max(deviation, distanceToSegment(p, simplified[segment], simplified[segment + 1]));
+    }
+    return deviation;
+}
+
+/// @brief A wandering robot: heading drifts, steps of 6..50 mm
+std::vector<Point> randomWalk(size_t count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> turn(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> step(6.0f, 50.0f);
+    std::vector<Point> walk;
+    walk.reserve(count);
+    Point p;
+    float heading = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        heading += turn(random);
+        const float length = step(random);
+        p.x_mm += length * std::cos(heading);
+        p.y_mm += length * std::sin(heading);
+        walk.push_back(p);
+    }
+    return walk;
+}
+
+} // namespace
+
+/**
+ * @brief Douglas–Peucker simplification and the bounded trail built on it
+ */
+class TestPoseTrail : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void simplifyKeepsShortLines();
+    void simplifyStraightLine();
+    void simplifyKeepsCorners();
+    void simplifyStaysWithinTolerance();
+    void appendSkipsStandingStill();
+    void trailStaysBounded();
+    void restore();
+};
+
+void TestPoseTrail::simplifyKeepsShortLines()
+{
+    const Point line[] = {{0.0f, 0.0f}, {10.0f, 10.0f}};
+    QCOMPARE(PoseTrail::simplify(line, 0, 1.0f).size(), size_t(0));
+    QCOMPARE(PoseTrail::simplify(line, 1, 1.0f).size(), size_t(1));
+    QCOMPARE(PoseTrail::simplify(line, 2, 1.0f).size(), size_t(2));
+}
+
+void TestPoseTrail::simplifyStraightLine()
+{
+    std::vector<Point> line;
+    for (int i = 0; i <= 100; ++i)
+        line.push_back(Point{i * 10.0f, i * 5.0f});
+    const std::vector<Point> kept = PoseTrail::simplify(line.data(), line.size(), 1.0f);
+    QCOMPARE(kept.size(), size_t(2));
+    QVERIFY(samePoint(kept.front(), line.front()));
+    QVERIFY(samePoint(kept.back(), line.back()));
+}
+
+void TestPoseTrail::simplifyKeepsCorners()
+{
+    // An L, and a U-turn whose far end is the only point off the endpoints' chord
+    const Point corner[] = {{0.0f, 0.0f}, {50.0f, 0.0f}, {100.0f, 0.0f}, {100.0f, 50.0f}, {100.0f, 100.0f}};
+    const std::vector<Point> l = PoseTrail::simplify(corner, 5, 1.0f);
+    QCOMPARE(l.size(), size_t(3));
+    QVERIFY(samePoint(l[1], corner[2]));
+
+    const Point uTurn[] = {{0.0f, 0.0f}, {100.0f, 0.0f}, {200.0f, 0.0f}, {100.0f, 0.0f}, {0.0f, 0.0f}};
+    const std::vector<Point> u = PoseTrail::simplify(uTurn, 5, 1.0f);
+    QCOMPARE(u.size(), size_t(3));
+    QVERIFY(samePoint(u[1], uTurn[2]));
+}
+
+void TestPoseTrail::simplifyStaysWithinTolerance()
+{
+    for (const float tolerance : {2.0f, 10.0f, 80.0f}) {
+        const std::vector<Point> walk = randomWalk(5000, 7);
+        const std::vector<Point> kept = PoseTrail::simplify(walk.data(), walk.size(), tolerance);
+        QVERIFY(kept.size() < walk.size());
+        QVERIFY(samePoint(kept.front(), walk.front()));
+        QVERIFY(samePoint(kept.back(), walk.back()));
+        QVERIFY(maxDeviation(walk, kept) <= tolerance * 1.001f);
+    }
+}
+
+void TestPoseTrail::appendSkipsStandingStill()
+{
+    PoseTrail trail;
+    QVERIFY(trail.append(0.0f, 0.0f));
+    const uint64_t revision = trail.revision();
+    QVERIFY(!trail.append(PoseTrail::MIN_STEP_MM * 0.5f, 0.0f));
+    QCOMPARE(trail.revision(), revision);
+    QVERIFY(trail.append(PoseTrail::MIN_STEP_MM, 0.0f));
+    QVERIFY(trail.revision() != revision);
+    QCOMPARE(trail.size(), size_t(2));
+}
+
+void TestPoseTrail::trailStaysBounded()
+{
+    const size_t recentCapacity = 128;
+    const size_t historyCapacity = 256;
+    PoseTrail trail(recentCapacity, historyCapacity, 5.0f);
+    const std::vector<Point> walk = randomWalk(100'000, 11);
+    for (const Point &p : walk)
+        QVERIFY(trail.append(p.x_mm, p.y_mm));
+
+    QVERIFY(trail.size() <= recentCapacity + PoseTrail::BLOCK + historyCapacity);
+    QVERIFY(trail.historyToleranceMm() > 5.0f);
+    QVERIFY(!trail.history().empty());
+
+    // The newest poses are kept at full rate, and the whole trail still starts where the walk did
+    const std::vector<Point> &recent = trail.recent();
+    QVERIFY(recent.size() >= recentCapacity);
+    for (size_t i = 0; i < recent.size(); ++i)
+        QVERIFY(samePoint(recent[i], walk[walk.size() - recent.size() + i]));
+    QVERIFY(samePoint(trail.points().front(), walk.front()));
+}
+
+void TestPoseTrail::restore()
+{
+    PoseTrail trail(64, 32, 5.0f);
+    const std::vector<Point> saved = randomWalk(1000, 3);
+    trail.restore(saved);
+    QCOMPARE(trail.recent().size(), size_t(1));
+    QVERIFY(samePoint(trail.recent().front(), saved.back()));
+    QVERIFY(trail.history().size() <= 32);
+    QVERIFY(samePoint(trail.history().front(), saved.front()));
+
+    trail.clear();
+    QCOMPARE(trail.size(), size_t(0));
+    QCOMPARE(trail.historyToleranceMm(), 5.0f);
+}
+
+QTEST_APPLESS_MAIN(TestPoseTrail)
+#include "tst_posetrail.moc"
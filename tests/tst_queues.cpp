@@ -0,0 +1,193 @@
+#include <QtTest>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "LatestValue.h"
+#include "MpscQueue.h"
+#include "SpscQueue.h"
+
+using Spider2::LatestValue;
+using Spider2::MpscQueue;
+using Spider2::SpscQueue;
+
+/**
+ * @brief The lock-free hand-offs between the receive thread, the ingest
+ * workers and the GUI thread, hammered from real threads
+ *
+ * The stress cases only fail on a lost, duplicated, reordered or torn value;
+ * run them under ThreadSanitizer to also catch missing synchronisation.
+ */
+class TestQueues : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void spscCapacity();
+    void spscReleasesPoppedValues();
+    void spscStress();
+    void mpscStress();
+    void latestValueTakesOnce();
+    void latestValueStress();
+};
+
+void TestQueues::spscCapacity()
+{
+    SpscQueue<int> queue(5);
+    QCOMPARE(queue.capacity(), size_t(8));
+    for (int i = 0; i < 8; ++i)
+        QVERIFY(queue.tryPush(int(i)));
+    QVERIFY(!queue.tryPush(8));
+    QCOMPARE(queue.sizeApprox(), size_t(8));
+
+    int value = -1;
+    QVERIFY(queue.tryPop(value));
+    QCOMPARE(value, 0);
+    QVERIFY(queue.tryPush(8));
+    for (int i = 1; i <= 8; ++i) {
+        QVERIFY(queue.tryPop(value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(!queue.tryPop(value));
+    QVERIFY(queue.emptyApprox());
+}
+
+void TestQueues::spscReleasesPoppedValues()
+{
+    // A popped slot must not keep its receive buffer alive
+    SpscQueue<std::shared_ptr<int>> queue(4);
+    auto owner = std::make_shared<int>(42);
+    QVERIFY(queue.tryPush(std::shared_ptr<int>(owner)));
+    std::shared_ptr<int> popped;
+    QVERIFY(queue.tryPop(popped));
+    popped.reset();
+    QCOMPARE(owner.use_count(), 1L);
+}
+
+void TestQueues::spscStress()
+{
+    constexpr uint64_t COUNT = 1u << 20;
+    SpscQueue<uint64_t> queue(256);   // small, so both ends keep hitting full and empty
+
+    std::thread producer([&queue]() {
+        for (uint64_t i = 0; i < COUNT;) {
+            if (queue.tryPush(uint64_t(i)))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    bool inOrder = true;
+    while (expected < COUNT) {
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && value == expected;
+        ++expected;
+    }
+    producer.join();
+
+    QVERIFY(inOrder);
+    QVERIFY(!queue.tryPop(value));
+}
+
+void TestQueues::mpscStress()
+{
+    constexpr int PRODUCERS = 4;
+    constexpr uint32_t PER_PRODUCER = 200000;
+    MpscQueue<uint64_t> queue;   // producer << 32 | sequence
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, &go, p]() {
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (uint32_t i = 0; i < PER_PRODUCER; ++i)
+                queue.push(uint64_t(p) << 32 | i);
+        });
+    }
+    go.store(true, std::memory_order_release);
+
+    // Every producer's items arrive complete and in the order it pushed them
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint64_t received = 0;
+    bool valid = true;
+    uint64_t value = 0;
+    while (received < uint64_t(PRODUCERS) * PER_PRODUCER) {
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const auto producer = static_cast<size_t>(value >> 32);
+        const auto sequence = static_cast<uint32_t>(value);
+        valid = valid && producer < next.size() && sequence == next[producer];
+        if (producer < next.size())
+            ++next[producer];
+        ++received;
+    }
+    for (std::thread &producer : producers)
+        producer.join();
+
+    QVERIFY(valid);
+    QVERIFY(!queue.tryPop(value));
+}
+
+void TestQueues::latestValueTakesOnce()
+{
+    LatestValue<int> slot;
+    int value = 0;
+    QVERIFY(!slot.take(value));
+    slot.publish(1);
+    slot.publish(2);
+    QVERIFY(slot.take(value));
+    QCOMPARE(value, 2);
+    QVERIFY(!slot.take(value));
+}
+
+void TestQueues::latestValueStress()
+{
+    // Both halves always written together: a torn read shows up as a mismatch
+    struct Pair {
+        uint64_t a{0};
+        uint64_t b{0};
+    };
+    constexpr uint64_t COUNT = 1000000;
+    LatestValue<Pair> slot;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&slot, &done]() {
+        for (uint64_t i = 1; i <= COUNT; ++i)
+            slot.publish(Pair{i, i});
+        done.store(true, std::memory_order_release);
+    });
+
+    // Never torn, never older than a value already seen, and the last one always arrives
+    uint64_t last = 0;
+    uint64_t takes = 0;
+    bool valid = true;
+    Pair pair;
+    while (true) {
+        const bool finished = done.load(std::memory_order_acquire);
+        if (slot.take(pair)) {
+            valid = valid && pair.a == pair.b && pair.a > last;
+            last = pair.a;
+            ++takes;
+        } else if (finished) {
+            break;
+        }
+    }
+    writer.join();
+
+    QVERIFY(valid);
+    QCOMPARE(last, COUNT);
+    QVERIFY(takes > 0);
+}
+
+QTEST_APPLESS_MAIN(TestQueues)
+#include "tst_queues.moc"
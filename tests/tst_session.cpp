@@ -0,0 +1,201 @@
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "MessageTypes.hpp"
+#include "SessionFormat.h"
+#include "SessionReader.h"
+#include "SessionRecorder.h"
+
+using Spider2::MessageType;
+using Spider2::RawFrame;
+using Spider2::SessionReader;
+using Spider2::SessionRecorder;
+
+namespace {
+
+constexpr int FRAME_COUNT = 3000;
+constexpr int64_t START_US = 1'700'000'000'000'000;
+constexpr int64_t STEP_US = 1000;                 // 1 kHz of traffic
+constexpr int CLOCK_STEP_AT = FRAME_COUNT / 2;    // the wall clock is set back here...
+constexpr int64_t CLOCK_STEP_US = 5'000'000;      // ...by this much
+
+uint8_t typeOf(int i)
+{
+    static const MessageType types[] = {MessageType::LIDAR_DATA, MessageType::GYRO_DATA, MessageType::VIDEO_FRAME,
+                                        MessageType::SLAM_POSE};
+    return static_cast<uint8_t>(types[i % 4]);
+}
+
+QByteArray payloadOf(int i)
+{
+    // Empty, small and one larger than a chunk; compressible but not constant
+    const int size = i == 100 ? 64 * 1024 : (i * 37) % 700;
+    QByteArray payload(size, Qt::Uninitialized);
+    for (int j = 0; j < size; ++j)
+        payload[j] = static_cast<char>((i + j / 8) & 0xff);
+    return payload;
+}
+
+/// @brief A frame that, like one off the socket, borrows its bytes from a buffer it keeps alive
+RawFrame frameOf(int i)
+{
+    auto buffer = std::make_shared<QByteArray>(payloadOf(i));
+    RawFrame frame;
+    frame.type = typeOf(i);
+    frame.data = buffer->constData();
+    frame.size = static_cast<size_t>(buffer->size());
+    frame.owner = buffer;
+    frame.receivedUs = START_US + i * STEP_US - (i >= CLOCK_STEP_AT ? CLOCK_STEP_US : 0);
+    return frame;
+}
+
+/// @brief Frames of every data chunk, in file order
+std::vector<RawFrame> dataFrames(const SessionReader &reader)
+{
+    std::vector<RawFrame> frames;
+    for (size_t chunk = 0; chunk < reader.chunkCount(); ++chunk) {
+        if (!reader.isKeyframe(chunk) && !reader.readChunk(chunk, frames))
+            return {};
+    }
+    return frames;
+}
+
+} // namespace
+
+/**
+ * @brief .s2rec round trip: SessionRecorder writes, SessionReader reads back
+ * every frame byte for byte, with and without compression, with and without
+ * the trailer
+ */
+class TestSession : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+
+private:
+    void checkFrames(const SessionReader &reader);
+    void checkIndex(const SessionReader &reader);
+};
+
+void TestSession::roundTrip_data()
+{
+    QTest::addColumn<bool>("compress");
+    QTest::newRow("raw") << false;
+    QTest::newRow("compressed") << true;
+}
+
+void TestSession::roundTrip()
+{
+    QFETCH(bool, compress);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("session.s2rec");
+
+    SessionRecorder::Options options;
+    options.compress = compress;
+    options.chunkBytes = 16 * 1024;                  // many chunks, so the index has something to search
+    options.keyframes.depth[static_cast<uint8_t>(MessageType::LIDAR_DATA)] = 2;
+    options.keyframes.depth[static_cast<uint8_t>(MessageType::SLAM_POSE)] = 1;
+    options.keyframeIntervalUs = 200'000;
+
+    SessionRecorder recorder;
+    QVERIFY(recorder.start(path, options));
+    for (int i = 0; i < FRAME_COUNT; ++i)
+        recorder.record(frameOf(i));
+    recorder.stop();
+    const SessionRecorder::Stats stats = recorder.stats();
+    QCOMPARE(stats.dropped, uint64_t(0));
+    QCOMPARE(stats.frames, uint64_t(FRAME_COUNT));
+
+    {
+        SessionReader reader;
+        QVERIFY(reader.open(path));
+        QVERIFY(!reader.recovered());
+        QVERIFY(reader.keyframeCount() > 0);
+        checkFrames(reader);
+        checkIndex(reader);
+    }
+
+    // Cut off index and trailer, as a killed recorder would leave the file
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray whole = file.readAll();
+    file.close();
+    SessionFormat::Trailer trailer;
+    std::memcpy(&trailer, whole.constData() + whole.size() - sizeof(trailer), sizeof(trailer));
+    QCOMPARE(trailer.magic, SessionFormat::TRAILER_MAGIC);
+    const QString truncated = dir.filePath("truncated.s2rec");
+    QFile cut(truncated);
+    QVERIFY(cut.open(QIODevice::WriteOnly));
+    cut.write(whole.left(static_cast<qsizetype>(trailer.indexOffset)));
+    cut.close();
+
+    SessionReader recovered;
+    QVERIFY(recovered.open(truncated));
+    QVERIFY(recovered.recovered());
+    checkFrames(recovered);
+    checkIndex(recovered);
+}
+
+void TestSession::checkFrames(const SessionReader &reader)
+{
+    const std::vector<RawFrame> frames = dataFrames(reader);
+    QCOMPARE(frames.size(), size_t(FRAME_COUNT));
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        const RawFrame &frame = frames[static_cast<size_t>(i)];
+        const QByteArray expected = payloadOf(i);
+        QCOMPARE(frame.type, typeOf(i));
+        QCOMPARE(frame.size, static_cast<size_t>(expected.size()));
+        QVERIFY(frame.size == 0 || std::memcmp(frame.data, expected.constData(), frame.size) == 0);
+        QVERIFY(frame.size == 0 || frame.owner);
+
+        // The clock step is taken out: time never goes back, and the spacing after it is kept
+        if (i > 0) {
+            const int64_t delta = frame.receivedUs - frames[static_cast<size_t>(i) - 1].receivedUs;
+            QCOMPARE(delta, i == CLOCK_STEP_AT ? int64_t(0) : STEP_US);
+        }
+    }
+    QCOMPARE(reader.startUs(), START_US);
+}
+
+void TestSession::checkIndex(const SessionReader &reader)
+{
+    // Chunk time ranges are sorted, so findChunk() finds the chunk holding any time
+    for (size_t chunk = 1; chunk < reader.chunkCount(); ++chunk)
+        QVERIFY(reader.chunk(chunk).firstUs >= reader.chunk(chunk - 1).lastUs);
+    for (int64_t us = reader.startUs(); us <= reader.endUs(); us += 7 * STEP_US) {
+        const size_t chunk = reader.findChunk(us);
+        QVERIFY(chunk < reader.chunkCount());
+        QVERIFY(reader.chunk(chunk).lastUs >= us);
+        QVERIFY(chunk == 0 || reader.chunk(chunk - 1).lastUs < us);
+    }
+    QCOMPARE(reader.findChunk(reader.endUs() + 1), reader.chunkCount());
+
+    // A keyframe holds at most the policy's depth per type, all taken before it
+    const size_t keyframe = reader.findKeyframe(reader.endUs());
+    QVERIFY(keyframe < reader.chunkCount());
+    QVERIFY(reader.isKeyframe(keyframe));
+    std::vector<RawFrame> state;
+    QVERIFY(reader.readChunk(keyframe, state));
+    int lidar = 0;
+    int pose = 0;
+    for (const RawFrame &frame : state) {
+        QVERIFY(frame.receivedUs <= reader.chunk(keyframe).lastUs);
+        lidar += frame.type == static_cast<uint8_t>(MessageType::LIDAR_DATA);
+        pose += frame.type == static_cast<uint8_t>(MessageType::SLAM_POSE);
+        QVERIFY(frame.type == static_cast<uint8_t>(MessageType::LIDAR_DATA)
+                || frame.type == static_cast<uint8_t>(MessageType::SLAM_POSE));
+    }
+    QCOMPARE(lidar, 2);
+    QCOMPARE(pose, 1);
+}
+
+QTEST_GUILESS_MAIN(TestSession)
+#include "tst_session.moc"